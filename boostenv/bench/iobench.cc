@@ -0,0 +1,274 @@
+#include "mozart.hh"
+#include "boostenv.hh"
+#include "benchutils.hh"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace mozart;
+using namespace mozart::bench;
+using namespace mozart::boostenv;
+
+namespace {
+  using boost::asio::ip::tcp;
+
+  const size_t connectionCount = 1000;
+  const size_t messageSize = 64;
+
+  /**
+   * A loopback connection on which the client sends messages that the
+   * server echoes back. As in the OS module, every completion is funneled
+   * through the VM event queue, and the next operation is started from the
+   * VM thread.
+   */
+  template <typename Protocol>
+  class EchoPair: public std::enable_shared_from_this<EchoPair<Protocol>> {
+  private:
+    typedef typename Protocol::socket socket;
+
+  public:
+    EchoPair(BoostBasedVM& environment, std::uint64_t roundTrips):
+      _environment(environment), _strand(environment.io_service),
+      _client(environment.io_service), _server(environment.io_service),
+      _message(messageSize, 'm'), _clientData(messageSize),
+      _serverData(messageSize), _roundTrips(roundTrips) {
+    }
+
+    socket& client() {
+      return _client;
+    }
+
+    socket& server() {
+      return _server;
+    }
+
+    void start() {
+      UnstableNode doneVar;
+      _done = _environment.createAsyncIOFeedbackNode(doneVar);
+
+      startServerRead();
+      startClientRoundTrip();
+    }
+
+  private:
+    void startClientRoundTrip() {
+      auto self = this->shared_from_this();
+
+      boost::asio::async_write(
+        _client, boost::asio::buffer(_message), _strand.wrap(
+          [] (const boost::system::error_code& error, size_t) {}));
+
+      boost::asio::async_read(
+        _client, boost::asio::buffer(_clientData), _strand.wrap(
+          [self] (const boost::system::error_code& error, size_t) {
+            self->_environment.postVMEvent([self, error] () {
+              if (!error && (--self->_roundTrips > 0))
+                self->startClientRoundTrip();
+              else
+                self->_environment.releaseAsyncIONode(self->_done);
+            });
+          }));
+    }
+
+    void startServerRead() {
+      auto self = this->shared_from_this();
+
+      boost::asio::async_read(
+        _server, boost::asio::buffer(_serverData), _strand.wrap(
+          [self] (const boost::system::error_code& error, size_t) {
+            if (error)
+              return;
+
+            self->_environment.postVMEvent([self] () {
+              boost::asio::async_write(
+                self->_server, boost::asio::buffer(self->_serverData),
+                self->_strand.wrap(
+                  [] (const boost::system::error_code& error, size_t) {}));
+
+              if (self->_roundTrips > 1)
+                self->startServerRead();
+            });
+          }));
+    }
+
+  private:
+    BoostBasedVM& _environment;
+    boost::asio::io_service::strand _strand;
+
+    socket _client;
+    socket _server;
+
+    std::vector<char> _message;
+    std::vector<char> _clientData;
+    std::vector<char> _serverData;
+
+    std::uint64_t _roundTrips;
+    ProtectedSlot _done;
+  };
+
+  void raiseFileLimit() {
+#ifndef _WIN32
+    // Each connection uses two file descriptors
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+      limit.rlim_cur = limit.rlim_max;
+      setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif
+  }
+
+  std::shared_ptr<EchoPair<tcp>> makeTCPPair(BoostBasedVM& environment,
+                                             tcp::acceptor& acceptor,
+                                             std::uint64_t roundTrips) {
+    auto pair = std::make_shared<EchoPair<tcp>>(environment, roundTrips);
+
+    pair->client().connect(acceptor.local_endpoint());
+    acceptor.accept(pair->server());
+
+    pair->client().set_option(tcp::no_delay(true));
+    pair->server().set_option(tcp::no_delay(true));
+
+    return pair;
+  }
+
+  std::uint64_t runEcho(size_t ioThreadCount, std::uint64_t iterations) {
+    raiseFileLimit();
+
+    BoostBasedVM environment;
+    environment.setIOThreadCount(ioThreadCount);
+
+    std::uint64_t roundTrips = iterations / connectionCount;
+    if (roundTrips == 0)
+      roundTrips = 1;
+
+    auto loopback = boost::asio::ip::address_v4::loopback();
+    tcp::acceptor acceptor(environment.io_service, tcp::endpoint(loopback, 0));
+    acceptor.listen(connectionCount);
+
+    std::vector<std::shared_ptr<EchoPair<tcp>>> pairs;
+    for (size_t i = 0; i < connectionCount; i++)
+      pairs.push_back(makeTCPPair(environment, acceptor, roundTrips));
+
+    for (auto& pair: pairs)
+      pair->start();
+
+    environment.run();
+
+    reportMetric("connections", connectionCount);
+    reportMetric("io_threads", ioThreadCount);
+    reportMetric("bytes_per_op", 2 * messageSize);
+
+    return roundTrips * connectionCount;
+  }
+
+  template <typename Protocol>
+  std::uint64_t runLatency(BoostBasedVM& environment,
+                           std::shared_ptr<EchoPair<Protocol>> pair,
+                           std::uint64_t iterations) {
+    pair->start();
+    environment.run();
+
+    reportMetric("io_threads", 1);
+    reportMetric("bytes_per_op", 2 * messageSize);
+
+    return iterations;
+  }
+
+  std::uint64_t runExternalPort(size_t senderCount,
+                                std::uint64_t iterations) {
+    BoostBasedVM environment;
+    VM vm = environment.vm;
+
+    // Nobody reads the stream, so the GC reclaims the delivered messages
+    UnstableNode stream;
+    UnstableNode port = Port::build(vm, stream);
+    auto externalPort = ExternalPort::create(environment, port);
+
+    std::uint64_t messagesPerSender = iterations / senderCount;
+    if (messagesPerSender == 0)
+      messagesPerSender = 1;
+
+    // The last sender to finish closes the port, which lets run() return
+    std::atomic<size_t> runningSenders(senderCount);
+
+    std::vector<boost::thread> senders;
+    for (size_t i = 0; i < senderCount; i++) {
+      senders.emplace_back([&] () {
+        for (std::uint64_t j = 0; j < messagesPerSender; j++)
+          externalPort->sendInt((nativeint) j);
+
+        if (--runningSenders == 0)
+          externalPort->close();
+      });
+    }
+
+    environment.run();
+
+    for (auto& sender: senders)
+      sender.join();
+
+    reportMetric("senders", senderCount);
+
+    return messagesPerSender * senderCount;
+  }
+}
+
+// Echo over many loopback TCP connections
+// Every operation is a round trip of 64 bytes on one of 1000 connections,
+// i.e., two I/O completions that go through the VM event queue. This
+// includes setting up the connections.
+
+BENCHMARK(AsyncIO, EchoOneThread) {
+  return runEcho(1, iterations);
+}
+
+BENCHMARK(AsyncIO, EchoFourThreads) {
+  return runEcho(4, iterations);
+}
+
+// Latency of a single loopback connection
+// Every operation is a round trip of 64 bytes, and the next one starts only
+// when the previous one is complete.
+
+BENCHMARK(AsyncIO, TCPLatency) {
+  BoostBasedVM environment;
+  environment.setIOThreadCount(1);
+
+  auto loopback = boost::asio::ip::address_v4::loopback();
+  tcp::acceptor acceptor(environment.io_service, tcp::endpoint(loopback, 0));
+  acceptor.listen(1);
+
+  return runLatency(environment,
+                    makeTCPPair(environment, acceptor, iterations),
+                    iterations);
+}
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+BENCHMARK(AsyncIO, UnixLatency) {
+  using boost::asio::local::stream_protocol;
+
+  BoostBasedVM environment;
+  environment.setIOThreadCount(1);
+
+  auto pair = std::make_shared<EchoPair<stream_protocol>>(
+    environment, iterations);
+  boost::asio::local::connect_pair(pair->client(), pair->server());
+
+  return runLatency(environment, pair, iterations);
+}
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+// Messages sent to a port from C++ threads
+// Every operation is an integer sent through an ExternalPort, which the VM
+// thread then appends to the stream of the port.
+
+BENCHMARK(ExternalPort, OneSender) {
+  return runExternalPort(1, iterations);
+}
+
+BENCHMARK(ExternalPort, FourSenders) {
+  return runExternalPort(4, iterations);
+}
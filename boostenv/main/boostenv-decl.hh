@@ -74,6 +74,18 @@ public:
 
   void setApplicationArgs(int argc, char const* const* argv);
 
+  size_t getIOThreadCount() {
+    return _ioThreadCount;
+  }
+
+  /**
+   * Set the number of threads that run the ASIO service, i.e., that wait for
+   * I/O and timers. Must be called before run().
+   */
+  void setIOThreadCount(size_t count) {
+    _ioThreadCount = (count == 0) ? 1 : count;
+  }
+
 // Run and preemption
 
 public:
@@ -113,22 +125,22 @@ private:
 
 public:
   inline
-  ProtectedNode allocAsyncIONode(StableNode* node);
+  ProtectedSlot allocAsyncIONode(StableNode* node);
 
   inline
-  void releaseAsyncIONode(const ProtectedNode& node);
+  void releaseAsyncIONode(ProtectedSlot node);
 
   inline
-  ProtectedNode createAsyncIOFeedbackNode(UnstableNode& readOnly);
+  ProtectedSlot createAsyncIOFeedbackNode(UnstableNode& readOnly);
 
   template <class LT, class... Args>
   inline
-  void bindAndReleaseAsyncIOFeedbackNode(const ProtectedNode& ref,
+  void bindAndReleaseAsyncIOFeedbackNode(ProtectedSlot ref,
                                          LT&& label, Args&&... args);
 
   template <class LT, class... Args>
   inline
-  void raiseAndReleaseAsyncIOFeedbackNode(const ProtectedNode& ref,
+  void raiseAndReleaseAsyncIOFeedbackNode(ProtectedSlot ref,
                                           LT&& label, Args&&... args);
 
 // Notification from asynchronous work
@@ -161,6 +173,8 @@ private:
 // ASIO service
 public:
   boost::asio::io_service io_service;
+private:
+  size_t _ioThreadCount;
 
 // Synchronization condition variable telling there is work to do in the VM
 private:
@@ -169,7 +183,12 @@ private:
 
 // Preemption and alarms
 private:
+  // The preemption timer is rescheduled by its handler, in an I/O thread,
+  // and cancelled by the VM thread: the mutex serializes these operations
   boost::asio::deadline_timer preemptionTimer;
+  boost::mutex _preemptionTimerMutex;
+  bool _preemptionTimerActive;
+
   boost::asio::deadline_timer alarmTimer;
 
 // IO-driven events that must work with the VM store
@@ -41,14 +41,23 @@ namespace {
     result = bootUnpickle(vm, input);
     return true;
   }
+
+  size_t defaultIOThreadCount() {
+    // Beyond a few threads, the VM thread is the bottleneck anyway
+    size_t count = boost::thread::hardware_concurrency();
+    return (count == 0) ? 1 : (count > 4) ? 4 : count;
+  }
 }
 
 BoostBasedVM::BoostBasedVM(): virtualMachine(*this), vm(&virtualMachine),
   _asyncIONodeCount(0),
   uuidGenerator(random_generator),
-  preemptionTimer(io_service), alarmTimer(io_service) {
+  _ioThreadCount(defaultIOThreadCount()),
+  preemptionTimer(io_service), _preemptionTimerActive(false),
+  alarmTimer(io_service) {
 
   builtins::biref::registerBuiltinModOS(vm);
+  builtins::biref::registerBuiltinModParallelSearch(vm);
 
   // Initialize the pseudo random number generator with a really random seed
   boost::random::random_device generator;
@@ -89,12 +98,18 @@ void BoostBasedVM::run() {
   constexpr auto recInvokeAgainNow   = VirtualMachine::recInvokeAgainNow;
   constexpr auto recInvokeAgainLater = VirtualMachine::recInvokeAgainLater;
 
-  // Prevent the ASIO run thread from exiting by giving it some "work" to do
+  // Prevent the ASIO run threads from exiting by giving them some "work" to do
   auto work = new boost::asio::io_service::work(io_service);
 
-  // Now start the ASIO run thread
-  boost::thread asioRunThread(boost::bind(
-    &boost::asio::io_service::run, &io_service));
+  // Now start the ASIO run threads
+  // Their handlers may run concurrently; that is why connections use strands.
+  // They interact with the VM through postVMEvent(), except for the
+  // preemption timer, which only sets the thread-safe flags of the VM.
+  boost::thread_group asioRunThreads;
+  for (size_t i = 0; i < _ioThreadCount; i++) {
+    asioRunThreads.create_thread(boost::bind(
+      &boost::asio::io_service::run, &io_service));
+  }
 
   // The main loop that handles all interactions with the VM
   while (true) {
@@ -102,17 +117,25 @@ void BoostBasedVM::run() {
     vm->setReferenceTime(getReferenceTime());
 
     // Setup the preemption timer
-    preemptionTimer.expires_from_now(boost::posix_time::millisec(1));
-    preemptionTimer.async_wait(boost::bind(
-      &BoostBasedVM::onPreemptionTimerExpire,
-      this, boost::asio::placeholders::error));
+    {
+      boost::lock_guard<boost::mutex> lock(_preemptionTimerMutex);
+      _preemptionTimerActive = true;
+      preemptionTimer.expires_from_now(boost::posix_time::millisec(1));
+      preemptionTimer.async_wait(boost::bind(
+        &BoostBasedVM::onPreemptionTimerExpire,
+        this, boost::asio::placeholders::error));
+    }
 
     // Run the VM
     auto nextInvokePair = vm->run();
     auto nextInvoke = nextInvokePair.first;
 
     // Stop the preemption timer
-    preemptionTimer.cancel();
+    {
+      boost::lock_guard<boost::mutex> lock(_preemptionTimerMutex);
+      _preemptionTimerActive = false;
+      preemptionTimer.cancel();
+    }
 
     {
       // Acquire the lock that grants me access to
@@ -128,9 +151,17 @@ void BoostBasedVM::run() {
 
       // Handle asynchronous events coming from I/O, e.g.
       while (!_vmEventsCallbacks.empty()) {
-        _vmEventsCallbacks.front()();
+        auto callback = std::move(_vmEventsCallbacks.front());
         _vmEventsCallbacks.pop();
 
+        // Run and destroy the callback without the lock, since either can
+        // post another event, e.g. the destructor of a connection whose
+        // last reference was captured by the callback
+        lock.unlock();
+        callback();
+        callback = nullptr;
+        lock.lock();
+
         // That could have created work for the VM
         nextInvoke = recInvokeAgainNow;
       }
@@ -158,7 +189,7 @@ void BoostBasedVM::run() {
 
   // Tear down
   delete work;
-  asioRunThread.join();
+  asioRunThreads.join_all();
 
   // Get ready for a later call to run()
   io_service.reset();
@@ -167,7 +198,12 @@ void BoostBasedVM::run() {
 void BoostBasedVM::onPreemptionTimerExpire(
   const boost::system::error_code& error) {
 
-  if (error != boost::asio::error::operation_aborted) {
+  // Called in an I/O thread: the VM methods used here are thread-safe
+  boost::lock_guard<boost::mutex> lock(_preemptionTimerMutex);
+
+  // The VM thread may have stopped the timer after it expired
+  if ((error != boost::asio::error::operation_aborted) &&
+      _preemptionTimerActive) {
     // Preemption
     vm->setReferenceTime(getReferenceTime());
     vm->requestPreempt();
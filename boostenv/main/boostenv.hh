@@ -30,6 +30,10 @@
 #include "boostenvutils.hh"
 #include "boostenvtcp.hh"
 #include "boostenvpipe.hh"
+#include "boostenvunix.hh"
+#include "boostenvudp.hh"
+#include "boostenvsearch.hh"
+#include "boostenvexternalport.hh"
 
 #ifndef MOZART_GENERATOR
 
@@ -39,17 +43,18 @@ namespace mozart { namespace boostenv {
 // BoostBasedVM //
 //////////////////
 
-ProtectedNode BoostBasedVM::allocAsyncIONode(StableNode* node) {
+ProtectedSlot BoostBasedVM::allocAsyncIONode(StableNode* node) {
   _asyncIONodeCount++;
-  return vm->protect(*node);
+  return vm->protectInSlot(*node);
 }
 
-void BoostBasedVM::releaseAsyncIONode(const ProtectedNode& node) {
+void BoostBasedVM::releaseAsyncIONode(ProtectedSlot node) {
   assert(_asyncIONodeCount > 0);
   _asyncIONodeCount--;
+  vm->releaseProtectedSlot(node);
 }
 
-ProtectedNode BoostBasedVM::createAsyncIOFeedbackNode(UnstableNode& readOnly) {
+ProtectedSlot BoostBasedVM::createAsyncIOFeedbackNode(UnstableNode& readOnly) {
   StableNode* stable = new (vm) StableNode;
   stable->init(vm, Variable::build(vm));
 
@@ -60,17 +65,17 @@ ProtectedNode BoostBasedVM::createAsyncIOFeedbackNode(UnstableNode& readOnly) {
 
 template <class LT, class... Args>
 void BoostBasedVM::bindAndReleaseAsyncIOFeedbackNode(
-  const ProtectedNode& ref, LT&& label, Args&&... args) {
+  ProtectedSlot ref, LT&& label, Args&&... args) {
 
   UnstableNode rhs = buildTuple(vm, std::forward<LT>(label),
                                 std::forward<Args>(args)...);
-  DataflowVariable(*ref).bind(vm, rhs);
+  DataflowVariable(vm->getProtectedSlot(ref)).bind(vm, rhs);
   releaseAsyncIONode(ref);
 }
 
 template <class LT, class... Args>
 void BoostBasedVM::raiseAndReleaseAsyncIOFeedbackNode(
-  const ProtectedNode& ref, LT&& label, Args&&... args) {
+  ProtectedSlot ref, LT&& label, Args&&... args) {
 
   UnstableNode exception = buildTuple(vm, std::forward<LT>(label),
                                       std::forward<Args>(args)...);
@@ -0,0 +1,185 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __BOOSTENVEXTERNALPORT_DECL_H
+#define __BOOSTENVEXTERNALPORT_DECL_H
+
+#include <mozart.hh>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "boostenv-decl.hh"
+
+namespace mozart { namespace boostenv {
+
+//////////////////
+// ExternalPort //
+//////////////////
+
+/**
+ * Handle to an Oz Port through which any C++ thread can send plain data to
+ * the VM: integers, floats, byte strings and atoms.
+ *
+ * Messages are staged in a batch without locking: a sender reserves room for
+ * its message with an atomic increment, and copies it there. The VM swaps in
+ * a spare batch, waits for the senders still writing into the previous one,
+ * and turns its messages into Oz values that it sends to the port, in the
+ * order they were reserved. Only the first message of a batch posts an event
+ * to the VM. The two batches are reused, so that staging a message does not
+ * allocate memory unless it does not fit in the current batch.
+ *
+ * The handle must be created in the VM thread. It keeps the VM running
+ * until close() is called, from any thread. Every message for which a send
+ * method returned true is delivered, even if it raced with close().
+ */
+class ExternalPort: public std::enable_shared_from_this<ExternalPort> {
+public:
+  typedef std::shared_ptr<ExternalPort> pointer;
+
+  /** Create a handle to port, which must be a Port of the top-level space */
+  inline
+  static pointer create(BoostBasedVM& environment, RichNode port);
+
+private:
+  inline
+  ExternalPort(BoostBasedVM& environment, RichNode port);
+
+public:
+  inline
+  ~ExternalPort();
+
+public:
+  // These can be called from any thread
+  // They return false if the handle has been closed
+
+  inline
+  bool sendInt(nativeint value);
+
+  inline
+  bool sendFloat(double value);
+
+  inline
+  bool sendBytes(const void* data, size_t size);
+
+  /**
+   * Send an atom, given in UTF-8.
+   * Throws std::invalid_argument if name is not valid UTF-8.
+   */
+  inline
+  bool sendAtom(const std::string& name);
+
+  inline
+  void close();
+
+private:
+  enum MessageKind {
+    mkEnd, mkInt, mkFloat, mkBytes, mkAtom
+  };
+
+  /** Header of a message, which is followed by its data */
+  struct Message {
+    MessageKind kind;
+    size_t size;
+
+    union {
+      nativeint intValue;
+      double floatValue;
+    };
+
+    const char* data() const {
+      return reinterpret_cast<const char*>(this + 1);
+    }
+  };
+
+  /** Message that did not fit in the buffer of its batch */
+  struct OverflowMessage {
+    OverflowMessage* next;
+    Message message;
+  };
+
+  /** Size of the buffer of a batch */
+  static constexpr size_t bufferSize = 64 * 1024;
+
+  struct Batch {
+    inline
+    Batch();
+
+    // Bytes reserved in buffer, which may be larger than bufferSize
+    std::atomic<size_t> reserved;
+
+    // Senders that have entered this batch and are still writing into it
+    std::atomic<size_t> writers;
+
+    // Messages that did not fit in buffer, most recent first
+    std::atomic<OverflowMessage*> overflow;
+
+    // There is always room for the mkEnd header after bufferSize
+    std::unique_ptr<char[]> buffer;
+  };
+
+  static size_t recordSize(size_t dataSize) {
+    constexpr size_t align = alignof(Message);
+    return sizeof(Message) + ((dataSize + align - 1) & ~(align - 1));
+  }
+
+  inline
+  bool stage(const Message& header, const void* data);
+
+  inline
+  Batch* enterBatch();
+
+  inline
+  static void deleteOverflow(OverflowMessage* messages);
+
+  // These are called in the VM thread
+
+  inline
+  void deliver();
+
+  inline
+  void sendMessage(VM vm, RichNode port, const Message& message);
+
+  inline
+  void release();
+
+private:
+  BoostBasedVM& _environment;
+
+  Batch _batches[2];
+  std::atomic<Batch*> _current;
+  std::atomic<bool> _closed;
+
+  // Only used in the VM thread
+  ProtectedSlot _port;
+  bool _released;
+};
+
+} }
+
+#endif // __BOOSTENVEXTERNALPORT_DECL_H
@@ -0,0 +1,284 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __BOOSTENVEXTERNALPORT_H
+#define __BOOSTENVEXTERNALPORT_H
+
+#include "boostenvexternalport-decl.hh"
+
+#include "boostenv-decl.hh"
+
+#ifndef MOZART_GENERATOR
+
+namespace mozart { namespace boostenv {
+
+//////////////////
+// ExternalPort //
+//////////////////
+
+auto ExternalPort::create(BoostBasedVM& environment,
+                          RichNode port) -> pointer {
+  VM vm = environment.vm;
+
+  // Messages are delivered while the top-level space is installed
+  if (!port.is<Port>() || !port.as<Port>().home()->isTopLevel())
+    raiseTypeError(vm, MOZART_STR("Port of the top-level space"), port);
+
+  return pointer(new ExternalPort(environment, port));
+}
+
+ExternalPort::Batch::Batch():
+  reserved(0), writers(0), overflow(nullptr),
+  buffer(new char[bufferSize + sizeof(Message)]) {
+}
+
+ExternalPort::ExternalPort(BoostBasedVM& environment, RichNode port):
+  _environment(environment), _current(&_batches[0]), _closed(false),
+  _released(false) {
+
+  _port = environment.allocAsyncIONode(port.getStableRef(environment.vm));
+}
+
+ExternalPort::~ExternalPort() {
+  for (auto& batch: _batches)
+    deleteOverflow(batch.overflow.exchange(nullptr));
+}
+
+bool ExternalPort::sendInt(nativeint value) {
+  Message header;
+  header.kind = mkInt;
+  header.size = 0;
+  header.intValue = value;
+  return stage(header, nullptr);
+}
+
+bool ExternalPort::sendFloat(double value) {
+  Message header;
+  header.kind = mkFloat;
+  header.size = 0;
+  header.floatValue = value;
+  return stage(header, nullptr);
+}
+
+bool ExternalPort::sendBytes(const void* data, size_t size) {
+  Message header;
+  header.kind = mkBytes;
+  header.size = size;
+  return stage(header, data);
+}
+
+bool ExternalPort::sendAtom(const std::string& name) {
+  // Check it here, where the error can still be reported to the sender
+  const char* utf = name.data();
+  nativeint length = (nativeint) name.size();
+  while (length > 0) {
+    nativeint codePointLength = fromUTF(utf, length).second;
+    if (codePointLength <= 0)
+      throw std::invalid_argument("ExternalPort::sendAtom: invalid UTF-8");
+    utf += codePointLength;
+    length -= codePointLength;
+  }
+
+  Message header;
+  header.kind = mkAtom;
+  header.size = name.size();
+  return stage(header, name.data());
+}
+
+bool ExternalPort::stage(const Message& header, const void* data) {
+  Batch* batch = enterBatch();
+  if (batch == nullptr)
+    return false;
+
+  size_t size = recordSize(header.size);
+  size_t offset = batch->reserved.fetch_add(size, std::memory_order_relaxed);
+
+  if (offset + size <= bufferSize) {
+    char* record = batch->buffer.get() + offset;
+    std::memcpy(record, &header, sizeof(Message));
+    if (header.size > 0)
+      std::memcpy(record + sizeof(Message), data, header.size);
+  } else {
+    if (offset < bufferSize) {
+      // The messages of the buffer end here
+      Message end;
+      end.kind = mkEnd;
+      end.size = 0;
+      std::memcpy(batch->buffer.get() + offset, &end, sizeof(Message));
+    }
+
+    // This one, and all the following ones, are delivered after the buffer
+    char* memory = new char[sizeof(OverflowMessage) + header.size];
+    OverflowMessage* message = reinterpret_cast<OverflowMessage*>(memory);
+    message->message = header;
+    if (header.size > 0)
+      std::memcpy(&message->message + 1, data, header.size);
+
+    OverflowMessage* previous = batch->overflow.load(std::memory_order_relaxed);
+    do {
+      message->next = previous;
+    } while (!batch->overflow.compare_exchange_weak(
+      previous, message, std::memory_order_relaxed));
+  }
+
+  // Publishes the message to the VM thread, which waits for the writers
+  batch->writers.fetch_sub(1, std::memory_order_release);
+
+  // The first message of a batch schedules its delivery
+  if (offset == 0) {
+    pointer self = shared_from_this();
+    _environment.postVMEvent([self] () {
+      self->deliver();
+    });
+  }
+
+  return true;
+}
+
+auto ExternalPort::enterBatch() -> Batch* {
+  while (true) {
+    Batch* batch = _current.load();
+    batch->writers.fetch_add(1);
+
+    // If the VM swapped the batches after we registered as a writer, it will
+    // wait for us. Otherwise, it may already be reading this batch.
+    if (_current.load() == batch) {
+      if (_closed.load()) {
+        batch->writers.fetch_sub(1, std::memory_order_release);
+        return nullptr;
+      }
+      return batch;
+    }
+
+    batch->writers.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void ExternalPort::close() {
+  if (_closed.exchange(true))
+    return;
+
+  // Senders that have not seen _closed yet are still waited for by deliver()
+  pointer self = shared_from_this();
+  _environment.postVMEvent([self] () {
+    self->deliver();
+    self->release();
+  });
+}
+
+void ExternalPort::deliver() {
+  if (_released)
+    return;
+
+  // New messages go to the spare batch from now on
+  Batch* batch = _current.load(std::memory_order_relaxed);
+  _current.store((batch == &_batches[0]) ? &_batches[1] : &_batches[0]);
+
+  while (batch->writers.load(std::memory_order_acquire) != 0)
+    boost::this_thread::yield();
+
+  VM vm = _environment.vm;
+  RichNode port = vm->getProtectedSlot(_port);
+
+  size_t reserved = batch->reserved.load(std::memory_order_relaxed);
+  size_t end = (reserved < bufferSize) ? reserved : bufferSize;
+
+  for (size_t offset = 0; offset < end; ) {
+    auto message = reinterpret_cast<const Message*>(
+      batch->buffer.get() + offset);
+    if (message->kind == mkEnd)
+      break;
+
+    sendMessage(vm, port, *message);
+    offset += recordSize(message->size);
+  }
+
+  // Put the overflow back in the order it was staged
+  OverflowMessage* staged = batch->overflow.load(std::memory_order_relaxed);
+  OverflowMessage* overflow = nullptr;
+  while (staged != nullptr) {
+    OverflowMessage* next = staged->next;
+    staged->next = overflow;
+    overflow = staged;
+    staged = next;
+  }
+
+  for (auto message = overflow; message != nullptr; message = message->next)
+    sendMessage(vm, port, message->message);
+
+  // The batch is the spare one until the next delivery
+  deleteOverflow(overflow);
+  batch->overflow.store(nullptr, std::memory_order_relaxed);
+  batch->reserved.store(0, std::memory_order_relaxed);
+}
+
+void ExternalPort::sendMessage(VM vm, RichNode port, const Message& message) {
+  UnstableNode value;
+
+  switch (message.kind) {
+    case mkInt:
+      value = build(vm, message.intValue);
+      break;
+
+    case mkFloat:
+      value = build(vm, message.floatValue);
+      break;
+
+    case mkAtom: {
+      // Validated by sendAtom()
+      auto name = toUTF<nchar>(
+        makeLString(message.data(), (nativeint) message.size));
+      value = build(vm, vm->getAtom(name.length, name.string));
+      break;
+    }
+
+    default: {
+      auto bytes = newLString(vm, (const unsigned char*) message.data(),
+                              (nativeint) message.size);
+      value = ByteString::build(vm, bytes);
+    }
+  }
+
+  port.as<Port>().send(vm, value);
+}
+
+void ExternalPort::release() {
+  _released = true;
+  _environment.releaseAsyncIONode(_port);
+}
+
+void ExternalPort::deleteOverflow(OverflowMessage* messages) {
+  while (messages != nullptr) {
+    OverflowMessage* next = messages->next;
+    delete[] reinterpret_cast<char*>(messages);
+    messages = next;
+  }
+}
+
+} }
+
+#endif
+
+#endif // __BOOSTENVEXTERNALPORT_H
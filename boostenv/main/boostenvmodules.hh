@@ -29,5 +29,6 @@
 #include "boostenv.hh"
 
 #include "modos.hh"
+#include "modsearch.hh"
 
 #endif // __BOOSTENVMODULES_H
@@ -0,0 +1,93 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __BOOSTENVSEARCH_DECL_H
+#define __BOOSTENVSEARCH_DECL_H
+
+#include <mozart.hh>
+#include <parsearch-decl.hh>
+
+#include "boostenv-decl.hh"
+
+namespace mozart { namespace boostenv {
+
+///////////////////////
+// ParallelSearchJob //
+///////////////////////
+
+/**
+ * Parallel search started from Oz, whose solutions are delivered on a stream
+ * as lists of alternatives. The worker VMs load the script from a URL with
+ * the boot loader, which must therefore not depend on the environment of the
+ * VM it is given. The loaded value is either the script, or a pair
+ * Script#Order for best-solution search.
+ */
+class ParallelSearchJob:
+  public std::enable_shared_from_this<ParallelSearchJob> {
+public:
+  typedef std::shared_ptr<ParallelSearchJob> pointer;
+
+  static pointer create(BoostBasedVM& environment, const std::string& url,
+                        ParallelSearch::Kind kind, size_t workerCount) {
+    return pointer(new ParallelSearchJob(environment, url, kind,
+                                         workerCount));
+  }
+private:
+  inline
+  ParallelSearchJob(BoostBasedVM& environment, const std::string& url,
+                    ParallelSearch::Kind kind, size_t workerCount);
+
+public:
+  /** Start the search, solutions is bound to the stream of solutions */
+  inline
+  void start(UnstableNode& solutions);
+
+  /** Stop the search; the stream is closed once the workers are done */
+  void stop() {
+    _engine.stop();
+  }
+
+private:
+  // These are called in the VM thread
+
+  inline
+  void deliverSolution(const ParallelSearch::Path& path);
+
+  inline
+  void deliverEnd(bool loadFailed);
+
+private:
+  BoostBasedVM& _environment;
+  std::string _url;
+  ParallelSearch _engine;
+
+  // Only used in the VM thread
+  ProtectedSlot _tail;
+  pointer _self; // keeps the job alive until the workers are done
+};
+
+} }
+
+#endif // __BOOSTENVSEARCH_DECL_H
@@ -0,0 +1,133 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __BOOSTENVSEARCH_H
+#define __BOOSTENVSEARCH_H
+
+#include "boostenvsearch-decl.hh"
+
+#include "boostenv-decl.hh"
+
+#ifndef MOZART_GENERATOR
+
+namespace mozart { namespace boostenv {
+
+///////////////////////
+// ParallelSearchJob //
+///////////////////////
+
+namespace internal {
+  inline
+  ParallelSearch::ScriptLoader makeScriptLoader(BoostBasedVM& environment,
+                                                const std::string& url) {
+    auto bootLoader = environment.getBootLoader();
+
+    return [bootLoader, url] (VM vm, UnstableNode& script,
+                              UnstableNode& order) -> bool {
+      using namespace patternmatching;
+
+      UnstableNode value;
+      if (!bootLoader || !bootLoader(vm, url, value))
+        return false;
+
+      RichNode scriptValue, orderValue;
+      if (matchesSharp(vm, value, capture(scriptValue), capture(orderValue))) {
+        script.copy(vm, scriptValue);
+        order.copy(vm, orderValue);
+      } else {
+        script.copy(vm, value);
+      }
+
+      return true;
+    };
+  }
+}
+
+ParallelSearchJob::ParallelSearchJob(BoostBasedVM& environment,
+                                     const std::string& url,
+                                     ParallelSearch::Kind kind,
+                                     size_t workerCount):
+  _environment(environment), _url(url),
+  _engine(kind, workerCount, internal::makeScriptLoader(environment, url)) {
+}
+
+void ParallelSearchJob::start(UnstableNode& solutions) {
+  _tail = _environment.createAsyncIOFeedbackNode(solutions);
+  _self = shared_from_this();
+
+  // The handlers are called in worker threads, and must not touch _self
+  // there: the job is only released by deliverEnd(), in the VM thread,
+  // after all the events posted by the workers have been processed
+  _engine.start(
+    [this] (const ParallelSearch::Path& path) {
+      _environment.postVMEvent([this, path] () {
+        deliverSolution(path);
+      });
+    },
+    [this] (const ParallelSearch::Statistics& stats, bool loadFailed) {
+      _environment.postVMEvent([this, loadFailed] () {
+        deliverEnd(loadFailed);
+      });
+    }
+  );
+}
+
+void ParallelSearchJob::deliverSolution(const ParallelSearch::Path& path) {
+  VM vm = _environment.vm;
+
+  OzListBuilder alternatives(vm);
+  for (nativeint alternative: path)
+    alternatives.push_back(vm, alternative);
+
+  UnstableNode newTail;
+  auto newTailNode = _environment.createAsyncIOFeedbackNode(newTail);
+
+  _environment.bindAndReleaseAsyncIOFeedbackNode(
+    _tail, buildCons(vm, alternatives.get(vm), std::move(newTail)));
+  _tail = newTailNode;
+}
+
+void ParallelSearchJob::deliverEnd(bool loadFailed) {
+  VM vm = _environment.vm;
+
+  if (loadFailed) {
+    _environment.raiseAndReleaseAsyncIOFeedbackNode(
+      _tail, MOZART_STR("parallelSearch"), MOZART_STR("load"),
+      systemStrToAtom(vm, _url));
+  } else {
+    _environment.bindAndReleaseAsyncIOFeedbackNode(_tail, vm->coreatoms.nil);
+  }
+
+  _tail = ProtectedSlot();
+
+  // This may destroy this job, which joins the worker threads
+  auto self = std::move(_self);
+}
+
+} }
+
+#endif // MOZART_GENERATOR
+
+#endif // __BOOSTENVSEARCH_H
@@ -44,7 +44,7 @@ public:
 public:
   inline
   void startAsyncConnect(std::string host, std::string service,
-                         const ProtectedNode& statusNode);
+                         ProtectedSlot statusNode);
 
 private:
   protocol::resolver _resolver;
@@ -72,7 +72,7 @@ public:
   }
 
   inline
-  void startAsyncAccept(const ProtectedNode& connectionNode);
+  void startAsyncAccept(ProtectedSlot connectionNode);
 
   inline
   boost::system::error_code cancel();
@@ -42,7 +42,7 @@ TCPConnection::TCPConnection(BoostBasedVM& environment):
 }
 
 void TCPConnection::startAsyncConnect(std::string host, std::string service,
-                                      const ProtectedNode& statusNode) {
+                                      ProtectedSlot statusNode) {
   pointer self = shared_from_this();
 
   auto resolveHandler = [=] (const boost::system::error_code& error,
@@ -63,7 +63,8 @@ void TCPConnection::startAsyncConnect(std::string host, std::string service,
         }
       };
 
-      boost::asio::async_connect(socket(), endpoints, connectHandler);
+      boost::asio::async_connect(socket(), endpoints,
+                                 _strand.wrap(connectHandler));
     } else {
       _environment.postVMEvent([=] () {
         _environment.raiseAndReleaseAsyncIOFeedbackNode(
@@ -73,7 +74,7 @@ void TCPConnection::startAsyncConnect(std::string host, std::string service,
   };
 
   protocol::resolver::query query(host, service);
-  _resolver.async_resolve(query, resolveHandler);
+  _resolver.async_resolve(query, _strand.wrap(resolveHandler));
 }
 
 /////////////////
@@ -85,7 +86,7 @@ TCPAcceptor::TCPAcceptor(BoostBasedVM& environment,
   _environment(environment), _acceptor(environment.io_service, endpoint) {
 }
 
-void TCPAcceptor::startAsyncAccept(const ProtectedNode& connectionNode) {
+void TCPAcceptor::startAsyncAccept(ProtectedSlot connectionNode) {
   TCPConnection::pointer connection = TCPConnection::create(_environment);
 
   auto handler = [=] (const boost::system::error_code& error) {
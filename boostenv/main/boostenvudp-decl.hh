@@ -0,0 +1,142 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __BOOSTENVUDP_DECL_H
+#define __BOOSTENVUDP_DECL_H
+
+#include <mozart.hh>
+
+#include "boostenvutils-decl.hh"
+
+namespace mozart { namespace boostenv {
+
+///////////////
+// UDPSocket //
+///////////////
+
+/**
+ * Datagram socket
+ *
+ * Datagrams are received and sent in batches. Once the socket is ready, all
+ * the datagrams that the kernel can take or give without blocking are
+ * transferred with recvmmsg()/sendmmsg() where available, and the whole batch
+ * is handed to the VM as a single event.
+ */
+class UDPSocket: public std::enable_shared_from_this<UDPSocket> {
+public:
+  typedef boost::asio::ip::udp protocol;
+
+public:
+  typedef std::shared_ptr<UDPSocket> pointer;
+
+  static pointer create(BoostBasedVM& environment,
+                        const protocol::endpoint& endpoint) {
+    return pointer(new UDPSocket(environment, endpoint));
+  }
+
+public:
+  /** Datagrams to send, whose contents are stored one after the other */
+  struct SendBatch {
+    std::vector<char> data;
+    std::vector<std::pair<protocol::endpoint, size_t>> datagrams;
+
+    size_t sentCount = 0;
+    size_t sentSize = 0;
+  };
+
+public:
+  protocol::socket& socket() {
+    return _socket;
+  }
+
+  /**
+   * Receive at least one and at most maxCount datagrams, and bind statusNode
+   * to the list of them, as datagram(Data Host Port) tuples.
+   * Datagrams longer than maxSize bytes are truncated.
+   * Only one receive may be pending at a time, see isReceiving().
+   */
+  inline
+  void startAsyncReceive(size_t maxCount, size_t maxSize,
+                         ProtectedSlot statusNode);
+
+  /** Whether a receive is pending; only meaningful in the VM thread */
+  bool isReceiving() {
+    return _receiving;
+  }
+
+  /** Send a batch, and bind statusNode to the number of datagrams sent */
+  inline
+  void startAsyncSend(std::shared_ptr<SendBatch> batch,
+                      ProtectedSlot statusNode);
+
+  inline
+  boost::system::error_code close();
+
+private:
+  inline
+  UDPSocket(BoostBasedVM& environment, const protocol::endpoint& endpoint);
+
+  inline
+  void asyncReceive(size_t maxCount, size_t maxSize,
+                    ProtectedSlot statusNode);
+
+  inline
+  void receiveFailed(int errnum, ProtectedSlot statusNode);
+
+  inline
+  void receiveBatch(size_t maxCount, size_t maxSize,
+                    boost::system::error_code& error);
+
+  inline
+  void receivedHandler(size_t maxSize, ProtectedSlot statusNode);
+
+  inline
+  void sendBatch(SendBatch& batch, boost::system::error_code& error);
+
+  inline
+  void continueSend(std::shared_ptr<SendBatch> batch,
+                    ProtectedSlot statusNode);
+
+  inline
+  void raiseAndRelease(const nchar* function, int errnum,
+                       ProtectedSlot statusNode);
+
+private:
+  BoostBasedVM& _environment;
+  protocol::socket _socket;
+
+  // Serializes the completion handlers of this socket
+  boost::asio::io_service::strand _strand;
+
+  // Only changed in the VM thread, when no receive is pending
+  bool _receiving;
+  std::vector<char> _receiveData;
+
+  std::vector<std::pair<protocol::endpoint, size_t>> _received;
+};
+
+} }
+
+#endif // __BOOSTENVUDP_DECL_H
@@ -0,0 +1,314 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __BOOSTENVUDP_H
+#define __BOOSTENVUDP_H
+
+#include "boostenvudp-decl.hh"
+
+#include "boostenv-decl.hh"
+
+#ifndef MOZART_GENERATOR
+
+#ifdef __linux__
+#  include <cerrno>
+#  include <cstring>
+#  include <sys/socket.h>
+#endif
+
+namespace mozart { namespace boostenv {
+
+///////////////
+// UDPSocket //
+///////////////
+
+UDPSocket::UDPSocket(BoostBasedVM& environment,
+                     const protocol::endpoint& endpoint):
+  _environment(environment), _socket(environment.io_service, endpoint),
+  _strand(environment.io_service), _receiving(false) {
+
+  // Batches are transferred until the socket would block
+  _socket.non_blocking(true);
+}
+
+void UDPSocket::startAsyncReceive(size_t maxCount, size_t maxSize,
+                                  ProtectedSlot statusNode) {
+  // The pending receive writes into _receiveData from an I/O thread
+  assert(!_receiving);
+  _receiving = true;
+
+  _receiveData.resize(maxCount * maxSize);
+
+  asyncReceive(maxCount, maxSize, statusNode);
+}
+
+void UDPSocket::asyncReceive(size_t maxCount, size_t maxSize,
+                             ProtectedSlot statusNode) {
+  pointer self = shared_from_this();
+
+  auto handler = [=] (const boost::system::error_code& error, size_t) {
+    if (error) {
+      self->receiveFailed(error.value(), statusNode);
+      return;
+    }
+
+    boost::system::error_code ec;
+    self->receiveBatch(maxCount, maxSize, ec);
+
+    if (ec) {
+      self->receiveFailed(ec.value(), statusNode);
+    } else if (_received.empty()) {
+      // Spurious wake up
+      asyncReceive(maxCount, maxSize, statusNode);
+    } else {
+      _environment.postVMEvent([=] () {
+        self->receivedHandler(maxSize, statusNode);
+      });
+    }
+  };
+
+  // Wait until the socket is readable, then receive the batch ourselves
+  _socket.async_receive(boost::asio::null_buffers(), _strand.wrap(handler));
+}
+
+void UDPSocket::receiveFailed(int errnum, ProtectedSlot statusNode) {
+  pointer self = shared_from_this();
+
+  _environment.postVMEvent([=] () {
+    self->_receiving = false;
+    self->_environment.raiseAndReleaseAsyncIOFeedbackNode(
+      statusNode, MOZART_STR("socket"), MOZART_STR("receive"), errnum);
+  });
+}
+
+void UDPSocket::receiveBatch(size_t maxCount, size_t maxSize,
+                             boost::system::error_code& error) {
+  _received.clear();
+
+#ifdef __linux__
+  std::vector<mmsghdr> headers(maxCount);
+  std::vector<iovec> iovs(maxCount);
+  std::vector<sockaddr_storage> addresses(maxCount);
+
+  for (size_t i = 0; i < maxCount; i++) {
+    iovs[i].iov_base = &_receiveData[i * maxSize];
+    iovs[i].iov_len = maxSize;
+
+    std::memset(&headers[i], 0, sizeof(mmsghdr));
+    headers[i].msg_hdr.msg_iov = &iovs[i];
+    headers[i].msg_hdr.msg_iovlen = 1;
+    headers[i].msg_hdr.msg_name = &addresses[i];
+    headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+  }
+
+  int count = ::recvmmsg(_socket.native_handle(), headers.data(), maxCount,
+                         MSG_DONTWAIT, nullptr);
+
+  if (count < 0) {
+    if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+      error.assign(errno, boost::system::system_category());
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    protocol::endpoint endpoint;
+    std::memcpy(endpoint.data(), &addresses[i],
+                headers[i].msg_hdr.msg_namelen);
+    endpoint.resize(headers[i].msg_hdr.msg_namelen);
+
+    _received.emplace_back(endpoint, std::min<size_t>(headers[i].msg_len,
+                                                      maxSize));
+  }
+#else
+  for (size_t i = 0; i < maxCount; i++) {
+    protocol::endpoint endpoint;
+    size_t size = _socket.receive_from(
+      boost::asio::buffer(&_receiveData[i * maxSize], maxSize),
+      endpoint, 0, error);
+
+    if (error == boost::asio::error::message_size) {
+      // Truncated datagram
+      error.clear();
+      size = maxSize;
+    }
+
+    if (error) {
+      if (error == boost::asio::error::would_block)
+        error.clear();
+      return;
+    }
+
+    _received.emplace_back(endpoint, size);
+  }
+#endif
+}
+
+void UDPSocket::receivedHandler(size_t maxSize, ProtectedSlot statusNode) {
+  VM vm = _environment.vm;
+  _receiving = false;
+
+  OzListBuilder datagrams(vm);
+  for (size_t i = 0; i < _received.size(); i++) {
+    auto& endpoint = _received[i].first;
+
+    auto data = newLString(
+      vm, (const unsigned char*) &_receiveData[i * maxSize],
+      (nativeint) _received[i].second);
+
+    auto hostStr = endpoint.address().to_string();
+    auto host = toUTF<nchar>(makeLString(hostStr.c_str(), hostStr.size()));
+
+    datagrams.push_back(vm, buildTuple(
+      vm, MOZART_STR("datagram"), ByteString::build(vm, data),
+      vm->getAtom(host.length, host.string), (nativeint) endpoint.port()));
+  }
+
+  _environment.bindAndReleaseAsyncIOFeedbackNode(statusNode,
+                                                 datagrams.get(vm));
+}
+
+void UDPSocket::startAsyncSend(std::shared_ptr<SendBatch> batch,
+                               ProtectedSlot statusNode) {
+  pointer self = shared_from_this();
+
+  // A datagram socket is seldom full, so try to send right away
+  _strand.post([=] () {
+    self->continueSend(batch, statusNode);
+  });
+}
+
+void UDPSocket::continueSend(std::shared_ptr<SendBatch> batch,
+                             ProtectedSlot statusNode) {
+  pointer self = shared_from_this();
+
+  boost::system::error_code ec;
+  sendBatch(*batch, ec);
+
+  if (ec) {
+    raiseAndRelease(MOZART_STR("send"), ec.value(), statusNode);
+  } else if (batch->sentCount == batch->datagrams.size()) {
+    _environment.postVMEvent([=] () {
+      self->_environment.bindAndReleaseAsyncIOFeedbackNode(
+        statusNode, (nativeint) batch->sentCount);
+    });
+  } else {
+    auto handler = [=] (const boost::system::error_code& error, size_t) {
+      if (error)
+        raiseAndRelease(MOZART_STR("send"), error.value(), statusNode);
+      else
+        self->continueSend(batch, statusNode);
+    };
+
+    // Wait until the socket is writable again
+    _socket.async_send(boost::asio::null_buffers(), _strand.wrap(handler));
+  }
+}
+
+void UDPSocket::sendBatch(SendBatch& batch,
+                          boost::system::error_code& error) {
+#ifdef __linux__
+  // Maximum number of datagrams per call to sendmmsg()
+  constexpr size_t maxCount = 1024;
+
+  while (batch.sentCount < batch.datagrams.size()) {
+    size_t count = std::min(batch.datagrams.size() - batch.sentCount,
+                            maxCount);
+
+    std::vector<mmsghdr> headers(count);
+    std::vector<iovec> iovs(count);
+
+    size_t offset = batch.sentSize;
+    for (size_t i = 0; i < count; i++) {
+      auto& datagram = batch.datagrams[batch.sentCount + i];
+
+      iovs[i].iov_base = batch.data.data() + offset;
+      iovs[i].iov_len = datagram.second;
+      offset += datagram.second;
+
+      std::memset(&headers[i], 0, sizeof(mmsghdr));
+      headers[i].msg_hdr.msg_iov = &iovs[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+      headers[i].msg_hdr.msg_name = datagram.first.data();
+      headers[i].msg_hdr.msg_namelen = datagram.first.size();
+    }
+
+    int sent = ::sendmmsg(_socket.native_handle(), headers.data(), count,
+                          MSG_DONTWAIT);
+
+    if (sent < 0) {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+        error.assign(errno, boost::system::system_category());
+      return;
+    }
+
+    for (int i = 0; i < sent; i++)
+      batch.sentSize += batch.datagrams[batch.sentCount + i].second;
+    batch.sentCount += sent;
+
+    if ((size_t) sent < count)
+      return;
+  }
+#else
+  while (batch.sentCount < batch.datagrams.size()) {
+    auto& datagram = batch.datagrams[batch.sentCount];
+
+    auto data = batch.data.data() + batch.sentSize;
+    _socket.send_to(boost::asio::buffer(data, datagram.second),
+                    datagram.first, 0, error);
+
+    if (error) {
+      if (error == boost::asio::error::would_block)
+        error.clear();
+      return;
+    }
+
+    batch.sentSize += datagram.second;
+    batch.sentCount++;
+  }
+#endif
+}
+
+boost::system::error_code UDPSocket::close() {
+  boost::system::error_code error;
+  _socket.close(error);
+  return error;
+}
+
+void UDPSocket::raiseAndRelease(const nchar* function, int errnum,
+                                ProtectedSlot statusNode) {
+  // Do not rely on this socket being still alive in the VM thread
+  BoostBasedVM* environment = &_environment;
+
+  environment->postVMEvent([=] () {
+    environment->raiseAndReleaseAsyncIOFeedbackNode(
+      statusNode, MOZART_STR("socket"), function, errnum);
+  });
+}
+
+} }
+
+#endif
+
+#endif // __BOOSTENVUDP_H
@@ -0,0 +1,127 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __BOOSTENVUNIX_DECL_H
+#define __BOOSTENVUNIX_DECL_H
+
+#include <mozart.hh>
+
+#include "boostenvutils-decl.hh"
+
+namespace mozart { namespace boostenv {
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+////////////////////
+// UnixConnection //
+////////////////////
+
+/**
+ * Connection on a Unix domain socket
+ *
+ * Besides bytes, a Unix connection can carry the socket of another
+ * connection to a peer process, so that e.g. an accepted TCP connection can
+ * be handed over to another VM. The socket travels with a one-byte marker in
+ * the byte stream, hence socket passing must not be interleaved with pending
+ * reads or writes on the same connection.
+ */
+class UnixConnection: public BaseSocketConnection<UnixConnection,
+  boost::asio::local::stream_protocol> {
+public:
+  inline
+  UnixConnection(BoostBasedVM& environment);
+
+public:
+  inline
+  void startAsyncConnect(std::string path, ProtectedSlot statusNode);
+
+  /**
+   * Send the socket fd to the peer, and bind statusNode to unit once it is
+   * sent. keepAlive is held until then, so that fd stays open.
+   */
+  inline
+  void startAsyncSendSocket(int fd, std::shared_ptr<void> keepAlive,
+                            ProtectedSlot statusNode);
+
+  /**
+   * Receive a socket sent by the peer, and bind statusNode to a new
+   * TCPConnection or UnixConnection, depending on its address family
+   */
+  inline
+  void startAsyncReceiveSocket(ProtectedSlot statusNode);
+
+private:
+  inline
+  void receivedSocketHandler(int fd, ProtectedSlot statusNode);
+
+  inline
+  void raiseAndRelease(const nchar* function, int errnum,
+                       ProtectedSlot statusNode);
+};
+
+//////////////////
+// UnixAcceptor //
+//////////////////
+
+class UnixAcceptor: public std::enable_shared_from_this<UnixAcceptor> {
+private:
+  typedef boost::asio::local::stream_protocol protocol;
+
+public:
+  typedef std::shared_ptr<UnixAcceptor> pointer;
+
+  static pointer create(BoostBasedVM& environment,
+                        const protocol::endpoint& endpoint) {
+    return pointer(new UnixAcceptor(environment, endpoint));
+  }
+
+public:
+  protocol::acceptor& acceptor() {
+    return _acceptor;
+  }
+
+  inline
+  void startAsyncAccept(ProtectedSlot connectionNode);
+
+  inline
+  boost::system::error_code cancel();
+
+  inline
+  boost::system::error_code close();
+
+private:
+  inline
+  UnixAcceptor(BoostBasedVM& environment, const protocol::endpoint& endpoint);
+
+private:
+  BoostBasedVM& _environment;
+  protocol::acceptor _acceptor;
+};
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+} }
+
+#endif // __BOOSTENVUNIX_DECL_H
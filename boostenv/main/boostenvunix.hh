@@ -0,0 +1,305 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __BOOSTENVUNIX_H
+#define __BOOSTENVUNIX_H
+
+#include "boostenvunix-decl.hh"
+
+#include "boostenv-decl.hh"
+#include "boostenvtcp-decl.hh"
+
+#ifndef MOZART_GENERATOR
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+#  include <cerrno>
+#  include <cstring>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+namespace mozart { namespace boostenv {
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+////////////////////
+// UnixConnection //
+////////////////////
+
+UnixConnection::UnixConnection(BoostBasedVM& environment):
+  BaseSocketConnection(environment) {
+}
+
+void UnixConnection::startAsyncConnect(std::string path,
+                                       ProtectedSlot statusNode) {
+  pointer self = shared_from_this();
+
+  auto handler = [=] (const boost::system::error_code& error) {
+    if (!error) {
+      _environment.postVMEvent([=] () {
+        _environment.bindAndReleaseAsyncIOFeedbackNode(
+          statusNode, build(_environment.vm, self));
+      });
+    } else {
+      raiseAndRelease(MOZART_STR("connect"), error.value(), statusNode);
+    }
+  };
+
+  protocol::endpoint endpoint;
+  try {
+    endpoint = protocol::endpoint(path);
+  } catch (const boost::system::system_error& error) {
+    // The path does not fit in a socket address, and no handler will run
+    raiseAndRelease(MOZART_STR("connect"), error.code().value(), statusNode);
+    return;
+  }
+
+  socket().async_connect(endpoint, _strand.wrap(handler));
+}
+
+void UnixConnection::startAsyncSendSocket(int fd,
+                                          std::shared_ptr<void> keepAlive,
+                                          ProtectedSlot statusNode) {
+  pointer self = shared_from_this();
+
+  auto handler = [=] (const boost::system::error_code& error, size_t) {
+    if (error) {
+      raiseAndRelease(MOZART_STR("sendmsg"), error.value(), statusNode);
+      return;
+    }
+
+    char marker = 0;
+    iovec iov;
+    iov.iov_base = &marker;
+    iov.iov_len = 1;
+
+    union {
+      cmsghdr header;
+      char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    std::memset(&control, 0, sizeof(control));
+
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.space;
+    message.msg_controllen = sizeof(control.space);
+
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+
+    if (::sendmsg(self->socket().native_handle(), &message, flags) >= 0) {
+      _environment.postVMEvent([=] () {
+        _environment.bindAndReleaseAsyncIOFeedbackNode(statusNode, unit);
+      });
+    } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      // Spurious wake up
+      startAsyncSendSocket(fd, keepAlive, statusNode);
+    } else {
+      raiseAndRelease(MOZART_STR("sendmsg"), errno, statusNode);
+    }
+  };
+
+  // Wait until the socket is writable, then send the message ourselves
+  socket().async_write_some(boost::asio::null_buffers(),
+                            _strand.wrap(handler));
+}
+
+void UnixConnection::startAsyncReceiveSocket(ProtectedSlot statusNode) {
+  pointer self = shared_from_this();
+
+  auto handler = [=] (const boost::system::error_code& error, size_t) {
+    if (error) {
+      raiseAndRelease(MOZART_STR("recvmsg"), error.value(), statusNode);
+      return;
+    }
+
+    char marker;
+    iovec iov;
+    iov.iov_base = &marker;
+    iov.iov_len = 1;
+
+    union {
+      cmsghdr header;
+      char space[CMSG_SPACE(sizeof(int))];
+    } control;
+    std::memset(&control, 0, sizeof(control));
+
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.space;
+    message.msg_controllen = sizeof(control.space);
+
+    int flags = 0;
+#ifdef MSG_CMSG_CLOEXEC
+    flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+    ssize_t received = ::recvmsg(self->socket().native_handle(), &message,
+                                 flags);
+
+    if (received < 0) {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        startAsyncReceiveSocket(statusNode); // Spurious wake up
+      else
+        raiseAndRelease(MOZART_STR("recvmsg"), errno, statusNode);
+      return;
+    } else if (received == 0) {
+      // The peer closed the connection
+      raiseAndRelease(MOZART_STR("recvmsg"), ECONNRESET, statusNode);
+      return;
+    }
+
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    if ((header == nullptr) || (header->cmsg_level != SOL_SOCKET) ||
+        (header->cmsg_type != SCM_RIGHTS) ||
+        (header->cmsg_len != CMSG_LEN(sizeof(int)))) {
+      raiseAndRelease(MOZART_STR("recvmsg"), EBADMSG, statusNode);
+      return;
+    }
+
+    int fd;
+    std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+
+    _environment.postVMEvent([=] () {
+      self->receivedSocketHandler(fd, statusNode);
+    });
+  };
+
+  // Wait until the socket is readable, then receive the message ourselves
+  socket().async_read_some(boost::asio::null_buffers(),
+                           _strand.wrap(handler));
+}
+
+void UnixConnection::receivedSocketHandler(int fd,
+                                           ProtectedSlot statusNode) {
+  VM vm = _environment.vm;
+  boost::system::error_code error;
+
+  sockaddr_storage address;
+  socklen_t addressLength = sizeof(address);
+  if (::getsockname(fd, (sockaddr*) &address, &addressLength) != 0) {
+    error.assign(errno, boost::system::system_category());
+  } else if (address.ss_family == AF_UNIX) {
+    auto connection = UnixConnection::create(_environment);
+    connection->socket().assign(protocol(), fd, error);
+    if (!error) {
+      _environment.bindAndReleaseAsyncIOFeedbackNode(
+        statusNode, build(vm, connection));
+      return;
+    }
+  } else if ((address.ss_family == AF_INET) ||
+             (address.ss_family == AF_INET6)) {
+    using boost::asio::ip::tcp;
+
+    auto connection = TCPConnection::create(_environment);
+    connection->socket().assign(
+      address.ss_family == AF_INET ? tcp::v4() : tcp::v6(), fd, error);
+    if (!error) {
+      _environment.bindAndReleaseAsyncIOFeedbackNode(
+        statusNode, build(vm, connection));
+      return;
+    }
+  } else {
+    error.assign(EAFNOSUPPORT, boost::system::system_category());
+  }
+
+  ::close(fd);
+  _environment.raiseAndReleaseAsyncIOFeedbackNode(
+    statusNode, MOZART_STR("socket"), MOZART_STR("recvmsg"), error.value());
+}
+
+void UnixConnection::raiseAndRelease(const nchar* function, int errnum,
+                                     ProtectedSlot statusNode) {
+  // Do not rely on this connection being still alive in the VM thread
+  BoostBasedVM* environment = &_environment;
+
+  environment->postVMEvent([=] () {
+    environment->raiseAndReleaseAsyncIOFeedbackNode(
+      statusNode, MOZART_STR("socket"), function, errnum);
+  });
+}
+
+//////////////////
+// UnixAcceptor //
+//////////////////
+
+UnixAcceptor::UnixAcceptor(BoostBasedVM& environment,
+                           const protocol::endpoint& endpoint):
+  _environment(environment), _acceptor(environment.io_service, endpoint) {
+}
+
+void UnixAcceptor::startAsyncAccept(ProtectedSlot connectionNode) {
+  UnixConnection::pointer connection = UnixConnection::create(_environment);
+
+  auto handler = [=] (const boost::system::error_code& error) {
+    if (!error) {
+      _environment.postVMEvent([=] () {
+        _environment.bindAndReleaseAsyncIOFeedbackNode(
+          connectionNode, build(_environment.vm, connection));
+      });
+    } else if (error == boost::asio::error::operation_aborted) {
+      _environment.postVMEvent([=] () {
+        _environment.releaseAsyncIONode(connectionNode);
+      });
+    } else {
+      // Try again
+      startAsyncAccept(connectionNode);
+    }
+  };
+
+  acceptor().async_accept(connection->socket(), handler);
+}
+
+boost::system::error_code UnixAcceptor::cancel() {
+  boost::system::error_code error;
+  _acceptor.cancel(error);
+  return error;
+}
+
+boost::system::error_code UnixAcceptor::close() {
+  boost::system::error_code error;
+  _acceptor.close(error);
+  return error;
+}
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+} }
+
+#endif
+
+#endif // __BOOSTENVUNIX_H
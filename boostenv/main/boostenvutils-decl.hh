@@ -57,6 +57,9 @@ public:
   inline
   BaseSocketConnection(BoostBasedVM& environment);
 
+  inline
+  ~BaseSocketConnection();
+
 public:
   typename protocol::socket& socket() {
     return _socket;
@@ -66,34 +69,125 @@ public:
     return _readData;
   }
 
-  std::vector<char>& getWriteData() {
-    return _writeData;
-  }
+  inline
+  void startAsyncRead(ProtectedSlot tailNode,
+                      ProtectedSlot statusNode);
 
   inline
-  void startAsyncRead(const ProtectedNode& tailNode,
-                      const ProtectedNode& statusNode);
+  void startAsyncReadSome(ProtectedSlot tailNode,
+                          ProtectedSlot statusNode);
+
+  /**
+   * Write a VirtualByteString at the end of the write queue, in a single
+   * pass, and return its size. This may throw Mozart exceptions, in which
+   * case the partial data is dropped by the next call.
+   * The data is sent only once it is committed with queueWrite().
+   */
+  inline
+  size_t bufferWrite(VM vm, RichNode data);
+
+  /**
+   * Write the binary pickle of a value at the end of the write queue, and
+   * return its size. The value must have passed
+   * StreamSerializer::checkSerializable().
+   * Every portion of StreamSerializer::flushThreshold bytes is committed as
+   * soon as it is produced, and sent right away if the socket is idle. The
+   * writes that complete meanwhile are only handled once the VM gets back to
+   * its events, though, so the queue may still hold up to the whole pickle.
+   * Call queueWrite() afterwards to be told when it has been sent.
+   */
+  inline
+  size_t bufferSerialize(VM vm, RichNode value);
 
+  /**
+   * Commit the data written since the last commit, and bind statusNode to
+   * size once it has been sent.
+   */
   inline
-  void startAsyncReadSome(const ProtectedNode& tailNode,
-                          const ProtectedNode& statusNode);
+  void queueWrite(size_t size, ProtectedSlot statusNode);
+
+  /** Hold back the queued writes until flushWrites() is called */
+  void corkWrites() {
+    _corked = true;
+  }
 
+  /** Uncork the write queue, and send what it holds */
   inline
-  void startAsyncWrite(const ProtectedNode& statusNode);
+  void flushWrites();
+
+  /** Fail the writes that have not been handed to the socket yet */
+  inline
+  void abortQueuedWrites();
 
 protected:
   inline
   void readHandler(const boost::system::error_code& error,
                    size_t bytes_transferred,
-                   const ProtectedNode& tailNode,
-                   const ProtectedNode& statusNode);
+                   ProtectedSlot tailNode,
+                   ProtectedSlot statusNode);
+
+private:
+  inline
+  void startAsyncWrite();
+
+  inline
+  void writeHandler(const boost::system::error_code& error);
+
+private:
+  /** Sink that commits the portions of a pickle to the write queue */
+  class QueueSink: public SerializationSink {
+  public:
+    explicit QueueSink(BaseSocketConnection& connection):
+      _connection(connection), _size(0) {}
+
+    inline
+    void write(VM vm, ChunkedBuffer& buffer);
+
+    size_t size() {
+      return _size;
+    }
+  private:
+    BaseSocketConnection& _connection;
+    size_t _size;
+  };
+
+  /**
+   * Writes are coalesced into the chunks of a buffer, and a batch of chunks
+   * is sent with a single scatter/gather write
+   */
+  struct WriteBatch {
+    bool empty() {
+      return (committedSize == 0) && completions.empty();
+    }
+
+    void clear() {
+      buffer.clear();
+      committedSize = 0;
+      completions.clear();
+    }
+
+    ChunkedBuffer buffer;
+    size_t committedSize = 0;
+    std::vector<std::pair<ProtectedSlot, size_t>> completions;
+  };
 
 protected:
   BoostBasedVM& _environment;
   typename protocol::socket _socket;
 
+  // Serializes the completion handlers of this connection
+  boost::asio::io_service::strand _strand;
+
   std::vector<char> _readData;
-  std::vector<char> _writeData;
+
+  WriteBatch _queuedWrites;
+  WriteBatch _pendingWrites;
+  bool _writing;
+  bool _corked;
+
+  // A batch may end with part of a pickle, whose completion is in a later
+  // batch, so the first error fails all the later writes too
+  boost::system::error_code _writeError;
 };
 
 } }
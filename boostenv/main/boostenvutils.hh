@@ -39,12 +39,31 @@ namespace mozart { namespace boostenv {
 
 template <typename T, typename P>
 BaseSocketConnection<T, P>::BaseSocketConnection(BoostBasedVM& environment):
-  _environment(environment), _socket(environment.io_service) {
+  _environment(environment), _socket(environment.io_service),
+  _strand(environment.io_service), _writing(false), _corked(false) {
+}
+
+template <typename T, typename P>
+BaseSocketConnection<T, P>::~BaseSocketConnection() {
+  // Writes still corked when the connection is dropped will never be sent.
+  // This may run in an I/O thread, so their nodes are released in the VM one.
+  if (!_queuedWrites.empty()) {
+    BoostBasedVM* environment = &_environment;
+    auto completions = std::move(_queuedWrites.completions);
+
+    environment->postVMEvent([=] () {
+      for (auto& completion: completions) {
+        environment->raiseAndReleaseAsyncIOFeedbackNode(
+          completion.first, MOZART_STR("socketOrPipe"), MOZART_STR("write"),
+          (int) boost::asio::error::operation_aborted);
+      }
+    });
+  }
 }
 
 template <typename T, typename P>
 void BaseSocketConnection<T, P>::startAsyncRead(
-  const ProtectedNode& tailNode, const ProtectedNode& statusNode) {
+  ProtectedSlot tailNode, ProtectedSlot statusNode) {
 
   pointer self = this->shared_from_this();
   auto handler = [=] (const boost::system::error_code& error,
@@ -52,12 +71,13 @@ void BaseSocketConnection<T, P>::startAsyncRead(
     self->readHandler(error, bytes_transferred, tailNode, statusNode);
   };
 
-  boost::asio::async_read(_socket, boost::asio::buffer(_readData), handler);
+  boost::asio::async_read(_socket, boost::asio::buffer(_readData),
+                          _strand.wrap(handler));
 }
 
 template <typename T, typename P>
 void BaseSocketConnection<T, P>::startAsyncReadSome(
-  const ProtectedNode& tailNode, const ProtectedNode& statusNode) {
+  ProtectedSlot tailNode, ProtectedSlot statusNode) {
 
   pointer self = this->shared_from_this();
   auto handler = [=] (const boost::system::error_code& error,
@@ -65,41 +85,146 @@ void BaseSocketConnection<T, P>::startAsyncReadSome(
     self->readHandler(error, bytes_transferred, tailNode, statusNode);
   };
 
-  _socket.async_read_some(boost::asio::buffer(_readData), handler);
+  _socket.async_read_some(boost::asio::buffer(_readData),
+                          _strand.wrap(handler));
+}
+
+template <typename T, typename P>
+size_t BaseSocketConnection<T, P>::bufferWrite(VM vm, RichNode data) {
+  auto& batch = _queuedWrites;
+
+  // Drop what an interrupted call left behind
+  batch.buffer.truncate(batch.committedSize);
+
+  ozVBSWrite(vm, data, batch.buffer);
+
+  return batch.buffer.size() - batch.committedSize;
+}
+
+template <typename T, typename P>
+size_t BaseSocketConnection<T, P>::bufferSerialize(VM vm, RichNode value) {
+  auto& batch = _queuedWrites;
+
+  batch.buffer.truncate(batch.committedSize);
+
+  QueueSink sink(*this);
+
+  auto& buffer = vm->getOutputBuffer();
+  buffer.clear();
+  StreamSerializer(vm, buffer, &sink).serialize(value);
+
+  return sink.size();
+}
+
+template <typename T, typename P>
+void BaseSocketConnection<T, P>::QueueSink::write(VM vm,
+                                                  ChunkedBuffer& buffer) {
+  auto& batch = _connection._queuedWrites;
+
+  buffer.forEachChunk([&] (const char* data, size_t size) {
+    batch.buffer.append(data, size);
+  });
+
+  _size += buffer.size();
+  batch.committedSize = batch.buffer.size();
+
+  if (!_connection._corked && !_connection._writing)
+    _connection.startAsyncWrite();
 }
 
 template <typename T, typename P>
-void BaseSocketConnection<T, P>::startAsyncWrite(
-  const ProtectedNode& statusNode) {
+void BaseSocketConnection<T, P>::queueWrite(size_t size,
+                                            ProtectedSlot statusNode) {
+  auto& batch = _queuedWrites;
+
+  batch.committedSize = batch.buffer.size();
+  batch.completions.emplace_back(statusNode, size);
+
+  if (!_corked && !_writing)
+    startAsyncWrite();
+}
+
+template <typename T, typename P>
+void BaseSocketConnection<T, P>::flushWrites() {
+  _corked = false;
+
+  if (!_writing && !_queuedWrites.empty())
+    startAsyncWrite();
+}
+
+template <typename T, typename P>
+void BaseSocketConnection<T, P>::abortQueuedWrites() {
+  for (auto& completion: _queuedWrites.completions) {
+    _environment.raiseAndReleaseAsyncIOFeedbackNode(
+      completion.first, MOZART_STR("socketOrPipe"), MOZART_STR("write"),
+      (int) boost::asio::error::operation_aborted);
+  }
+
+  _queuedWrites.clear();
+}
+
+template <typename T, typename P>
+void BaseSocketConnection<T, P>::startAsyncWrite() {
+  // The pending batch is empty here, so this takes all the queued writes
+  std::swap(_queuedWrites, _pendingWrites);
+  _writing = true;
+
+  // Whatever follows the committed data belongs to an interrupted write
+  _pendingWrites.buffer.truncate(_pendingWrites.committedSize);
+
+  std::vector<boost::asio::const_buffer> buffers;
+  _pendingWrites.buffer.forEachChunk([&] (const char* data, size_t size) {
+    buffers.push_back(boost::asio::buffer(data, size));
+  });
 
   pointer self = this->shared_from_this();
   auto handler = [=] (const boost::system::error_code& error,
                       size_t bytes_transferred) {
     self->_environment.postVMEvent([=] () {
-      if (!error) {
-        self->_environment.bindAndReleaseAsyncIOFeedbackNode(
-          statusNode, bytes_transferred);
-      } else {
-        self->_environment.raiseAndReleaseAsyncIOFeedbackNode(
-          statusNode, MOZART_STR("socketOrPipe"), MOZART_STR("write"), error.value());
-      }
+      self->writeHandler(error);
     });
   };
 
-  boost::asio::async_write(_socket, boost::asio::buffer(_writeData), handler);
+  boost::asio::async_write(_socket, buffers, _strand.wrap(handler));
+}
+
+template <typename T, typename P>
+void BaseSocketConnection<T, P>::writeHandler(
+  const boost::system::error_code& error) {
+
+  if (error && !_writeError)
+    _writeError = error;
+
+  // Report the completion of the whole batch at once
+  for (auto& completion: _pendingWrites.completions) {
+    if (!_writeError) {
+      _environment.bindAndReleaseAsyncIOFeedbackNode(
+        completion.first, completion.second);
+    } else {
+      _environment.raiseAndReleaseAsyncIOFeedbackNode(
+        completion.first, MOZART_STR("socketOrPipe"), MOZART_STR("write"),
+        _writeError.value());
+    }
+  }
+
+  _pendingWrites.clear();
+  _writing = false;
+
+  if (!_corked && !_queuedWrites.empty())
+    startAsyncWrite();
 }
 
 template <typename T, typename P>
 void BaseSocketConnection<T, P>::readHandler(
   const boost::system::error_code& error, size_t bytes_transferred,
-  const ProtectedNode& tailNode, const ProtectedNode& statusNode) {
+  ProtectedSlot tailNode, ProtectedSlot statusNode) {
 
   pointer self = this->shared_from_this();
   _environment.postVMEvent([=] () {
     if (!error) {
       VM vm = _environment.vm;
 
-      UnstableNode head(vm, *tailNode);
+      UnstableNode head(vm, vm->getProtectedSlot(tailNode));
       for (size_t i = bytes_transferred; i > 0; i--)
         head = buildCons(vm, (nativeint) (unsigned char) _readData[i-1],
                          std::move(head));
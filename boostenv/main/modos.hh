@@ -30,6 +30,8 @@
 #include "boostenv-decl.hh"
 #include "boostenvtcp-decl.hh"
 #include "boostenvpipe-decl.hh"
+#include "boostenvunix-decl.hh"
+#include "boostenvudp-decl.hh"
 
 #include <iostream>
 
@@ -357,21 +359,18 @@ public:
 
     static void call(VM vm, In fileNode, In data, Out writtenCount) {
       auto file = getFileArgument(vm, fileNode)->file();
-      size_t bufSize = ozVBSLengthForBuffer(vm, data);
 
-      if (bufSize == 0) {
-        writtenCount = build(vm, 0);
-        return;
-      }
+      auto& buffer = vm->getOutputBuffer();
+      buffer.clear();
+      ozVBSWrite(vm, data, buffer);
 
-      size_t writtenSize;
-      {
-        std::vector<char> buffer;
-        ozVBSGet(vm, data, bufSize, buffer);
-        bufSize = buffer.size();
+      size_t bufSize = buffer.size();
+      size_t writtenSize = 0;
+      buffer.forEachChunk([&] (const char* chunk, size_t size) {
+        writtenSize += std::fwrite(chunk, 1, size, file);
+      });
 
-        writtenSize = std::fwrite(buffer.data(), 1, bufSize, file);
-      }
+      buffer.clear();
 
       if (writtenSize != bufSize)
         raiseLastOSError(vm, MOZART_STR("fwrite"));
@@ -380,6 +379,56 @@ public:
     }
   };
 
+  class FwriteSerialized: public Builtin<FwriteSerialized> {
+  public:
+    FwriteSerialized(): Builtin("fwriteSerialized") {}
+
+    static void call(VM vm, In fileNode, In value, Out writtenCount) {
+      FileSink sink(getFileArgument(vm, fileNode)->file());
+      StreamSerializer::checkSerializable(vm, value);
+
+      auto& buffer = vm->getOutputBuffer();
+      buffer.clear();
+      StreamSerializer(vm, buffer, &sink).serialize(value);
+
+      if (sink.failed())
+        raiseLastOSError(vm, MOZART_STR("fwrite"));
+
+      writtenCount = build(vm, sink.writtenSize());
+    }
+
+  private:
+    /** Sink that writes the chunks to a file as they come */
+    class FileSink: public SerializationSink {
+    public:
+      explicit FileSink(std::FILE* file):
+        _file(file), _writtenSize(0), _failed(false) {}
+
+      void write(VM vm, ChunkedBuffer& buffer) {
+        buffer.forEachChunk([&] (const char* data, size_t size) {
+          if (_failed)
+            return;
+
+          size_t written = std::fwrite(data, 1, size, _file);
+          _writtenSize += written;
+          _failed = (written != size);
+        });
+      }
+
+      size_t writtenSize() {
+        return _writtenSize;
+      }
+
+      bool failed() {
+        return _failed;
+      }
+    private:
+      std::FILE* _file;
+      size_t _writtenSize;
+      bool _failed;
+    };
+  };
+
   class Fseek: public Builtin<Fseek> {
   public:
     Fseek(): Builtin("fseek") {}
@@ -589,22 +638,45 @@ private:
   static void baseSocketConnectionWrite(
     VM vm, BaseSocketConnection<T, P>* connection, In data, Out status) {
 
-    size_t bufSize = ozVBSLengthForBuffer(vm, data);
+    size_t size = connection->bufferWrite(vm, data);
 
     // 0 size
-    if (bufSize == 0) {
+    if (size == 0) {
       status = build(vm, 0);
       return;
     }
 
-    // Fetch the data to write
-    connection->getWriteData().clear();
-    ozVBSGet(vm, data, bufSize, connection->getWriteData());
+    auto statusNode =
+      BoostBasedVM::forVM(vm).createAsyncIOFeedbackNode(status);
+
+    connection->queueWrite(size, statusNode);
+  }
+
+  template <typename T, typename P>
+  static void baseSocketConnectionWriteSerialized(
+    VM vm, BaseSocketConnection<T, P>* connection, In value, Out status) {
+
+    StreamSerializer::checkSerializable(vm, value);
+    size_t size = connection->bufferSerialize(vm, value);
 
     auto statusNode =
       BoostBasedVM::forVM(vm).createAsyncIOFeedbackNode(status);
 
-    connection->startAsyncWrite(statusNode);
+    connection->queueWrite(size, statusNode);
+  }
+
+  template <typename T, typename P>
+  static void baseSocketConnectionCork(
+    VM vm, BaseSocketConnection<T, P>* connection) {
+
+    connection->corkWrites();
+  }
+
+  template <typename T, typename P>
+  static void baseSocketConnectionFlush(
+    VM vm, BaseSocketConnection<T, P>* connection) {
+
+    connection->flushWrites();
   }
 
   template <typename T, typename P>
@@ -639,6 +711,8 @@ private:
 
     using socket = typename BaseSocketConnection<T, P>::protocol::socket;
 
+    connection->abortQueuedWrites();
+
     try {
       connection->socket().shutdown(socket::shutdown_both);
       connection->socket().close();
@@ -668,6 +742,35 @@ public:
     }
   };
 
+  class TCPConnectionWriteSerialized:
+    public Builtin<TCPConnectionWriteSerialized> {
+  public:
+    TCPConnectionWriteSerialized(): Builtin("tcpConnectionWriteSerialized") {}
+
+    static void call(VM vm, In connection, In value, Out status) {
+      baseSocketConnectionWriteSerialized(
+        vm, getTCPConnectionArg(vm, connection), value, status);
+    }
+  };
+
+  class TCPConnectionCork: public Builtin<TCPConnectionCork> {
+  public:
+    TCPConnectionCork(): Builtin("tcpConnectionCork") {}
+
+    static void call(VM vm, In connection) {
+      baseSocketConnectionCork(vm, getTCPConnectionArg(vm, connection));
+    }
+  };
+
+  class TCPConnectionFlush: public Builtin<TCPConnectionFlush> {
+  public:
+    TCPConnectionFlush(): Builtin("tcpConnectionFlush") {}
+
+    static void call(VM vm, In connection) {
+      baseSocketConnectionFlush(vm, getTCPConnectionArg(vm, connection));
+    }
+  };
+
   class TCPConnectionShutdown: public Builtin<TCPConnectionShutdown> {
   public:
     TCPConnectionShutdown(): Builtin("tcpConnectionShutdown") {}
@@ -687,6 +790,182 @@ public:
     }
   };
 
+  // Datagram sockets
+
+private:
+  static const size_t MaxDatagramBatch = 1024;
+  static const size_t MaxDatagramSize = 65536;
+
+  static UDPSocket* getUDPSocketArg(VM vm, In socket) {
+    return getPointerArgument<UDPSocket>(vm, socket, MOZART_STR("UDP socket"));
+  }
+
+  static void matchDatagram(VM vm, RichNode datagram, RichNode& data,
+                            RichNode& host, nativeint& port) {
+    using namespace patternmatching;
+
+    if (!matchesTuple(vm, datagram, MOZART_STR("datagram"),
+                      capture(data), capture(host), capture(port)))
+      raiseTypeError(vm, MOZART_STR("datagram(Data Host Port)"), datagram);
+  }
+
+public:
+  class UDPSocketCreate: public Builtin<UDPSocketCreate> {
+  public:
+    UDPSocketCreate(): Builtin("udpSocketCreate") {}
+
+    static void call(VM vm, In ipVersion, In port, Out result) {
+      using boost::asio::ip::udp;
+
+      auto intIPVersion = getArgument<nativeint>(vm, ipVersion,
+                                                 MOZART_STR("4 or 6"));
+      if ((intIPVersion != 4) && (intIPVersion != 6))
+        raiseTypeError(vm, MOZART_STR("4 or 6"), ipVersion);
+
+      // Port 0 lets the system pick a port, e.g., for a socket that only sends
+      auto intPort = getArgument<nativeint>(vm, port,
+                                            MOZART_STR("valid port number"));
+      if ((intPort < 0) ||
+          (intPort > std::numeric_limits<unsigned short>::max()))
+        raiseTypeError(vm, MOZART_STR("valid port number"), port);
+
+      udp::endpoint endpoint;
+      if (intIPVersion == 4)
+        endpoint = udp::endpoint(udp::v4(), intPort);
+      else
+        endpoint = udp::endpoint(udp::v6(), intPort);
+
+      try {
+        auto udpSocket = UDPSocket::create(BoostBasedVM::forVM(vm), endpoint);
+        result = build(vm, udpSocket);
+      } catch (const boost::system::system_error& error) {
+        raiseOSError(vm, MOZART_STR("udpSocketCreate"), error);
+      }
+    }
+  };
+
+  class UDPSocketReceive: public Builtin<UDPSocketReceive> {
+  public:
+    UDPSocketReceive(): Builtin("udpSocketReceive") {}
+
+    static void call(VM vm, In socket, In maxCount, In maxSize, Out status) {
+      auto udpSocket = getUDPSocketArg(vm, socket);
+
+      auto intMaxCount = getArgument<nativeint>(vm, maxCount);
+      if (intMaxCount <= 0)
+        raiseTypeError(vm, MOZART_STR("positive integer"), maxCount);
+
+      auto intMaxSize = getArgument<nativeint>(vm, maxSize);
+      if (intMaxSize <= 0)
+        raiseTypeError(vm, MOZART_STR("positive integer"), maxSize);
+
+      size_t count = (size_t) intMaxCount;
+      if (count > MaxDatagramBatch)
+        count = MaxDatagramBatch;
+
+      size_t size = (size_t) intMaxSize;
+      if (size > MaxDatagramSize)
+        size = MaxDatagramSize;
+
+      if (udpSocket->isReceiving())
+        raiseOSError(vm, MOZART_STR("receive"), EALREADY);
+
+      auto statusNode =
+        BoostBasedVM::forVM(vm).createAsyncIOFeedbackNode(status);
+
+      udpSocket->startAsyncReceive(count, size, statusNode);
+    }
+  };
+
+  class UDPSocketSend: public Builtin<UDPSocketSend> {
+  public:
+    UDPSocketSend(): Builtin("udpSocketSend") {}
+
+    static void call(VM vm, In socket, In datagrams, Out status) {
+      auto udpSocket = getUDPSocketArg(vm, socket);
+
+      // First pass: check the datagrams, which may wait or raise
+      size_t count = 0;
+      size_t totalSize = 0;
+
+      ozListForEach(vm, datagrams, [&] (RichNode datagram) {
+        RichNode data, host;
+        nativeint port;
+        matchDatagram(vm, datagram, data, host, port);
+
+        totalSize += ozVBSLengthForBuffer(vm, data);
+        size_t hostBufSize = ozVSLengthForBuffer(vm, host);
+
+        if ((port <= 0) || (port > std::numeric_limits<unsigned short>::max()))
+          raiseTypeError(vm, MOZART_STR("valid port number"), datagram);
+
+        bool validHost;
+        {
+          std::string strHost;
+          ozVSGet(vm, host, hostBufSize, strHost);
+
+          boost::system::error_code ec;
+          boost::asio::ip::address::from_string(strHost, ec);
+          validHost = !ec;
+        }
+
+        if (!validHost)
+          raiseTypeError(vm, MOZART_STR("IP address"), host);
+
+        count++;
+      }, MOZART_STR("list of datagrams"));
+
+      // 0 datagram
+      if (count == 0) {
+        status = build(vm, 0);
+        return;
+      }
+
+      // Second pass: build the batch, which cannot fail anymore
+      {
+        auto batch = std::make_shared<UDPSocket::SendBatch>();
+        batch->data.reserve(totalSize);
+        batch->datagrams.reserve(count);
+
+        ozListForEach(vm, datagrams, [&] (RichNode datagram) {
+          RichNode data, host;
+          nativeint port;
+          matchDatagram(vm, datagram, data, host, port);
+
+          size_t dataSize = ozVBSLengthForBuffer(vm, data);
+          ozVBSGet(vm, data, dataSize, batch->data);
+
+          std::string strHost;
+          ozVSGet(vm, host, ozVSLengthForBuffer(vm, host), strHost);
+
+          batch->datagrams.emplace_back(
+            UDPSocket::protocol::endpoint(
+              boost::asio::ip::address::from_string(strHost),
+              (unsigned short) port),
+            dataSize);
+        }, MOZART_STR("list of datagrams"));
+
+        auto statusNode =
+          BoostBasedVM::forVM(vm).createAsyncIOFeedbackNode(status);
+
+        udpSocket->startAsyncSend(std::move(batch), statusNode);
+      }
+    }
+  };
+
+  class UDPSocketClose: public Builtin<UDPSocketClose> {
+  public:
+    UDPSocketClose(): Builtin("udpSocketClose") {}
+
+    static void call(VM vm, In socket) {
+      auto udpSocket = getUDPSocketArg(vm, socket);
+
+      auto error = udpSocket->close();
+      if (error)
+        raiseOSError(vm, MOZART_STR("close"), error);
+    }
+  };
+
   // Process management
 
   static
@@ -1135,6 +1414,24 @@ public:
     }
   };
 
+  class PipeConnectionCork: public Builtin<PipeConnectionCork> {
+  public:
+    PipeConnectionCork(): Builtin("pipeConnectionCork") {}
+
+    static void call(VM vm, In connection) {
+      baseSocketConnectionCork(vm, getPipeConnectionArg(vm, connection));
+    }
+  };
+
+  class PipeConnectionFlush: public Builtin<PipeConnectionFlush> {
+  public:
+    PipeConnectionFlush(): Builtin("pipeConnectionFlush") {}
+
+    static void call(VM vm, In connection) {
+      baseSocketConnectionFlush(vm, getPipeConnectionArg(vm, connection));
+    }
+  };
+
   class PipeConnectionShutdown: public Builtin<PipeConnectionShutdown> {
   public:
     PipeConnectionShutdown(): Builtin("pipeConnectionShutdown") {}
@@ -1175,6 +1472,26 @@ public:
     }
   };
 
+  class PipeConnectionCork: public Builtin<PipeConnectionCork> {
+  public:
+    PipeConnectionCork(): Builtin("pipeConnectionCork") {}
+
+    static void call(VM vm, In connection) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Pipes on Windows"));
+    }
+  };
+
+  class PipeConnectionFlush: public Builtin<PipeConnectionFlush> {
+  public:
+    PipeConnectionFlush(): Builtin("pipeConnectionFlush") {}
+
+    static void call(VM vm, In connection) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Pipes on Windows"));
+    }
+  };
+
   class PipeConnectionShutdown: public Builtin<PipeConnectionShutdown> {
   public:
     PipeConnectionShutdown(): Builtin("pipeConnectionShutdown") {}
@@ -1195,6 +1512,400 @@ public:
     }
   };
 #endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+  // Unix domain sockets
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+private:
+  static UnixAcceptor* getUnixAcceptorArg(VM vm, In acceptor) {
+    return getPointerArgument<UnixAcceptor>(vm, acceptor,
+                                            MOZART_STR("Unix acceptor"));
+  }
+
+  static UnixConnection* getUnixConnectionArg(VM vm, In connection) {
+    return getPointerArgument<UnixConnection>(vm, connection,
+                                              MOZART_STR("Unix connection"));
+  }
+
+public:
+  class UnixAcceptorCreate: public Builtin<UnixAcceptorCreate> {
+  public:
+    UnixAcceptorCreate(): Builtin("unixAcceptorCreate") {}
+
+    static void call(VM vm, In path, Out result) {
+      size_t pathBufSize = ozVSLengthForBuffer(vm, path);
+
+      {
+        std::string strPath;
+        ozVSGet(vm, path, pathBufSize, strPath);
+
+        try {
+          auto acceptor = UnixAcceptor::create(
+            BoostBasedVM::forVM(vm),
+            boost::asio::local::stream_protocol::endpoint(strPath));
+          result = build(vm, acceptor);
+        } catch (const boost::system::system_error& error) {
+          raiseOSError(vm, MOZART_STR("unixAcceptorCreate"), error);
+        }
+      }
+    }
+  };
+
+  class UnixAccept: public Builtin<UnixAccept> {
+  public:
+    UnixAccept(): Builtin("unixAccept") {}
+
+    static void call(VM vm, In acceptor, Out result) {
+      auto unixAcceptor = getUnixAcceptorArg(vm, acceptor);
+
+      auto connectionNode =
+        BoostBasedVM::forVM(vm).createAsyncIOFeedbackNode(result);
+
+      unixAcceptor->startAsyncAccept(connectionNode);
+    }
+  };
+
+  class UnixCancelAccept: public Builtin<UnixCancelAccept> {
+  public:
+    UnixCancelAccept(): Builtin("unixCancelAccept") {}
+
+    static void call(VM vm, In acceptor) {
+      auto unixAcceptor = getUnixAcceptorArg(vm, acceptor);
+
+      auto error = unixAcceptor->cancel();
+      if (error)
+        raiseOSError(vm, MOZART_STR("cancel"), error);
+    }
+  };
+
+  class UnixAcceptorClose: public Builtin<UnixAcceptorClose> {
+  public:
+    UnixAcceptorClose(): Builtin("unixAcceptorClose") {}
+
+    static void call(VM vm, In acceptor) {
+      auto unixAcceptor = getUnixAcceptorArg(vm, acceptor);
+
+      auto error = unixAcceptor->close();
+      if (error)
+        raiseOSError(vm, MOZART_STR("close"), error);
+    }
+  };
+
+  class UnixConnect: public Builtin<UnixConnect> {
+  public:
+    UnixConnect(): Builtin("unixConnect") {}
+
+    static void call(VM vm, In path, Out status) {
+      size_t pathBufSize = ozVSLengthForBuffer(vm, path);
+
+      {
+        std::string strPath;
+        ozVSGet(vm, path, pathBufSize, strPath);
+
+        auto unixConnection = UnixConnection::create(BoostBasedVM::forVM(vm));
+
+        auto statusNode =
+          BoostBasedVM::forVM(vm).createAsyncIOFeedbackNode(status);
+
+        unixConnection->startAsyncConnect(strPath, statusNode);
+      }
+    }
+  };
+
+  class UnixSocketPair: public Builtin<UnixSocketPair> {
+  public:
+    UnixSocketPair(): Builtin("unixSocketPair") {}
+
+    static void call(VM vm, Out first, Out second) {
+      auto& environment = BoostBasedVM::forVM(vm);
+
+      auto firstConnection = UnixConnection::create(environment);
+      auto secondConnection = UnixConnection::create(environment);
+
+      // Build the Oz values now so that they are registered for GC
+      first = build(vm, firstConnection);
+      second = build(vm, secondConnection);
+
+      boost::system::error_code ec;
+      boost::asio::local::connect_pair(firstConnection->socket(),
+                                       secondConnection->socket(), ec);
+
+      if (ec)
+        raiseOSError(vm, MOZART_STR("socketpair"), ec);
+    }
+  };
+
+  class UnixConnectionRead: public Builtin<UnixConnectionRead> {
+  public:
+    UnixConnectionRead(): Builtin("unixConnectionRead") {}
+
+    static void call(VM vm, In connection, In count, In tail, Out status) {
+      baseSocketConnectionRead(vm, getUnixConnectionArg(vm, connection),
+                               count, tail, status);
+    }
+  };
+
+  class UnixConnectionWrite: public Builtin<UnixConnectionWrite> {
+  public:
+    UnixConnectionWrite(): Builtin("unixConnectionWrite") {}
+
+    static void call(VM vm, In connection, In data, Out status) {
+      baseSocketConnectionWrite(vm, getUnixConnectionArg(vm, connection),
+                                data, status);
+    }
+  };
+
+  class UnixConnectionWriteSerialized:
+    public Builtin<UnixConnectionWriteSerialized> {
+  public:
+    UnixConnectionWriteSerialized():
+      Builtin("unixConnectionWriteSerialized") {}
+
+    static void call(VM vm, In connection, In value, Out status) {
+      baseSocketConnectionWriteSerialized(
+        vm, getUnixConnectionArg(vm, connection), value, status);
+    }
+  };
+
+  class UnixConnectionCork: public Builtin<UnixConnectionCork> {
+  public:
+    UnixConnectionCork(): Builtin("unixConnectionCork") {}
+
+    static void call(VM vm, In connection) {
+      baseSocketConnectionCork(vm, getUnixConnectionArg(vm, connection));
+    }
+  };
+
+  class UnixConnectionFlush: public Builtin<UnixConnectionFlush> {
+  public:
+    UnixConnectionFlush(): Builtin("unixConnectionFlush") {}
+
+    static void call(VM vm, In connection) {
+      baseSocketConnectionFlush(vm, getUnixConnectionArg(vm, connection));
+    }
+  };
+
+  class UnixConnectionShutdown: public Builtin<UnixConnectionShutdown> {
+  public:
+    UnixConnectionShutdown(): Builtin("unixConnectionShutdown") {}
+
+    static void call(VM vm, In connection, In what) {
+      baseSocketConnectionShutdown(vm, getUnixConnectionArg(vm, connection),
+                                   what);
+    }
+  };
+
+  class UnixConnectionClose: public Builtin<UnixConnectionClose> {
+  public:
+    UnixConnectionClose(): Builtin("unixConnectionClose") {}
+
+    static void call(VM vm, In connection) {
+      baseSocketConnectionClose(vm, getUnixConnectionArg(vm, connection));
+    }
+  };
+
+  class UnixConnectionSendSocket: public Builtin<UnixConnectionSendSocket> {
+  public:
+    UnixConnectionSendSocket(): Builtin("unixConnectionSendSocket") {}
+
+    static void call(VM vm, In connection, In socket, Out status) {
+      using namespace patternmatching;
+
+      auto unixConnection = getUnixConnectionArg(vm, connection);
+
+      std::shared_ptr<TCPConnection> tcpSocket;
+      std::shared_ptr<UnixConnection> unixSocket;
+
+      int fd;
+      std::shared_ptr<void> keepAlive;
+
+      if (matches(vm, socket, capture(tcpSocket))) {
+        fd = tcpSocket->socket().native_handle();
+        keepAlive = std::move(tcpSocket);
+      } else if (matches(vm, socket, capture(unixSocket))) {
+        fd = unixSocket->socket().native_handle();
+        keepAlive = std::move(unixSocket);
+      } else {
+        raiseTypeError(vm, MOZART_STR("TCP or Unix connection"), socket);
+      }
+
+      auto statusNode =
+        BoostBasedVM::forVM(vm).createAsyncIOFeedbackNode(status);
+
+      unixConnection->startAsyncSendSocket(fd, std::move(keepAlive),
+                                           statusNode);
+    }
+  };
+
+  class UnixConnectionReceiveSocket:
+    public Builtin<UnixConnectionReceiveSocket> {
+  public:
+    UnixConnectionReceiveSocket(): Builtin("unixConnectionReceiveSocket") {}
+
+    static void call(VM vm, In connection, Out status) {
+      auto unixConnection = getUnixConnectionArg(vm, connection);
+
+      auto statusNode =
+        BoostBasedVM::forVM(vm).createAsyncIOFeedbackNode(status);
+
+      unixConnection->startAsyncReceiveSocket(statusNode);
+    }
+  };
+#else // BOOST_ASIO_HAS_LOCAL_SOCKETS
+public:
+  class UnixAcceptorCreate: public Builtin<UnixAcceptorCreate> {
+  public:
+    UnixAcceptorCreate(): Builtin("unixAcceptorCreate") {}
+
+    static void call(VM vm, In path, Out result) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixAccept: public Builtin<UnixAccept> {
+  public:
+    UnixAccept(): Builtin("unixAccept") {}
+
+    static void call(VM vm, In acceptor, Out result) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixCancelAccept: public Builtin<UnixCancelAccept> {
+  public:
+    UnixCancelAccept(): Builtin("unixCancelAccept") {}
+
+    static void call(VM vm, In acceptor) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixAcceptorClose: public Builtin<UnixAcceptorClose> {
+  public:
+    UnixAcceptorClose(): Builtin("unixAcceptorClose") {}
+
+    static void call(VM vm, In acceptor) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnect: public Builtin<UnixConnect> {
+  public:
+    UnixConnect(): Builtin("unixConnect") {}
+
+    static void call(VM vm, In path, Out status) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixSocketPair: public Builtin<UnixSocketPair> {
+  public:
+    UnixSocketPair(): Builtin("unixSocketPair") {}
+
+    static void call(VM vm, Out first, Out second) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionRead: public Builtin<UnixConnectionRead> {
+  public:
+    UnixConnectionRead(): Builtin("unixConnectionRead") {}
+
+    static void call(VM vm, In connection, In count, In tail, Out status) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionWrite: public Builtin<UnixConnectionWrite> {
+  public:
+    UnixConnectionWrite(): Builtin("unixConnectionWrite") {}
+
+    static void call(VM vm, In connection, In data, Out status) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionWriteSerialized:
+    public Builtin<UnixConnectionWriteSerialized> {
+  public:
+    UnixConnectionWriteSerialized():
+      Builtin("unixConnectionWriteSerialized") {}
+
+    static void call(VM vm, In connection, In value, Out status) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionCork: public Builtin<UnixConnectionCork> {
+  public:
+    UnixConnectionCork(): Builtin("unixConnectionCork") {}
+
+    static void call(VM vm, In connection) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionFlush: public Builtin<UnixConnectionFlush> {
+  public:
+    UnixConnectionFlush(): Builtin("unixConnectionFlush") {}
+
+    static void call(VM vm, In connection) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionShutdown: public Builtin<UnixConnectionShutdown> {
+  public:
+    UnixConnectionShutdown(): Builtin("unixConnectionShutdown") {}
+
+    static void call(VM vm, In connection, In what) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionClose: public Builtin<UnixConnectionClose> {
+  public:
+    UnixConnectionClose(): Builtin("unixConnectionClose") {}
+
+    static void call(VM vm, In connection) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionSendSocket: public Builtin<UnixConnectionSendSocket> {
+  public:
+    UnixConnectionSendSocket(): Builtin("unixConnectionSendSocket") {}
+
+    static void call(VM vm, In connection, In socket, Out status) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+
+  class UnixConnectionReceiveSocket:
+    public Builtin<UnixConnectionReceiveSocket> {
+  public:
+    UnixConnectionReceiveSocket(): Builtin("unixConnectionReceiveSocket") {}
+
+    static void call(VM vm, In connection, Out status) {
+      raiseError(vm, MOZART_STR("notImplemented"),
+                 MOZART_STR("Unix domain sockets on Windows"));
+    }
+  };
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
 };
 
 }
@@ -0,0 +1,105 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __MODSEARCHBOOST_H
+#define __MODSEARCHBOOST_H
+
+#include <mozart.hh>
+
+#include "boostenv-decl.hh"
+#include "boostenvsearch-decl.hh"
+
+#include <thread>
+
+#ifndef MOZART_GENERATOR
+
+namespace mozart { namespace boostenv {
+
+namespace builtins {
+
+using namespace ::mozart::builtins;
+
+///////////////////////////
+// ParallelSearch module //
+///////////////////////////
+
+class ModParallelSearch: public Module {
+public:
+  ModParallelSearch(): Module("ParallelSearch") {}
+
+  class Start: public Builtin<Start> {
+  public:
+    Start(): Builtin("start") {}
+
+    static void call(VM vm, In url, In kind, In workers,
+                     Out handle, Out solutions) {
+      using namespace patternmatching;
+
+      ParallelSearch::Kind searchKind;
+      if (matches(vm, kind, MOZART_STR("one")))
+        searchKind = ParallelSearch::psOne;
+      else if (matches(vm, kind, MOZART_STR("all")))
+        searchKind = ParallelSearch::psAll;
+      else if (matches(vm, kind, MOZART_STR("best")))
+        searchKind = ParallelSearch::psBest;
+      else
+        raiseTypeError(vm, MOZART_STR("one, all or best"), kind);
+
+      auto intWorkers = getArgument<nativeint>(vm, workers);
+      size_t workerCount = (intWorkers > 0) ? (size_t) intWorkers :
+        std::thread::hardware_concurrency();
+
+      size_t urlBufSize = ozVSLengthForBuffer(vm, url);
+
+      {
+        std::string strURL;
+        ozVSGet(vm, url, urlBufSize, strURL);
+
+        auto job = ParallelSearchJob::create(
+          BoostBasedVM::forVM(vm), strURL, searchKind, workerCount);
+
+        job->start(solutions);
+        handle = build(vm, job);
+      }
+    }
+  };
+
+  class Stop: public Builtin<Stop> {
+  public:
+    Stop(): Builtin("stop") {}
+
+    static void call(VM vm, In handle) {
+      getPointerArgument<ParallelSearchJob>(vm, handle)->stop();
+    }
+  };
+};
+
+}
+
+} }
+
+#endif // MOZART_GENERATOR
+
+#endif // __MODSEARCHBOOST_H
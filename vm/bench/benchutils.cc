@@ -0,0 +1,228 @@
+#include "benchutils.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <map>
+
+namespace {
+  class BenchEnvironment: public mozart::VirtualMachineEnvironment {
+  public:
+    BenchEnvironment(): VirtualMachineEnvironment(false), _nextUUID(1) {}
+
+    mozart::UUID genUUID() {
+      // Deterministic, so that runs are reproducible
+      return mozart::UUID(0x4000, _nextUUID++);
+    }
+  private:
+    std::uint64_t _nextUUID;
+  };
+}
+
+std::unique_ptr<mozart::VirtualMachineEnvironment> makeBenchEnvironment() {
+  return std::unique_ptr<BenchEnvironment>(new BenchEnvironment());
+}
+
+namespace mozart { namespace bench {
+
+volatile std::uint64_t benchSink = 0;
+
+std::vector<Benchmark>& registeredBenchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+namespace {
+  std::map<std::string, double> currentMetrics;
+}
+
+void reportMetric(const std::string& name, double value) {
+  currentMetrics[name] = value;
+}
+
+void collectIfRequired(VM vm) {
+  if (vm->getMemoryManager().isGCRequired()) {
+    vm->requestGC();
+    vm->run();
+  }
+}
+
+UnstableNode buildProcedure(VM vm, const std::vector<ByteCode>& code,
+                            size_t arity, size_t Xcount,
+                            const std::vector<RichNode>& gregs) {
+  std::vector<ByteCode> codeBlock = code;
+  UnstableNode debugData = build(vm, unit);
+  UnstableNode codeArea = CodeArea::build(
+    vm, 0, codeBlock.data(), codeBlock.size() * sizeof(ByteCode),
+    arity, Xcount, vm->getAtom(MOZART_STR("bench")), debugData);
+
+  UnstableNode result = Abstraction::build(vm, gregs.size(), codeArea);
+  auto elements = RichNode(result).as<Abstraction>().getElementsArray();
+  for (size_t i = 0; i < gregs.size(); i++)
+    elements[i].init(vm, gregs[i]);
+
+  return result;
+}
+
+} }
+
+using namespace mozart;
+using namespace mozart::bench;
+
+namespace {
+  typedef std::chrono::steady_clock Clock;
+
+  const double MinSeconds = 0.2;
+  const std::uint64_t MaxIterations = (std::uint64_t) 1 << 32;
+
+  struct Result {
+    std::string group;
+    std::string name;
+    std::uint64_t iterations;
+    std::uint64_t operations;
+    double seconds;
+    std::map<std::string, double> metrics;
+
+    double nsPerOp() const {
+      return (operations == 0) ? 0.0 : (seconds * 1e9) / operations;
+    }
+  };
+
+  /**
+   * Run a benchmark on a fresh VM, with a fixed number of iterations.
+   * Returns the elapsed time in seconds, and stores the number of operations.
+   */
+  double runOnce(const Benchmark& benchmark, std::uint64_t iterations,
+                 std::uint64_t& operations) {
+    auto environment = makeBenchEnvironment();
+    VirtualMachine virtualMachine(*environment);
+    VM vm = &virtualMachine;
+
+    currentMetrics.clear();
+
+    auto start = Clock::now();
+    operations = benchmark.body(vm, iterations);
+    auto stop = Clock::now();
+
+    return std::chrono::duration<double>(stop - start).count();
+  }
+
+  Result runBenchmark(const Benchmark& benchmark) {
+    Result result;
+    result.group = benchmark.group;
+    result.name = benchmark.name;
+
+    // Grow the number of iterations until the run is long enough
+    std::uint64_t iterations = 1;
+    std::uint64_t operations = 0;
+    double seconds = runOnce(benchmark, iterations, operations);
+    while ((seconds < MinSeconds) && (iterations < MaxIterations)) {
+      iterations *= (seconds < MinSeconds / 100) ? 10 : 2;
+      seconds = runOnce(benchmark, iterations, operations);
+    }
+
+    result.iterations = iterations;
+    result.operations = operations;
+    result.seconds = seconds;
+    result.metrics = currentMetrics;
+
+    // Throughput, for benchmarks that report how many bytes an op processes
+    auto bytesPerOp = result.metrics.find("bytes_per_op");
+    if ((bytesPerOp != result.metrics.end()) && (seconds > 0)) {
+      result.metrics["mb_per_s"] =
+        bytesPerOp->second * operations / seconds / 1e6;
+    }
+
+    return result;
+  }
+
+  void printText(std::ostream& out, const Result& result) {
+    std::string fullName = result.group + "." + result.name;
+
+    out << std::left << std::setw(40) << fullName << std::right
+        << std::setw(12) << result.operations << " ops "
+        << std::fixed << std::setprecision(2)
+        << std::setw(12) << result.nsPerOp() << " ns/op";
+
+    for (auto& metric : result.metrics)
+      out << "  " << metric.first << "=" << metric.second;
+
+    out << std::endl;
+  }
+
+  void printJSONString(std::ostream& out, const std::string& str) {
+    out << '"';
+    for (char c : str) {
+      if ((c == '"') || (c == '\\'))
+        out << '\\' << c;
+      else
+        out << c;
+    }
+    out << '"';
+  }
+
+  void printJSON(std::ostream& out, const Result& result, bool first) {
+    out << (first ? "\n" : ",\n") << "    {";
+    out << "\"group\": ";
+    printJSONString(out, result.group);
+    out << ", \"name\": ";
+    printJSONString(out, result.name);
+    out << ", \"iterations\": " << result.iterations;
+    out << ", \"operations\": " << result.operations;
+    out << std::setprecision(9);
+    out << ", \"seconds\": " << result.seconds;
+    out << ", \"ns_per_op\": " << result.nsPerOp();
+    out << ", \"metrics\": {";
+    for (auto iter = result.metrics.begin();
+         iter != result.metrics.end(); ++iter) {
+      if (iter != result.metrics.begin())
+        out << ", ";
+      printJSONString(out, iter->first);
+      out << ": " << iter->second;
+    }
+    out << "}}";
+  }
+}
+
+/**
+ * Usage: vmbench [--json] [filter]
+ * Only the benchmarks whose full name (group.name) contains the filter are
+ * run. With --json, the results are output as a JSON document on stdout.
+ */
+int main(int argc, char** argv) {
+  bool json = false;
+  const char* filter = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--json") == 0)
+      json = true;
+    else
+      filter = argv[i];
+  }
+
+  if (json)
+    std::cout << "{\n  \"benchmarks\": [";
+
+  bool first = true;
+  for (auto& benchmark : registeredBenchmarks()) {
+    std::string fullName = benchmark.group + "." + benchmark.name;
+    if ((filter != nullptr) && (fullName.find(filter) == std::string::npos))
+      continue;
+
+    Result result = runBenchmark(benchmark);
+
+    if (json)
+      printJSON(std::cout, result, first);
+    else
+      printText(std::cout, result);
+
+    first = false;
+  }
+
+  if (json)
+    std::cout << "\n  ]\n}" << std::endl;
+
+  return 0;
+}
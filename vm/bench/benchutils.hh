@@ -0,0 +1,93 @@
+#ifndef __BENCHUTILS_HH
+#define __BENCHUTILS_HH
+
+#include "mozart.hh"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+std::unique_ptr<mozart::VirtualMachineEnvironment> makeBenchEnvironment();
+
+namespace mozart { namespace bench {
+
+/**
+ * A micro-benchmark. The body receives a fresh VM and the number of
+ * iterations it must perform, and returns the number of operations it
+ * actually did (usually equal to the number of iterations).
+ */
+struct Benchmark {
+  typedef std::function<std::uint64_t(VM vm, std::uint64_t iterations)> Body;
+
+  Benchmark(const char* group, const char* name, const Body& body):
+    group(group), name(name), body(body) {}
+
+  std::string group;
+  std::string name;
+  Body body;
+};
+
+std::vector<Benchmark>& registeredBenchmarks();
+
+struct BenchmarkRegistrar {
+  BenchmarkRegistrar(const char* group, const char* name,
+                     const Benchmark::Body& body) {
+    registeredBenchmarks().emplace_back(group, name, body);
+  }
+};
+
+/**
+ * Sink for values computed by benchmarks, so that the compiler cannot
+ * optimize away the work being measured.
+ */
+extern volatile std::uint64_t benchSink;
+
+inline
+void doNotOptimize(std::uint64_t value) {
+  benchSink += value;
+}
+
+/**
+ * Report an additional metric of the current run, e.g., a GC pause time.
+ * Only the metrics of the last (timed) run of a benchmark are output.
+ * Reporting "bytes_per_op" also outputs the throughput as "mb_per_s".
+ */
+void reportMetric(const std::string& name, double value);
+
+/**
+ * Run the GC if the heap is about to be exhausted. Benchmarks that allocate
+ * in their loop must call this regularly. Since nodes on the C++ stack are
+ * not roots, everything that must survive has to be protected.
+ */
+void collectIfRequired(VM vm);
+
+/**
+ * Build a procedure out of raw byte code, with the given G registers.
+ */
+UnstableNode buildProcedure(VM vm, const std::vector<ByteCode>& code,
+                            size_t arity, size_t Xcount,
+                            const std::vector<RichNode>& gregs = {});
+
+} }
+
+/**
+ * Define a benchmark, used like
+ *
+ *     BENCHMARK(Unify, SmallInts) {
+ *       for (std::uint64_t i = 0; i < iterations; i++)
+ *         ...;
+ *       return iterations;
+ *     }
+ *
+ * Inside the body, `vm` and `iterations` are in scope.
+ */
+#define BENCHMARK(group, name) \
+  static std::uint64_t group##_##name##_body( \
+    ::mozart::VM vm, std::uint64_t iterations); \
+  static ::mozart::bench::BenchmarkRegistrar group##_##name##_registrar( \
+    #group, #name, &group##_##name##_body); \
+  static std::uint64_t group##_##name##_body( \
+    ::mozart::VM vm, std::uint64_t iterations)
+
+#endif // __BENCHUTILS_HH
@@ -0,0 +1,72 @@
+#include "mozart.hh"
+#include "benchutils.hh"
+
+using namespace mozart;
+using namespace mozart::bench;
+
+// Opcode dispatch
+// proc {Loop N} if N == 0 then skip else {Loop N-1} end end, where the
+// tail call is a backward branch. Every iteration executes 3 opcodes, which
+// are reported as the operations.
+
+BENCHMARK(Emulate, Dispatch) {
+  auto loop = vm->protect(buildProcedure(vm, {
+    OpInlineEqualsInteger, 0, 0, 1,  // 0: if X0 == 0
+    OpReturn,                        // 4:   return
+    OpInlineMinus1, 0, 0,            // 5: X0 := X0 - 1
+    OpBranchBackward, 10             // 8: goto 0
+  }, 1, 1));
+
+  ozcalls::asyncOzCall(vm, *loop, (nativeint) iterations);
+  vm->run();
+
+  return 3 * iterations;
+}
+
+// Calls and returns
+// Same loop, but every iteration also calls an empty procedure. The counter
+// is saved in a Y register across the call.
+
+BENCHMARK(Emulate, CallReturn) {
+  auto empty = vm->protect(buildProcedure(vm, {
+    OpReturn
+  }, 0, 1));
+
+  auto loop = vm->protect(buildProcedure(vm, {
+    OpAllocateY, 1,                  //  0: allocate Y0
+    OpMoveXY, 0, 0,                  //  2: Y0 := X0
+    OpMoveYX, 0, 0,                  //  5: X0 := Y0
+    OpInlineEqualsInteger, 0, 0, 1,  //  8: if X0 == 0
+    OpReturn,                        // 12:   return
+    OpInlineMinus1, 0, 0,            // 13: X0 := X0 - 1
+    OpMoveXY, 0, 0,                  // 16: Y0 := X0
+    OpCallG, 0, 0,                   // 19: {G0}
+    OpBranchBackward, 19             // 22: goto 5
+  }, 1, 1, { *empty }));
+
+  ozcalls::asyncOzCall(vm, *loop, (nativeint) iterations);
+  vm->run();
+
+  return iterations;
+}
+
+// Thread creation, scheduling and termination
+
+BENCHMARK(Threads, Spawn) {
+  const std::uint64_t batchSize = 1000;
+
+  auto empty = vm->protect(buildProcedure(vm, {
+    OpReturn
+  }, 0, 1));
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    ozcalls::asyncOzCall(vm, *empty);
+
+    if (i % batchSize == batchSize - 1)
+      vm->run();
+  }
+
+  vm->run();
+
+  return iterations;
+}
@@ -0,0 +1,62 @@
+#include "mozart.hh"
+#include "benchutils.hh"
+
+using namespace mozart;
+using namespace mozart::bench;
+
+namespace {
+  void reportGCMetrics(VM vm) {
+    auto& stats = vm->getGarbageCollector().getStatistics();
+
+    if (stats.collections == 0)
+      return;
+
+    reportMetric("collections", stats.collections);
+    reportMetric("pause_max_us", stats.maxPause);
+    reportMetric("pause_mean_us",
+                 (double) stats.totalPause / stats.collections);
+    reportMetric("live_bytes", stats.lastBytesAfter);
+
+    if (stats.totalPause > 0) {
+      // Bytes per microsecond happen to be megabytes per second
+      reportMetric("copy_mb_per_s",
+                   (double) stats.totalBytesCopied / stats.totalPause);
+    }
+  }
+
+  UnstableNode buildIntList(VM vm, nativeint length) {
+    UnstableNode result = build(vm, vm->coreatoms.nil);
+    for (nativeint i = length; i > 0; i--)
+      result = buildCons(vm, i, std::move(result));
+    return result;
+  }
+}
+
+// Collection of a live heap
+// Every iteration is a full collection of a protected list of 100k elements.
+
+BENCHMARK(GC, LiveList) {
+  auto list = vm->protect(buildIntList(vm, 100000));
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    vm->requestGC();
+    vm->run();
+  }
+
+  reportGCMetrics(vm);
+  return iterations;
+}
+
+// Allocation churn
+// Short-lived lists of 100 elements, so that nearly everything is garbage
+// by the time the GC kicks in.
+
+BENCHMARK(GC, Garbage) {
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    doNotOptimize(RichNode(buildIntList(vm, 100)).is<Cons>());
+    collectIfRequired(vm);
+  }
+
+  reportGCMetrics(vm);
+  return iterations * 100;
+}
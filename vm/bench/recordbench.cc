@@ -0,0 +1,138 @@
+#include "mozart.hh"
+#include "benchutils.hh"
+
+#include <cstdio>
+
+using namespace mozart;
+using namespace mozart::bench;
+
+// Feature lookup in records
+
+namespace {
+  UnstableNode buildWideRecord(VM vm) {
+    return buildRecord(
+      vm, buildArity(vm, MOZART_STR("r"),
+                     MOZART_STR("a"), MOZART_STR("b"), MOZART_STR("c"),
+                     MOZART_STR("d"), MOZART_STR("e"), MOZART_STR("f"),
+                     MOZART_STR("g"), MOZART_STR("h")),
+      1, 2, 3, 4, 5, 6, 7, 8);
+  }
+}
+
+BENCHMARK(Records, FeatureLookup) {
+  UnstableNode record = buildWideRecord(vm);
+  UnstableNode feature = build(vm, MOZART_STR("f"));
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode value;
+    doNotOptimize(Dottable(record).lookupFeature(vm, feature, value));
+  }
+
+  return iterations;
+}
+
+BENCHMARK(Records, FeatureLookupMiss) {
+  UnstableNode record = buildWideRecord(vm);
+  UnstableNode feature = build(vm, MOZART_STR("z"));
+
+  for (std::uint64_t i = 0; i < iterations; i++)
+    doNotOptimize(Dottable(record).hasFeature(vm, feature));
+
+  return iterations;
+}
+
+BENCHMARK(Records, TupleLookup) {
+  UnstableNode tuple = buildTuple(vm, MOZART_STR("t"), 1, 2, 3, 4, 5, 6, 7, 8);
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode value;
+    doNotOptimize(Dottable(tuple).lookupFeature(vm, 6, value));
+  }
+
+  return iterations;
+}
+
+// Dictionaries
+
+namespace {
+  const nativeint DictionarySize = 1024;
+
+  ProtectedNode buildFilledDictionary(VM vm) {
+    auto dict = vm->protect(Dictionary::build(vm));
+
+    for (nativeint i = 0; i < DictionarySize; i++) {
+      UnstableNode key = build(vm, i);
+      UnstableNode value = build(vm, i);
+      DictionaryLike(*dict).dictPut(vm, key, value);
+    }
+
+    return dict;
+  }
+}
+
+BENCHMARK(Dictionary, Put) {
+  auto dict = buildFilledDictionary(vm);
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode key = build(vm, (nativeint) (i % DictionarySize));
+    UnstableNode value = build(vm, (nativeint) i);
+    DictionaryLike(*dict).dictPut(vm, key, value);
+  }
+
+  return iterations;
+}
+
+BENCHMARK(Dictionary, Get) {
+  auto dict = buildFilledDictionary(vm);
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode key = build(vm, (nativeint) (i % DictionarySize));
+    UnstableNode value = DictionaryLike(*dict).dictGet(vm, key);
+    doNotOptimize(RichNode(value).as<SmallInt>().value());
+  }
+
+  return iterations;
+}
+
+BENCHMARK(Dictionary, AtomKeys) {
+  auto dict = vm->protect(Dictionary::build(vm));
+  UnstableNode keys[] = {
+    build(vm, MOZART_STR("alpha")), build(vm, MOZART_STR("beta")),
+    build(vm, MOZART_STR("gamma")), build(vm, MOZART_STR("delta"))
+  };
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode value = build(vm, (nativeint) i);
+    DictionaryLike(*dict).dictPut(vm, keys[i % 4], value);
+  }
+
+  return iterations;
+}
+
+// Atom interning
+
+BENCHMARK(Atoms, InternExisting) {
+  vm->getAtom(MOZART_STR("someAtomThatIsInterned"));
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    atom_t atom = vm->getAtom(MOZART_STR("someAtomThatIsInterned"));
+    doNotOptimize(atom.length());
+  }
+
+  return iterations;
+}
+
+BENCHMARK(Atoms, InternNew) {
+  // Includes the formatting of the atom names
+  nchar buffer[32];
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    int length = std::snprintf(buffer, sizeof(buffer), "atom%llu",
+                               (unsigned long long) i);
+    atom_t atom = vm->getAtom(length, buffer);
+    doNotOptimize(atom.length());
+    collectIfRequired(vm);
+  }
+
+  return iterations;
+}
@@ -0,0 +1,99 @@
+#include "mozart.hh"
+#include "benchutils.hh"
+
+#include <sstream>
+
+using namespace mozart;
+using namespace mozart::bench;
+
+namespace {
+  const nativeint ListLength = 1000;
+}
+
+// Serialization of a list of integers
+
+BENCHMARK(Serializer, List) {
+  UnstableNode listNode = build(vm, vm->coreatoms.nil);
+  for (nativeint i = ListLength; i > 0; i--)
+    listNode = buildCons(vm, i, std::move(listNode));
+  auto list = vm->protect(std::move(listNode));
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode serializer = Serializer::build(vm);
+    UnstableNode todo = buildList(
+      vm, buildSharp(vm, *list, OptVar::build(vm)));
+    UnstableNode result =
+      RichNode(serializer).as<Serializer>().doSerialize(vm, todo);
+    doNotOptimize(RichNode(result).is<Cons>());
+    collectIfRequired(vm);
+  }
+
+  return iterations * ListLength;
+}
+
+// Boot unpickling of a list of integers
+
+namespace {
+  void writeSize(std::ostream& output, size_t size) {
+    output.put((char) (size >> 24));
+    output.put((char) (size >> 16));
+    output.put((char) (size >> 8));
+    output.put((char) size);
+  }
+
+  void writeString(std::ostream& output, const std::string& str) {
+    writeSize(output, str.size());
+    output << str;
+  }
+
+  /**
+   * Pickle of the list [1 2 ... length], laid out as:
+   *   1..length        the integers
+   *   length+1         nil
+   *   length+2..       the cons cells, the first one being the result
+   */
+  std::string makeListPickle(size_t length) {
+    std::ostringstream output;
+
+    size_t nilIndex = length + 1;
+    size_t firstCons = length + 2;
+
+    writeSize(output, 2*length + 1);
+    writeSize(output, firstCons);
+
+    for (size_t i = 1; i <= length; i++) {
+      writeSize(output, i);
+      output.put(1);
+      writeString(output, std::to_string(i));
+    }
+
+    writeSize(output, nilIndex);
+    output.put(5);
+    writeString(output, "nil");
+
+    for (size_t i = 0; i < length; i++) {
+      writeSize(output, firstCons + i);
+      output.put(6);
+      writeSize(output, i + 1);
+      writeSize(output, (i + 1 == length) ? nilIndex : firstCons + i + 1);
+    }
+
+    writeSize(output, 0);
+
+    return output.str();
+  }
+}
+
+BENCHMARK(Unpickle, List) {
+  std::string pickle = makeListPickle(ListLength);
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    std::istringstream input(pickle);
+    UnstableNode result = bootUnpickle(vm, input);
+    doNotOptimize(RichNode(result).is<Cons>());
+    collectIfRequired(vm);
+  }
+
+  reportMetric("pickle_bytes", pickle.size());
+  return iterations * ListLength;
+}
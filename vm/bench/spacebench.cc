@@ -0,0 +1,36 @@
+#include "mozart.hh"
+#include "benchutils.hh"
+
+using namespace mozart;
+using namespace mozart::bench;
+
+// Cloning of a stable space
+// The space binds its root variable to a list of 1000 elements, which is
+// copied by every clone.
+
+BENCHMARK(Space, Clone) {
+  const nativeint listLength = 1000;
+
+  UnstableNode list = build(vm, vm->coreatoms.nil);
+  for (nativeint i = listLength; i > 0; i--)
+    list = buildCons(vm, i, std::move(list));
+
+  // proc {$ Root} Root = G0 end
+  UnstableNode body = buildProcedure(vm, {
+    OpUnifyXG, 0, 0,
+    OpReturn
+  }, 1, 1, { list });
+
+  Space* space = new (vm) Space(vm, vm->getCurrentSpace());
+  ozcalls::asyncOzCall(vm, space, body, *space->getRootVar());
+  auto reified = vm->protect(ReifiedSpace::build(vm, space));
+  vm->run();
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode clone = SpaceLike(*reified).cloneSpace(vm);
+    doNotOptimize(RichNode(clone).is<ReifiedSpace>());
+    collectIfRequired(vm);
+  }
+
+  return iterations;
+}
@@ -0,0 +1,137 @@
+#include "mozart.hh"
+#include "benchutils.hh"
+
+#include <cstring>
+
+using namespace mozart;
+using namespace mozart::bench;
+
+// Transcoding
+
+namespace {
+  const size_t BufferSize = 64 * 1024;
+
+  std::vector<nchar> makeASCIIText() {
+    std::vector<nchar> result(BufferSize);
+    for (size_t i = 0; i < BufferSize; i++)
+      result[i] = (nchar) ('a' + i % 26);
+    return result;
+  }
+
+  /** Mostly ASCII, with a 2-byte and a 3-byte sequence every 32 bytes */
+  std::vector<nchar> makeMixedText() {
+    const char* chunk = "abcdefghijklmnopqrstuvwxyz\xC3\xA9\xE2\x82\xAC!";
+    size_t chunkSize = std::strlen(chunk);
+
+    std::vector<nchar> result;
+    result.reserve(BufferSize);
+    while (result.size() + chunkSize <= BufferSize)
+      result.insert(result.end(), chunk, chunk + chunkSize);
+    return result;
+  }
+
+  template <typename Encoder>
+  std::uint64_t benchEncode(const std::vector<nchar>& text,
+                            std::uint64_t iterations, Encoder encoder) {
+    auto input = makeLString(text.data(), text.size());
+
+    for (std::uint64_t i = 0; i < iterations; i++) {
+      auto output = encoder(input, EncodingVariant::none);
+      doNotOptimize(output.length);
+    }
+
+    reportMetric("bytes_per_op", text.size());
+    return iterations;
+  }
+
+  template <typename Encoder, typename Decoder>
+  std::uint64_t benchDecode(const std::vector<nchar>& text,
+                            std::uint64_t iterations,
+                            Encoder encoder, Decoder decoder) {
+    auto encoded = encoder(makeLString(text.data(), text.size()),
+                           EncodingVariant::none);
+    auto input = makeLString(encoded.string, encoded.length);
+
+    for (std::uint64_t i = 0; i < iterations; i++) {
+      auto output = decoder(input, EncodingVariant::none);
+      doNotOptimize(output.length);
+    }
+
+    reportMetric("bytes_per_op", encoded.length);
+    return iterations;
+  }
+}
+
+BENCHMARK(Coders, EncodeUTF8ASCII) {
+  return benchEncode(makeASCIIText(), iterations, encodeUTF8);
+}
+
+BENCHMARK(Coders, EncodeUTF8Mixed) {
+  return benchEncode(makeMixedText(), iterations, encodeUTF8);
+}
+
+BENCHMARK(Coders, DecodeUTF8ASCII) {
+  return benchDecode(makeASCIIText(), iterations, encodeUTF8, decodeUTF8);
+}
+
+BENCHMARK(Coders, DecodeUTF8Mixed) {
+  return benchDecode(makeMixedText(), iterations, encodeUTF8, decodeUTF8);
+}
+
+BENCHMARK(Coders, EncodeLatin1Mixed) {
+  return benchEncode(makeMixedText(), iterations, encodeLatin1);
+}
+
+BENCHMARK(Coders, DecodeLatin1Mixed) {
+  return benchDecode(makeMixedText(), iterations, encodeLatin1, decodeLatin1);
+}
+
+BENCHMARK(Coders, EncodeUTF16ASCII) {
+  return benchEncode(makeASCIIText(), iterations, encodeUTF16);
+}
+
+BENCHMARK(Coders, DecodeUTF16ASCII) {
+  return benchDecode(makeASCIIText(), iterations, encodeUTF16, decodeUTF16);
+}
+
+BENCHMARK(Coders, EncodeUTF16Mixed) {
+  return benchEncode(makeMixedText(), iterations, encodeUTF16);
+}
+
+BENCHMARK(Coders, DecodeUTF16Mixed) {
+  return benchDecode(makeMixedText(), iterations, encodeUTF16, decodeUTF16);
+}
+
+BENCHMARK(Coders, EncodeUTF32Mixed) {
+  return benchEncode(makeMixedText(), iterations, encodeUTF32);
+}
+
+BENCHMARK(Coders, DecodeUTF32Mixed) {
+  return benchDecode(makeMixedText(), iterations, encodeUTF32, decodeUTF32);
+}
+
+// Virtual strings
+
+BENCHMARK(VirtualString, Flatten) {
+  const size_t partCount = 100;
+
+  auto vs = vm->protect(makeTuple(vm, vm->coreatoms.sharp, partCount));
+  auto elements = RichNode(*vs).as<Tuple>().getElementsArray();
+  for (size_t i = 0; i < partCount; i++) {
+    switch (i % 3) {
+      case 0: elements[i].init(vm, build(vm, MOZART_STR("atom"))); break;
+      case 1: elements[i].init(vm, build(vm, (nativeint) i)); break;
+      default: elements[i].init(vm, String::build(vm, MOZART_STR("string")));
+    }
+  }
+
+  std::vector<nchar> buffer;
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    size_t bufSize = ozVSLengthForBuffer(vm, *vs);
+    ozVSGet(vm, *vs, bufSize, buffer);
+    doNotOptimize(buffer.size());
+    buffer.clear();
+  }
+
+  return iterations * partCount;
+}
@@ -0,0 +1,141 @@
+#include "mozart.hh"
+#include "benchutils.hh"
+
+using namespace mozart;
+using namespace mozart::bench;
+
+// Atomic values
+
+BENCHMARK(Equals, SmallInts) {
+  UnstableNode left = build(vm, 42);
+  UnstableNode right = build(vm, 42);
+
+  for (std::uint64_t i = 0; i < iterations; i++)
+    doNotOptimize(equals(vm, left, right));
+
+  return iterations;
+}
+
+BENCHMARK(Equals, DifferentSmallInts) {
+  UnstableNode left = build(vm, 42);
+  UnstableNode right = build(vm, 54);
+
+  for (std::uint64_t i = 0; i < iterations; i++)
+    doNotOptimize(equals(vm, left, right));
+
+  return iterations;
+}
+
+BENCHMARK(Equals, Atoms) {
+  UnstableNode left = build(vm, MOZART_STR("hello"));
+  UnstableNode right = build(vm, MOZART_STR("hello"));
+
+  for (std::uint64_t i = 0; i < iterations; i++)
+    doNotOptimize(equals(vm, left, right));
+
+  return iterations;
+}
+
+BENCHMARK(Equals, Names) {
+  UnstableNode left = OptName::build(vm);
+  UnstableNode right = OptName::build(vm);
+
+  for (std::uint64_t i = 0; i < iterations; i++)
+    doNotOptimize(equals(vm, left, right));
+
+  return iterations;
+}
+
+BENCHMARK(Unify, SmallInts) {
+  UnstableNode left = build(vm, 42);
+  UnstableNode right = build(vm, 42);
+
+  for (std::uint64_t i = 0; i < iterations; i++)
+    unify(vm, left, right);
+
+  return iterations;
+}
+
+BENCHMARK(Unify, Atoms) {
+  UnstableNode left = build(vm, MOZART_STR("hello"));
+  UnstableNode right = build(vm, MOZART_STR("hello"));
+
+  for (std::uint64_t i = 0; i < iterations; i++)
+    unify(vm, left, right);
+
+  return iterations;
+}
+
+BENCHMARK(Unify, BindVariable) {
+  UnstableNode value = build(vm, 42);
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode variable = OptVar::build(vm);
+    unify(vm, variable, value);
+  }
+
+  return iterations;
+}
+
+BENCHMARK(PatternMatch, Atoms) {
+  UnstableNode value = build(vm, MOZART_STR("hello"));
+  UnstableNode pattern = build(vm, MOZART_STR("hello"));
+
+  for (std::uint64_t i = 0; i < iterations; i++)
+    doNotOptimize(patternMatch(vm, value, pattern, nullptr));
+
+  return iterations;
+}
+
+// Small records
+// Successful structural equality rebinds the left-hand side to the
+// right-hand side, hence we need fresh records for every iteration. The
+// Records.Build benchmark measures that baseline. The arity is protected
+// because these loops allocate enough to trigger GCs.
+
+namespace {
+  UnstableNode buildSmallRecord(VM vm, RichNode arity) {
+    return buildRecord(vm, arity, 1, MOZART_STR("two"), 3.0);
+  }
+}
+
+BENCHMARK(Records, Build) {
+  auto arity = vm->protect(buildArity(vm, MOZART_STR("f"), MOZART_STR("a"),
+                                      MOZART_STR("b"), MOZART_STR("c")));
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode left = buildSmallRecord(vm, *arity);
+    UnstableNode right = buildSmallRecord(vm, *arity);
+    collectIfRequired(vm);
+  }
+
+  return iterations;
+}
+
+BENCHMARK(Equals, SmallRecords) {
+  auto arity = vm->protect(buildArity(vm, MOZART_STR("f"), MOZART_STR("a"),
+                                      MOZART_STR("b"), MOZART_STR("c")));
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode left = buildSmallRecord(vm, *arity);
+    UnstableNode right = buildSmallRecord(vm, *arity);
+    doNotOptimize(equals(vm, left, right));
+    collectIfRequired(vm);
+  }
+
+  return iterations;
+}
+
+BENCHMARK(Unify, SmallRecords) {
+  auto arity = vm->protect(buildArity(vm, MOZART_STR("f"), MOZART_STR("a"),
+                                      MOZART_STR("b"), MOZART_STR("c")));
+
+  for (std::uint64_t i = 0; i < iterations; i++) {
+    UnstableNode left = buildSmallRecord(vm, *arity);
+    UnstableNode right = buildSmallRecord(vm, *arity);
+    unify(vm, left, right);
+    collectIfRequired(vm);
+  }
+
+  return iterations;
+}
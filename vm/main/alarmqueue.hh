@@ -0,0 +1,184 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __ALARMQUEUE_H
+#define __ALARMQUEUE_H
+
+#include "core-forward-decl.hh"
+#include "slottable.hh"
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+namespace mozart {
+
+/**
+ * Handle to a pending alarm, used to cancel it.
+ * The default handle refers to no alarm.
+ */
+typedef SlotHandle AlarmHandle;
+
+/**
+ * The pending alarms of a VM, in a binary min-heap ordered by expiration
+ * time. Alarms that expire at the same time fire in the order they were set.
+ *
+ * Every alarm has a slot that tracks its position in the heap, so that it can
+ * be cancelled in O(log n). The slot is released when the alarm fires or is
+ * cancelled, which invalidates its handle.
+ *
+ * The heap lives outside of the VM memory, hence the GC only needs to update
+ * the wakeables, without touching the order.
+ */
+class AlarmQueue {
+private:
+  struct Alarm {
+    std::int64_t expiration;
+    std::uint64_t sequence;
+    StableNode* wakeable;
+    AlarmHandle slot;
+  };
+public:
+  AlarmQueue(): _nextSequence(0) {}
+
+  // Make this class non-copyable
+  AlarmQueue(const AlarmQueue& from) = delete;
+  AlarmQueue& operator=(const AlarmQueue& from) = delete;
+
+  bool empty() {
+    return _heap.empty();
+  }
+
+  size_t size() {
+    return _heap.size();
+  }
+
+  /** Expiration time of the earliest alarm; the queue must not be empty */
+  std::int64_t nextExpiration() {
+    assert(!empty());
+    return _heap.front().expiration;
+  }
+
+  AlarmHandle insert(std::int64_t expiration, StableNode* wakeable) {
+    AlarmHandle slot = _positions.acquire(_heap.size());
+
+    _heap.push_back(Alarm { expiration, _nextSequence++, wakeable, slot });
+    siftUp(_heap.size() - 1);
+
+    return slot;
+  }
+
+  /**
+   * Cancel a pending alarm.
+   * Returns false if it had already fired or been cancelled.
+   */
+  bool cancel(AlarmHandle handle) {
+    if (!_positions.isValid(handle))
+      return false;
+
+    removeAt(_positions.get(handle));
+    return true;
+  }
+
+  /** Remove the earliest alarm, and return its wakeable */
+  StableNode* popFront() {
+    assert(!empty());
+    StableNode* result = _heap.front().wakeable;
+    removeAt(0);
+    return result;
+  }
+
+  /** Apply f to the StableNode*& of every wakeable, e.g., to GC them */
+  template <typename F>
+  void forEachWakeable(const F& f) {
+    for (auto& alarm: _heap)
+      f(alarm.wakeable);
+  }
+private:
+  static bool before(const Alarm& lhs, const Alarm& rhs) {
+    return (lhs.expiration < rhs.expiration) ||
+      ((lhs.expiration == rhs.expiration) && (lhs.sequence < rhs.sequence));
+  }
+
+  void place(size_t position, const Alarm& alarm) {
+    _heap[position] = alarm;
+    _positions.get(alarm.slot) = position;
+  }
+
+  void siftUp(size_t position) {
+    Alarm alarm = _heap[position];
+    while (position > 0) {
+      size_t parent = (position - 1) / 2;
+      if (!before(alarm, _heap[parent]))
+        break;
+      place(position, _heap[parent]);
+      position = parent;
+    }
+    place(position, alarm);
+  }
+
+  void siftDown(size_t position) {
+    Alarm alarm = _heap[position];
+    size_t count = _heap.size();
+    while (true) {
+      size_t child = 2 * position + 1;
+      if (child >= count)
+        break;
+      if ((child + 1 < count) && before(_heap[child + 1], _heap[child]))
+        child++;
+      if (!before(_heap[child], alarm))
+        break;
+      place(position, _heap[child]);
+      position = child;
+    }
+    place(position, alarm);
+  }
+
+  void removeAt(size_t position) {
+    _positions.release(_heap[position].slot);
+
+    Alarm last = _heap.back();
+    _heap.pop_back();
+
+    if (position < _heap.size()) {
+      place(position, last);
+      if ((position > 0) && before(last, _heap[(position - 1) / 2]))
+        siftUp(position);
+      else
+        siftDown(position);
+    }
+  }
+private:
+  std::vector<Alarm> _heap;
+
+  // Position in the heap of every pending alarm
+  SlotTable<size_t> _positions;
+
+  std::uint64_t _nextSequence;
+};
+
+}
+
+#endif // __ALARMQUEUE_H
@@ -42,7 +42,6 @@ class AtomTable;
 
 static constexpr size_t bitsPerChar = std::is_same<nchar, char32_t>::value ? 5 :
                                       std::is_same<nchar, char16_t>::value ? 4 : 3;
-static constexpr size_t charBitsMask = (1 << bitsPerChar) - 1;
 
 //////////////
 // AtomImpl //
@@ -58,6 +57,10 @@ public:
     return data;
   }
 
+  std::uint64_t hash() const {
+    return _hash;
+  }
+
   int compare(const AtomImpl* rhs) const {
     if (this == rhs) {
       return 0;
@@ -69,24 +72,27 @@ public:
 private:
   friend class AtomTable;
 
-  AtomImpl(VM vm, size_t size, const nchar* data,
-           size_t critBit, int d, AtomImpl* other)
-    : size(size), critBit(critBit) {
+  AtomImpl(size_t size, const nchar* data, std::uint64_t hash,
+           AtomImpl* nextAtom)
+    : size(size), _hash(hash), marked(false), nextAtom(nextAtom) {
 
     size_t dataLength = size >> bitsPerChar;
-    nchar* data0 = new (vm) nchar[dataLength + 1];
+    nchar* data0 = new nchar[dataLength + 1];
     std::memcpy(data0, data, dataLength * sizeof(nchar));
     data0[dataLength] = (nchar) 0;
     this->data = data0;
+  }
 
-    side[d]=this;
-    side[1-d]=other;
+  ~AtomImpl() {
+    delete[] data;
   }
 
   size_t size;           // number of bits in this atom.
   const nchar* data;     // the string content
-  size_t critBit;
-  AtomImpl* side[2];
+  std::uint64_t _hash;
+
+  mutable bool marked;   // reached during the current garbage collection
+  AtomImpl* nextAtom;    // list of all the atoms, for sweeping
 };
 
 //////////////////
@@ -103,6 +109,11 @@ const nchar* basic_atom_t<atom_type>::contents() const {
   return _impl->contents();
 }
 
+template <size_t atom_type>
+std::uint64_t basic_atom_t<atom_type>::hash() const {
+  return _impl->hash();
+}
+
 template <size_t atom_type>
 bool basic_atom_t<atom_type>::equals(const basic_atom_t<atom_type>& rhs) const {
   return _impl == rhs._impl;
@@ -248,9 +259,32 @@ void BasicAtomStreamer<C, atom_type>::print(
 // AtomTable //
 ///////////////
 
+/* Lookups go through a hash table, with open addressing, indexed by the hash
+ * stored in each atom.
+ *
+ * Atoms are allocated outside of the garbage-collected heap, so that they
+ * never move. Instead of rebuilding the table on every garbage collection,
+ * the GC marks the atoms it reaches (see GraphReplicator::copyAtom), which is
+ * O(1) per reference, and the atoms that were not marked are swept at the
+ * end of the collection.
+ */
 class AtomTable {
 public:
-  AtomTable() : root(nullptr), _count(0) {}
+  AtomTable() : _count(0), _atoms(nullptr), _marking(false),
+    _buckets(nullptr), _bucketMask(0) {}
+
+  AtomTable(const AtomTable&) = delete;
+  AtomTable& operator=(const AtomTable&) = delete;
+
+  ~AtomTable() {
+    AtomImpl* next;
+    for (AtomImpl* atom = _atoms; atom != nullptr; atom = next) {
+      next = atom->nextAtom;
+      delete atom;
+    }
+
+    delete[] _buckets;
+  }
 
   size_t count() {return _count;}
 
@@ -269,67 +303,143 @@ public:
   unique_name_t getUniqueName(VM vm, size_t size, const nchar* data) {
     return unique_name_t(getInternal(vm, size, data));
   }
+public:
+  // Garbage collection
+
+  /** Start marking; atoms that are looked up until sweep() are marked too */
+  void startMarking() {
+    _marking = true;
+  }
+
+  template <size_t atom_type>
+  static void mark(const basic_atom_t<atom_type>& atom) {
+    atom._impl->marked = true;
+  }
+
+  /**
+   * Free the atoms that were not marked since startMarking(), and clear the
+   * marks. Returns the number of freed atoms.
+   */
+  size_t sweep() {
+    size_t swept = 0;
+
+    AtomImpl** atomP = &_atoms;
+    while (*atomP != nullptr) {
+      AtomImpl* atom = *atomP;
+      if (atom->marked) {
+        atom->marked = false;
+        atomP = &atom->nextAtom;
+      } else {
+        *atomP = atom->nextAtom;
+        delete atom;
+        swept++;
+      }
+    }
+
+    _marking = false;
+
+    // The index only needs to be rebuilt if atoms died
+    if (swept > 0) {
+      _count -= swept;
+      rebuildIndex();
+    }
+
+    return swept;
+  }
 private:
   __attribute__((noinline))
   AtomImpl* getInternal(VM vm, size_t size, const nchar* data) {
     assert(size == (size << (bitsPerChar+1)) >> (bitsPerChar+1));   // ??
-    size <<= bitsPerChar;
-    if(root == nullptr){
+    std::uint64_t hash = hashContents(size, data);
+    AtomImpl* result = lookup(hash, size, data);
+    if (result == nullptr) {
       ++_count;
-      size_t critBit = size + (1 << bitsPerChar);
-      return root = new (vm) AtomImpl(vm, size, data, critBit, 1, nullptr);
-    }
-    AtomImpl** curP = &root;
-    size_t nextToCheck = 0;
-    while(true) {
-      AtomImpl*& cur = *curP;
-      size_t checkEnd = cur->critBit;
-      bool cand = false;
-      if(cur->critBit < nextToCheck) {
-	cand=true;
-	checkEnd=cur->size+16;
-      }
-      size_t f = firstMismatch(size, data,
-			       cur->size, cur->data,
-			       nextToCheck, checkEnd);
-      if(f < checkEnd){
-	++_count;
-	return cur = new (vm) AtomImpl(vm, size, data, f, bitAt(size, data, f), cur);
-      }
-      if(cand) return cur;
-      nextToCheck=cur->critBit+1;
-      curP = &(cur->side[bitAt(size, data, cur->critBit)]);
+      result = _atoms = new AtomImpl(size << bitsPerChar, data, hash, _atoms);
+      addToIndex(result);
     }
+    if (_marking)
+      result->marked = true;
+    return result;
   }
+
 private:
-  int bitAt(size_t size, const nchar* data, size_t pos) {
-    if(pos >= size) return 1;
-    return (data[pos >> bitsPerChar] & (1 << (pos & charBitsMask))) ? 1 : 0;
-  }
-  nchar charAt(size_t sizeC, const nchar* data, size_t i) {
-    if(i >= sizeC) return ~(nchar)0;
-    return data[i];
+  // Hash index
+
+  static constexpr size_t initialBucketCount = 256;
+
+  /** 64-bit FNV-1a of the contents */
+  static std::uint64_t hashContents(size_t length, const nchar* data) {
+    auto bytes = reinterpret_cast<const unsigned char*>(data);
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length * sizeof(nchar); i++) {
+      hash ^= bytes[i];
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
   }
-  size_t firstMismatch(size_t s1, const nchar* d1,
-		       size_t s2, const nchar* d2,
-		       size_t start, size_t stop) {
-    if(start == stop) return stop;
-    stop--;
-    size_t s1c = s1 >> bitsPerChar;
-    size_t s2c = s2 >> bitsPerChar;
-    nchar mask = (1 << (start & charBitsMask)) - 1;
-    mask = ~mask;
-    for(size_t i = start >> bitsPerChar; (i <= stop >> bitsPerChar); ++i) {
-      nchar x = charAt(s1c, d1, i);
-      nchar y = charAt(s2c, d2, i);
-      nchar d = (x ^ y) & mask;
-      if(d) return (i << bitsPerChar) + __builtin_ctz(d);
-      mask = ~(nchar)0;
+
+  AtomImpl* lookup(std::uint64_t hash, size_t length, const nchar* data) {
+    if (_buckets == nullptr)
+      return nullptr;
+
+    for (size_t i = hash & _bucketMask; ; i = (i + 1) & _bucketMask) {
+      AtomImpl* atom = _buckets[i];
+      if (atom == nullptr)
+        return nullptr;
+
+      if ((atom->_hash == hash) && (atom->length() == length) &&
+          (std::memcmp(atom->data, data, length * sizeof(nchar)) == 0))
+        return atom;
     }
-    return stop+1;
   }
-  AtomImpl* root;
+
+  void addToIndex(AtomImpl* atom) {
+    // Keep the load factor under 1/2
+    if ((_buckets == nullptr) || (2 * _count > _bucketMask + 1))
+      rebuildIndex();
+    else
+      placeInIndex(atom);
+  }
+
+  void placeInIndex(AtomImpl* atom) {
+    size_t i = atom->_hash & _bucketMask;
+    while (_buckets[i] != nullptr)
+      i = (i + 1) & _bucketMask;
+    _buckets[i] = atom;
+  }
+
+  /** Rebuild the index from the list of atoms, with room to grow */
+  void rebuildIndex() {
+    size_t bucketCount = initialBucketCount;
+    while (bucketCount < 4 * _count)
+      bucketCount *= 2;
+
+    delete[] _buckets;
+    _buckets = new AtomImpl*[bucketCount]();
+    _bucketMask = bucketCount - 1;
+
+    for (AtomImpl* atom = _atoms; atom != nullptr; atom = atom->nextAtom)
+      placeInIndex(atom);
+  }
+private:
   size_t _count;
+  AtomImpl* _atoms;
+  bool _marking;
+
+  AtomImpl** _buckets;
+  size_t _bucketMask;
+};
+
+}
+
+namespace std {
+
+/** Hash of atoms, to use them in the standard unordered containers */
+template <size_t atom_type>
+struct hash<mozart::basic_atom_t<atom_type>> {
+  size_t operator()(const mozart::basic_atom_t<atom_type>& atom) const {
+    return (size_t) atom.hash();
+  }
 };
 
 }
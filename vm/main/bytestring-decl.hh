@@ -40,21 +40,28 @@ namespace mozart {
 #endif
 
 class ByteString: public DataType<ByteString>,
-  public IntegerDottableHelper<ByteString>, WithValueBehavior {
+  public IntegerDottableHelper<ByteString>,
+  public RopeHelper<ByteString, unsigned char>, WithValueBehavior {
 public:
   static constexpr UUID uuid = "{2ca6b7da-7a3f-4f65-be2f-75bb6f704c47}";
 
   static atom_t getTypeAtom(VM vm) {
-    return vm->getAtom(MOZART_STR("byteString"));
+    return vm->coreatoms.typeByteString;
   }
 
   ByteString(VM vm, const LString<unsigned char>& bytes) : _bytes(bytes) {}
 
+  ByteString(VM vm, StableNode* left, StableNode* right)
+    : RopeHelper(vm, left, right), _bytes(nullptr) {}
+
   inline
   ByteString(VM vm, GR gr, ByteString& from);
 
 public:
-  const LString<unsigned char>& value() const { return _bytes; }
+  const LString<unsigned char>& value(VM vm) {
+    flatten(vm);
+    return _bytes;
+  }
 
   inline
   bool equals(VM vm, RichNode right);
@@ -63,7 +70,7 @@ protected:
   friend class IntegerDottableHelper<ByteString>;
 
   bool isValidFeature(VM vm, nativeint feature) {
-    return (feature >= 0) && (feature < _bytes.length);
+    return (feature >= 0) && (feature < length());
   }
 
   inline
@@ -105,6 +112,10 @@ public:
   void stringSearch(RichNode self, VM vm, RichNode from, RichNode needle,
                     UnstableNode& begin, UnstableNode& end);
 
+  inline
+  UnstableNode stringSearchAll(RichNode self, VM vm, RichNode from,
+                               RichNode needle);
+
   inline
   bool stringHasPrefix(VM vm, RichNode prefix);
 
@@ -117,6 +128,19 @@ public:
   inline
   void printReprToStream(VM vm, std::ostream& out, int depth, int width);
 
+private:
+  // Needle of a search: either a byte, stored into byte, or a byte string
+  inline
+  mut::BaseLString<unsigned char> getSearchNeedle(VM vm, RichNode needleNode,
+                                                  unsigned char& byte);
+
+private:
+  friend class RopeHelper<ByteString, unsigned char>;
+
+  LString<unsigned char>& ropeContents() {
+    return _bytes;
+  }
+
 private:
   LString<unsigned char> _bytes;
 };
@@ -41,14 +41,15 @@ namespace mozart {
 // Core methods ----------------------------------------------------------------
 
 ByteString::ByteString(VM vm, GR gr, ByteString& from)
-  : _bytes(vm, from._bytes) {
+  : RopeHelper(vm, gr, from), _bytes(vm, from._bytes) {
 }
 
 bool ByteString::equals(VM vm, RichNode right) {
-  return value() == right.as<ByteString>().value();
+  return value(vm) == right.as<ByteString>().value(vm);
 }
 
 UnstableNode ByteString::getValueAt(VM vm, nativeint feature) {
+  flatten(vm);
   return mozart::build(vm, _bytes[feature]);
 }
 
@@ -71,6 +72,7 @@ namespace internal {
 }
 
 int ByteString::compare(VM vm, RichNode right) {
+  flatten(vm);
   return internal::compareByteStrings(_bytes,
                                       *StringLike(right).byteStringGet(vm));
 }
@@ -78,6 +80,7 @@ int ByteString::compare(VM vm, RichNode right) {
 // StringLike ------------------------------------------------------------------
 
 LString<unsigned char>* ByteString::byteStringGet(VM vm) {
+  flatten(vm);
   return &_bytes;
 }
 
@@ -88,6 +91,7 @@ LString<nchar>* ByteString::stringGet(RichNode self, VM vm) {
 nativeint ByteString::stringCharAt(RichNode self, VM vm, RichNode offsetNode) {
   auto offset = getArgument<nativeint>(vm, offsetNode, MOZART_STR("integer"));
 
+  flatten(vm);
   if (offset < 0 || offset >= _bytes.length)
     raiseIndexOutOfBounds(vm, offsetNode, self);
 
@@ -95,6 +99,10 @@ nativeint ByteString::stringCharAt(RichNode self, VM vm, RichNode offsetNode) {
 }
 
 UnstableNode ByteString::stringAppend(RichNode self, VM vm, RichNode right) {
+  if (right.is<ByteString>())
+    return concat(vm, self, right);
+
+  flatten(vm);
   auto rightBytes = StringLike(right).byteStringGet(vm);
   LString<unsigned char> resultBytes = concatLString(vm, _bytes, *rightBytes);
   if (resultBytes.isError())
@@ -107,69 +115,84 @@ UnstableNode ByteString::stringSlice(RichNode self, VM vm,
   auto fromOffset = getArgument<nativeint>(vm, from, MOZART_STR("integer"));
   auto toOffset = getArgument<nativeint>(vm, to, MOZART_STR("integer"));
 
+  flatten(vm);
   if (fromOffset < 0 || fromOffset > toOffset || toOffset > _bytes.length)
     raiseIndexOutOfBounds(vm, fromOffset, toOffset);
 
   return ByteString::build(vm, _bytes.slice(fromOffset, toOffset));
 }
 
-void ByteString::stringSearch(
-  RichNode self, VM vm, RichNode from, RichNode needleNode,
-  UnstableNode& begin, UnstableNode& end) {
+mut::BaseLString<unsigned char> ByteString::getSearchNeedle(
+  VM vm, RichNode needleNode, unsigned char& byte) {
 
-  // TODO Fix this - it was deactivated because of a build problem on Mac OS
-#ifdef __llvm__ // or is it __clang__?
-  raiseError(vm, MOZART_STR("notImplemented"),
-             MOZART_STR("ByteString::stringSearch"));
-#else
   using namespace patternmatching;
 
-  auto fromOffset = getArgument<nativeint>(vm, from, MOZART_STR("integer"));
-
-  if (fromOffset < 0 || fromOffset > _bytes.length)
-    raiseIndexOutOfBounds(vm, fromOffset);
-
-  LString<unsigned char> haystack = _bytes.slice(fromOffset);
-
   nativeint character = 0;
-
   if (matches(vm, needleNode, capture(character))) {
-
     if (character < 0 || character >= 0x100)
       raiseTypeError(vm, MOZART_STR("Integer between 0 and 255"), needleNode);
 
-    auto haystackUnsafe = const_cast<unsigned char*>(haystack.string);
-    const void* searchRes = memchr(haystackUnsafe, character,
-                                   haystack.bytesCount());
-    if (searchRes == nullptr) {
-      begin = Boolean::build(vm, false);
-      end = Boolean::build(vm, false);
-    } else {
-      nativeint foundOffset =
-        static_cast<const unsigned char*>(searchRes) - _bytes.string;
-      begin = SmallInt::build(vm, foundOffset);
-      end = SmallInt::build(vm, foundOffset + 1);
-    }
-
+    byte = (unsigned char) character;
+    return mut::BaseLString<unsigned char>(&byte, 1);
   } else {
-
     auto needle = StringLike(needleNode).byteStringGet(vm);
-    auto foundIter = std::search(haystack.begin(), haystack.end(),
-                                 needle->begin(), needle->end());
-    if (foundIter == haystack.end()) {
-      begin = Boolean::build(vm, false);
-      end = Boolean::build(vm, false);
-    } else {
-      nativeint foundOffset = foundIter - _bytes.string;
-      begin = SmallInt::build(vm, foundOffset);
-      end = SmallInt::build(vm, foundOffset + needle->length);
-    }
+    return mut::BaseLString<unsigned char>(needle->string, needle->length);
+  }
+}
+
+void ByteString::stringSearch(
+  RichNode self, VM vm, RichNode from, RichNode needleNode,
+  UnstableNode& begin, UnstableNode& end) {
+
+  auto fromOffset = getArgument<nativeint>(vm, from, MOZART_STR("integer"));
+
+  unsigned char byte;
+  auto needle = getSearchNeedle(vm, needleNode, byte);
 
+  flatten(vm);
+  if (fromOffset < 0 || fromOffset > _bytes.length)
+    raiseIndexOutOfBounds(vm, fromOffset);
+
+  nativeint foundOffset = searchLString(_bytes.slice(fromOffset), needle);
+  if (foundOffset < 0) {
+    begin = Boolean::build(vm, false);
+    end = Boolean::build(vm, false);
+  } else {
+    begin = SmallInt::build(vm, fromOffset + foundOffset);
+    end = SmallInt::build(vm, fromOffset + foundOffset + needle.length);
   }
-#endif
+}
+
+UnstableNode ByteString::stringSearchAll(RichNode self, VM vm, RichNode from,
+                                         RichNode needleNode) {
+  auto offset = getArgument<nativeint>(vm, from, MOZART_STR("integer"));
+
+  unsigned char byte;
+  auto needle = getSearchNeedle(vm, needleNode, byte);
+  if (needle.length == 0)
+    raiseTypeError(vm, MOZART_STR("Non-empty ByteString or byte"),
+                   needleNode);
+
+  flatten(vm);
+  if (offset < 0 || offset > _bytes.length)
+    raiseIndexOutOfBounds(vm, offset);
+
+  // Occurrences do not overlap
+  OzListBuilder result(vm);
+  while (true) {
+    nativeint foundOffset = searchLString(_bytes.slice(offset), needle);
+    if (foundOffset < 0)
+      break;
+
+    result.push_back(vm, offset + foundOffset);
+    offset += foundOffset + needle.length;
+  }
+
+  return result.get(vm);
 }
 
 bool ByteString::stringHasPrefix(VM vm, RichNode prefixNode) {
+  flatten(vm);
   auto prefix = StringLike(prefixNode).stringGet(vm);
   if (_bytes.length < prefix->length)
     return false;
@@ -178,6 +201,7 @@ bool ByteString::stringHasPrefix(VM vm, RichNode prefixNode) {
 }
 
 bool ByteString::stringHasSuffix(VM vm, RichNode suffixNode) {
+  flatten(vm);
   auto suffix = StringLike(suffixNode).stringGet(vm);
   if (_bytes.length < suffix->length)
     return false;
@@ -190,6 +214,7 @@ bool ByteString::stringHasSuffix(VM vm, RichNode suffixNode) {
 
 void ByteString::printReprToStream(VM vm, std::ostream& out,
                                    int depth, int width) {
+  flatten(vm);
   out << "<ByteString \"";
   if (_bytes.isError()) {
     out << "error " << _bytes.error;
@@ -0,0 +1,121 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __CHUNKEDBUFFER_H
+#define __CHUNKEDBUFFER_H
+
+#include "core-forward-decl.hh"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace mozart {
+
+/**
+ * Output buffer made of fixed-size chunks, to which VirtualStrings and
+ * VirtualByteStrings are written in a single pass by ozVSWrite() and
+ * ozVBSWrite(). The chunks can then be handed as they are to a scatter/gather
+ * write, or written one after the other.
+ *
+ * Growing never moves the bytes already written, and chunks are kept for
+ * reuse when the buffer is truncated.
+ */
+class ChunkedBuffer {
+public:
+  static constexpr size_t chunkSize = 16*1024;
+
+  /** Number of chunks that clear() keeps allocated */
+  static constexpr size_t retainedChunks = 4;
+
+public:
+  ChunkedBuffer(): _size(0) {}
+
+  size_t size() {
+    return _size;
+  }
+
+  bool empty() {
+    return _size == 0;
+  }
+
+  /** Drop the bytes after the first size ones */
+  void truncate(size_t size) {
+    if (size < _size)
+      _size = size;
+  }
+
+  /** Drop all the bytes, and release the chunks beyond retainedChunks */
+  void clear() {
+    _size = 0;
+    if (_chunks.size() > retainedChunks)
+      _chunks.resize(retainedChunks);
+  }
+
+  void append(const char* data, size_t size) {
+    while (size > 0) {
+      size_t offset = _size % chunkSize;
+      if ((offset == 0) && (_size / chunkSize == _chunks.size()))
+        _chunks.emplace_back(new char[chunkSize]);
+
+      size_t count = chunkSize - offset;
+      if (count > size)
+        count = size;
+
+      std::memcpy(_chunks[_size / chunkSize].get() + offset, data, count);
+      _size += count;
+      data += count;
+      size -= count;
+    }
+  }
+
+  void append(const unsigned char* data, size_t size) {
+    append(reinterpret_cast<const char*>(data), size);
+  }
+
+  void push_back(char c) {
+    append(&c, 1);
+  }
+
+  /** Call f(const char* data, size_t size) for every used chunk, in order */
+  template <class F>
+  void forEachChunk(const F& f) {
+    for (size_t offset = 0; offset < _size; offset += chunkSize) {
+      size_t count = _size - offset;
+      if (count > chunkSize)
+        count = chunkSize;
+
+      f(const_cast<const char*>(_chunks[offset / chunkSize].get()), count);
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<char[]>> _chunks;
+  size_t _size;
+};
+
+}
+
+#endif // __CHUNKEDBUFFER_H
@@ -81,6 +81,11 @@ auto encodeGeneric(const BaseLString<nchar>& input,
                    ByteStringEncoding encoding, EncodingVariant variant)
     -> ContainedLString<std::vector<unsigned char>>;
 
+/** Encode directly into a VM-allocated string, without temporary buffers */
+auto encodeGeneric(VM vm, const BaseLString<nchar>& input,
+                   ByteStringEncoding encoding, EncodingVariant variant)
+    -> LString<unsigned char>;
+
 //////////////
 // Decoders //
 //////////////
@@ -105,6 +110,11 @@ auto decodeGeneric(const BaseLString<unsigned char>& input,
                    ByteStringEncoding encoding, EncodingVariant variant)
     -> ContainedLString<std::vector<nchar>>;
 
+/** Decode directly into a VM-allocated string, without temporary buffers */
+auto decodeGeneric(VM vm, const BaseLString<unsigned char>& input,
+                   ByteStringEncoding encoding, EncodingVariant variant)
+    -> LString<nchar>;
+
 }
 
 #endif // __CODERS_DECL_H
@@ -24,131 +24,673 @@
 
 #include "mozart.hh"
 
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__SSE2__) && \
+  (defined(__x86_64__) || defined(__i386__))
+#  define MOZART_CODERS_SSE2
+#  include <emmintrin.h>
+#  if (defined(__clang__) && defined(__has_attribute)) || \
+    (!defined(__clang__) && \
+     ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))))
+#    if !defined(__clang__) || __has_attribute(target)
+#      define MOZART_CODERS_AVX2
+#      include <immintrin.h>
+#    endif
+#  endif
+#endif
+
 namespace mozart {
 
-//////////////
-// Encoders //
-//////////////
+static_assert(std::is_same<nchar, char>::value,
+              "The coders assume that nchar is UTF-8");
 
-auto encodeLatin1(const BaseLString<nchar>& input, EncodingVariant variant)
-    -> ContainedLString<std::vector<unsigned char>> {
-  if (input.isErrorOrEmpty())
-    return input.error;
-
-  std::vector<unsigned char> tempVector;
-  tempVector.reserve(input.length);
-  UnicodeErrorReason curError = UnicodeErrorReason::empty;
-
-  forEachCodePoint(input,
-                   [&](char32_t codePoint) -> bool {
-                     tempVector.push_back(codePoint > 0xff ? '?' : codePoint);
-                     return true;
-                   },
-                   [&](nchar, UnicodeErrorReason error) -> bool {
-                     curError = error;
-                     return false;
-                   });
-
-  if (curError != UnicodeErrorReason::empty)
-    return curError;
+/////////////
+// Kernels //
+/////////////
+
+/* The transcoders spend most of their time on ASCII text, which needs no
+ * decoding at all. These kernels find and convert runs of ASCII code units
+ * a whole vector at a time. SSE2 is part of every x86-64 CPU; AVX2 is used
+ * when the CPU supports it, which is checked once at run time.
+ */
+
+namespace internal {
+
+namespace {
+
+size_t asciiPrefixLengthScalar(const unsigned char* data, size_t length) {
+  const std::uint64_t highBits = 0x8080808080808080ULL;
+
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    if ((word & highBits) != 0)
+      break;
+  }
+
+  while ((i < length) && (data[i] < 0x80))
+    i++;
+
+  return i;
+}
+
+#ifdef MOZART_CODERS_SSE2
+
+size_t asciiPrefixLengthSSE2(const unsigned char* data, size_t length) {
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    int mask = _mm_movemask_epi8(chunk);
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+
+  return i + asciiPrefixLengthScalar(data + i, length - i);
+}
+
+#endif // MOZART_CODERS_SSE2
+
+#ifdef MOZART_CODERS_AVX2
+
+__attribute__((target("avx2")))
+size_t asciiPrefixLengthAVX2(const unsigned char* data, size_t length) {
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i chunk = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(data + i));
+    unsigned int mask = (unsigned int) _mm256_movemask_epi8(chunk);
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+
+  return i + asciiPrefixLengthSSE2(data + i, length - i);
+}
+
+#endif // MOZART_CODERS_AVX2
+
+typedef size_t (*AsciiPrefixLengthFun)(const unsigned char*, size_t);
+
+AsciiPrefixLengthFun selectAsciiPrefixLength() {
+#if defined(MOZART_CODERS_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return asciiPrefixLengthAVX2;
   else
-    return std::move(tempVector);
+    return asciiPrefixLengthSSE2;
+#elif defined(MOZART_CODERS_SSE2)
+  return asciiPrefixLengthSSE2;
+#else
+  return asciiPrefixLengthScalar;
+#endif
 }
 
-auto encodeUTF8(const BaseLString<nchar>& input, EncodingVariant variant)
-    -> ContainedLString<std::vector<unsigned char>> {
+/** Length of the longest prefix of data made of ASCII bytes */
+size_t asciiPrefixLength(const unsigned char* data, size_t length) {
+  static const AsciiPrefixLengthFun impl = selectAsciiPrefixLength();
+  return impl(data, length);
+}
 
-  auto utf8Result = toUTF<char>(input);
-  if (utf8Result.isError())
-    return utf8Result.error;
+size_t asciiPrefixLength(const char* data, size_t length) {
+  return asciiPrefixLength(reinterpret_cast<const unsigned char*>(data),
+                           length);
+}
 
-  size_t encodedLength = utf8Result.bytesCount();
-  bool hasBOM_ = (variant & EncodingVariant::hasBOM) != 0;
-  if (hasBOM_)
-    encodedLength += 3;
+/** Write ASCII bytes as UTF-16 code units */
+void widenASCIIToUTF16(const char* input, size_t length,
+                       unsigned char* output, bool isLittleEndian) {
+  size_t i = 0;
+
+#ifdef MOZART_CODERS_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= length; i += 16) {
+    __m128i chunk = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(input + i));
+    __m128i low = isLittleEndian ? _mm_unpacklo_epi8(chunk, zero)
+                                 : _mm_unpacklo_epi8(zero, chunk);
+    __m128i high = isLittleEndian ? _mm_unpackhi_epi8(chunk, zero)
+                                  : _mm_unpackhi_epi8(zero, chunk);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2*i), low);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2*i + 16), high);
+  }
+#endif
 
-  std::vector<unsigned char> result;
-  result.reserve(encodedLength);
+  for (; i < length; i++) {
+    output[2*i] = isLittleEndian ? input[i] : 0;
+    output[2*i + 1] = isLittleEndian ? 0 : input[i];
+  }
+}
 
-  if (hasBOM_) {
-    result.push_back('\xef');
-    result.push_back('\xbb');
-    result.push_back('\xbf');
+/**
+ * Number of leading UTF-16 code units of the input (given as bytes) that are
+ * ASCII characters. If output is not null, these characters are also written
+ * to it as UTF-8.
+ */
+size_t narrowASCIIFromUTF16(const unsigned char* input, size_t unitCount,
+                            bool isLittleEndian, char* output) {
+  size_t i = 0;
+
+#ifdef MOZART_CODERS_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const int highBytes = isLittleEndian ? 0xaaaa : 0x5555;
+  for (; i + 8 <= unitCount; i += 8) {
+    __m128i chunk = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(input + 2*i));
+
+    // Every byte is < 0x80, and the high byte of every unit is 0
+    int zeroBytes = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+    if ((_mm_movemask_epi8(chunk) != 0) ||
+        ((zeroBytes & highBytes) != highBytes))
+      break;
+
+    if (output != nullptr) {
+      __m128i units = isLittleEndian ? chunk : _mm_srli_epi16(chunk, 8);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i),
+                       _mm_packus_epi16(units, units));
+    }
+  }
+#endif
+
+  for (; i < unitCount; i++) {
+    unsigned char low = isLittleEndian ? input[2*i] : input[2*i + 1];
+    unsigned char high = isLittleEndian ? input[2*i + 1] : input[2*i];
+    if ((high != 0) || (low >= 0x80))
+      break;
+    if (output != nullptr)
+      output[i] = (char) low;
   }
 
-  for (char ch : utf8Result) {
-    result.push_back(ch);
+  return i;
+}
+
+} // anonymous namespace
+
+/**
+ * Validate UTF-8 text. ASCII runs are reported as a whole to
+ * onASCII(const char* begin, size_t length), other code points one by one to
+ * onCodePoint(char32_t codePoint, const char* begin, nativeint length).
+ */
+template <class OnASCII, class OnCodePoint>
+UnicodeErrorReason forEachUTF8Run(const char* begin, const char* end,
+                                  const OnASCII& onASCII,
+                                  const OnCodePoint& onCodePoint) {
+  const char* cur = begin;
+
+  while (cur < end) {
+    size_t asciiLength = asciiPrefixLength(cur, end - cur);
+    if (asciiLength > 0) {
+      onASCII(cur, asciiLength);
+      cur += asciiLength;
+      if (cur == end)
+        break;
+    }
+
+    auto codePointSizePair = fromUTF(cur, end - cur);
+    if (codePointSizePair.second < 0)
+      return (UnicodeErrorReason) codePointSizePair.second;
+
+    onCodePoint(codePointSizePair.first, cur, codePointSizePair.second);
+    cur += codePointSizePair.second;
   }
 
+  return UnicodeErrorReason::empty;
+}
+
+/**
+ * Run a transcoder. A transcoder first measures its output, validating its
+ * input at the same time, then writes it to storage of exactly that size.
+ */
+template <class Codec, class InC, class OutC>
+ContainedLString<std::vector<OutC>> transcodeToVector(
+  const BaseLString<InC>& input, EncodingVariant variant) {
+
+  nativeint length = Codec::measure(input, variant);
+  if (length < 0)
+    return (UnicodeErrorReason) length;
+
+  std::vector<OutC> result(length);
+  Codec::write(input, variant, result.data());
   return std::move(result);
 }
 
-auto encodeUTF16(const BaseLString<nchar>& input, EncodingVariant variant)
-    -> ContainedLString<std::vector<unsigned char>> {
+template <class Codec, class InC, class OutC>
+LString<OutC> transcodeToLString(VM vm, const BaseLString<InC>& input,
+                                 EncodingVariant variant) {
+  nativeint length = Codec::measure(input, variant);
+  if (length <= 0)
+    return (UnicodeErrorReason) length;
+
+  return LString<OutC>(vm, length, [&] (OutC* buffer) {
+    Codec::write(input, variant, buffer);
+  });
+}
+
+namespace {
 
-  auto utf16Result = toUTF<char16_t>(input);
-  if (utf16Result.isError())
-    return utf16Result.error;
+void writeUTF16Unit(unsigned char*& output, char16_t unit,
+                    bool isLittleEndian) {
+  unsigned char low = unit & 0xff;
+  unsigned char high = unit >> 8;
+  *output++ = isLittleEndian ? low : high;
+  *output++ = isLittleEndian ? high : low;
+}
+
+void writeUTF32Unit(unsigned char*& output, char32_t unit,
+                    bool isLittleEndian) {
+  unsigned char a = unit & 0xff;
+  unsigned char b = (unit >> 8) & 0xff;
+  unsigned char c = (unit >> 16) & 0xff;
+  unsigned char d = unit >> 24;
+  *output++ = isLittleEndian ? a : d;
+  *output++ = isLittleEndian ? b : c;
+  *output++ = isLittleEndian ? c : b;
+  *output++ = isLittleEndian ? d : a;
+}
 
-  size_t encodedLength = utf16Result.bytesCount();
-  bool hasBOM_ = (variant & EncodingVariant::hasBOM) != 0;
-  bool isLittleEndian = (variant & EncodingVariant::littleEndian) != 0;
-  if (hasBOM_)
-    encodedLength += 2;
+nativeint utf8Length(char32_t codePoint) {
+  return (codePoint < 0x80) ? 1 : (codePoint < 0x800) ? 2 :
+    (codePoint < 0x10000) ? 3 : 4;
+}
 
-  std::vector<unsigned char> result;
-  result.reserve(encodedLength);
+bool hasBOM(EncodingVariant variant) {
+  return (variant & EncodingVariant::hasBOM) != 0;
+}
 
-  if (hasBOM_) {
-    result.push_back(isLittleEndian ? 0xff : 0xfe);
-    result.push_back(isLittleEndian ? 0xfe : 0xff);
+bool isLittleEndian(EncodingVariant variant) {
+  return (variant & EncodingVariant::littleEndian) != 0;
+}
+
+} // anonymous namespace
+
+//////////////
+// Encoders //
+//////////////
+
+struct Latin1Encoder {
+  static nativeint measure(const BaseLString<nchar>& input,
+                           EncodingVariant variant) {
+    if (input.isErrorOrEmpty())
+      return input.error;
+
+    nativeint length = 0;
+    UnicodeErrorReason error = forEachUTF8Run(
+      input.begin(), input.end(),
+      [&] (const char*, size_t asciiLength) { length += asciiLength; },
+      [&] (char32_t, const char*, nativeint) { length++; });
+
+    return (error != UnicodeErrorReason::empty) ? error : length;
   }
 
-  for (char16_t ch : utf16Result) {
-    unsigned char low = ch & 0xff;
-    unsigned char high = ch >> 8;
-    result.push_back(isLittleEndian ? low : high);
-    result.push_back(isLittleEndian ? high : low);
+  static void write(const BaseLString<nchar>& input, EncodingVariant variant,
+                    unsigned char* output) {
+    forEachUTF8Run(
+      input.begin(), input.end(),
+      [&] (const char* begin, size_t asciiLength) {
+        std::memcpy(output, begin, asciiLength);
+        output += asciiLength;
+      },
+      [&] (char32_t codePoint, const char*, nativeint) {
+        *output++ = (codePoint > 0xff) ? '?' : codePoint;
+      });
   }
+};
 
-  return std::move(result);
-}
+struct UTF8Encoder {
+  static nativeint measure(const BaseLString<nchar>& input,
+                           EncodingVariant variant) {
+    if (input.isError())
+      return input.error;
 
-auto encodeUTF32(const BaseLString<nchar>& input, EncodingVariant variant)
-    -> ContainedLString<std::vector<unsigned char>> {
+    UnicodeErrorReason error = forEachUTF8Run(
+      input.begin(), input.end(),
+      [] (const char*, size_t) {},
+      [] (char32_t, const char*, nativeint) {});
 
-  auto utf32Result = toUTF<char32_t>(input);
-  if (utf32Result.isError())
-    return utf32Result.error;
+    if (error != UnicodeErrorReason::empty)
+      return error;
 
-  size_t encodedLength = utf32Result.bytesCount();
-  bool hasBOM_ = (variant & EncodingVariant::hasBOM) != 0;
-  bool isLittleEndian = (variant & EncodingVariant::littleEndian) != 0;
-  if (hasBOM_)
-    encodedLength += 4;
+    return input.length + (hasBOM(variant) ? 3 : 0);
+  }
 
-  std::vector<unsigned char> result;
-  result.reserve(encodedLength);
+  static void write(const BaseLString<nchar>& input, EncodingVariant variant,
+                    unsigned char* output) {
+    if (hasBOM(variant)) {
+      *output++ = 0xef;
+      *output++ = 0xbb;
+      *output++ = 0xbf;
+    }
 
-  if (hasBOM_) {
-    result.push_back(isLittleEndian ? 0xff : 0);
-    result.push_back(isLittleEndian ? 0xfe : 0);
-    result.push_back(isLittleEndian ? 0 : 0xfe);
-    result.push_back(isLittleEndian ? 0 : 0xff);
+    std::memcpy(output, input.string, input.bytesCount());
+  }
+};
+
+struct UTF16Encoder {
+  static nativeint measure(const BaseLString<nchar>& input,
+                           EncodingVariant variant) {
+    if (input.isError())
+      return input.error;
+
+    nativeint length = hasBOM(variant) ? 2 : 0;
+    UnicodeErrorReason error = forEachUTF8Run(
+      input.begin(), input.end(),
+      [&] (const char*, size_t asciiLength) { length += 2 * asciiLength; },
+      [&] (char32_t codePoint, const char*, nativeint) {
+        length += (codePoint >= 0x10000) ? 4 : 2;
+      });
+
+    return (error != UnicodeErrorReason::empty) ? error : length;
   }
 
-  for (char32_t ch : utf32Result) {
-    unsigned char a = ch & 0xff;
-    unsigned char b = (ch >> 8) & 0xff;
-    unsigned char c = (ch >> 16) & 0xff;
-    unsigned char d = ch >> 24;
-    result.push_back(isLittleEndian ? a : d);
-    result.push_back(isLittleEndian ? b : c);
-    result.push_back(isLittleEndian ? c : b);
-    result.push_back(isLittleEndian ? d : a);
+  static void write(const BaseLString<nchar>& input, EncodingVariant variant,
+                    unsigned char* output) {
+    bool littleEndian = isLittleEndian(variant);
+
+    if (hasBOM(variant))
+      writeUTF16Unit(output, 0xfeff, littleEndian);
+
+    forEachUTF8Run(
+      input.begin(), input.end(),
+      [&] (const char* begin, size_t asciiLength) {
+        widenASCIIToUTF16(begin, asciiLength, output, littleEndian);
+        output += 2 * asciiLength;
+      },
+      [&] (char32_t codePoint, const char*, nativeint) {
+        char16_t units[2];
+        nativeint unitCount = toUTF(codePoint, units);
+        for (nativeint i = 0; i < unitCount; i++)
+          writeUTF16Unit(output, units[i], littleEndian);
+      });
   }
+};
 
-  return std::move(result);
+struct UTF32Encoder {
+  static nativeint measure(const BaseLString<nchar>& input,
+                           EncodingVariant variant) {
+    if (input.isError())
+      return input.error;
+
+    nativeint length = hasBOM(variant) ? 4 : 0;
+    UnicodeErrorReason error = forEachUTF8Run(
+      input.begin(), input.end(),
+      [&] (const char*, size_t asciiLength) { length += 4 * asciiLength; },
+      [&] (char32_t, const char*, nativeint) { length += 4; });
+
+    return (error != UnicodeErrorReason::empty) ? error : length;
+  }
+
+  static void write(const BaseLString<nchar>& input, EncodingVariant variant,
+                    unsigned char* output) {
+    bool littleEndian = isLittleEndian(variant);
+
+    if (hasBOM(variant))
+      writeUTF32Unit(output, 0xfeff, littleEndian);
+
+    forEachUTF8Run(
+      input.begin(), input.end(),
+      [&] (const char* begin, size_t asciiLength) {
+        for (size_t i = 0; i < asciiLength; i++)
+          writeUTF32Unit(output, (unsigned char) begin[i], littleEndian);
+      },
+      [&] (char32_t codePoint, const char*, nativeint) {
+        writeUTF32Unit(output, codePoint, littleEndian);
+      });
+  }
+};
+
+//////////////
+// Decoders //
+//////////////
+
+struct Latin1Decoder {
+  static nativeint measure(const BaseLString<unsigned char>& input,
+                           EncodingVariant variant) {
+    if (input.isErrorOrEmpty())
+      return 0;
+
+    // 0x80~0xff map to 2-byte sequences
+    nativeint length = input.length;
+    for (nativeint i = 0; i < input.length; i++) {
+      i += asciiPrefixLength(input.string + i, input.length - i);
+      if (i < input.length)
+        length++;
+    }
+
+    return length;
+  }
+
+  static void write(const BaseLString<unsigned char>& input,
+                    EncodingVariant variant, nchar* output) {
+    for (nativeint i = 0; i < input.length; i++) {
+      size_t asciiLength = asciiPrefixLength(input.string + i,
+                                             input.length - i);
+      std::memcpy(output, input.string + i, asciiLength);
+      output += asciiLength;
+      i += asciiLength;
+
+      if (i < input.length) {
+        unsigned char c = input.string[i];
+        *output++ = (nchar) (0xc0 | (c >> 6));
+        *output++ = (nchar) (0x80 | (c & 0x3f));
+      }
+    }
+  }
+};
+
+struct UTF8Decoder {
+  static BaseLString<char> textOf(const BaseLString<unsigned char>& input,
+                                  EncodingVariant variant) {
+    nativeint start = 0;
+    if (hasBOM(variant) && input.length >= 3) {
+      if (memcmp(input.string, "\xef\xbb\xbf", 3) == 0) {
+        start = 3;
+      }
+    }
+
+    return BaseLString<char>(
+      reinterpret_cast<const char*>(input.string) + start,
+      input.length - start);
+  }
+
+  static nativeint measure(const BaseLString<unsigned char>& input,
+                           EncodingVariant variant) {
+    if (input.isError())
+      return input.error;
+
+    auto text = textOf(input, variant);
+    UnicodeErrorReason error = forEachUTF8Run(
+      text.begin(), text.end(),
+      [] (const char*, size_t) {},
+      [] (char32_t, const char*, nativeint) {});
+
+    return (error != UnicodeErrorReason::empty) ? error : text.length;
+  }
+
+  static void write(const BaseLString<unsigned char>& input,
+                    EncodingVariant variant, nchar* output) {
+    auto text = textOf(input, variant);
+    std::memcpy(output, text.string, text.bytesCount());
+  }
+};
+
+struct UTF16Decoder {
+  static nativeint start(const BaseLString<unsigned char>& input,
+                         EncodingVariant variant, bool& littleEndian) {
+    littleEndian = isLittleEndian(variant);
+    if (hasBOM(variant) && input.length >= 2) {
+      if (memcmp(input.string, "\xfe\xff", 2) == 0) {
+        littleEndian = false;
+        return 2;
+      } else if (memcmp(input.string, "\xff\xfe", 2) == 0) {
+        littleEndian = true;
+        return 2;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * Write the ASCII runs to output (if not null) and call
+   * onCodePoint(char32_t codePoint, nchar* output) for each other code point.
+   * onCodePoint returns the number of code units it wrote to output.
+   */
+  template <class OnCodePoint>
+  static UnicodeErrorReason forEachUnit(
+    const BaseLString<unsigned char>& input, EncodingVariant variant,
+    nchar* output, const OnCodePoint& onCodePoint) {
+
+    bool littleEndian;
+    const unsigned char* cur = input.string + start(input, variant,
+                                                    littleEndian);
+    const unsigned char* end = input.end();
+
+    while (cur < end) {
+      size_t asciiCount = narrowASCIIFromUTF16(cur, (end - cur) / 2,
+                                               littleEndian, output);
+      cur += 2 * asciiCount;
+      if (output != nullptr)
+        output += asciiCount;
+      if (cur == end)
+        break;
+
+      char16_t units[2] = { 0, 0 };
+      nativeint unitCount = std::min<nativeint>((end - cur) / 2, 2);
+      for (nativeint i = 0; i < unitCount; i++) {
+        unsigned char low = littleEndian ? cur[2*i] : cur[2*i + 1];
+        unsigned char high = littleEndian ? cur[2*i + 1] : cur[2*i];
+        units[i] = low | high << 8;
+      }
+
+      auto codePointSizePair = fromUTF(units, unitCount);
+      if (codePointSizePair.second < 0)
+        return (UnicodeErrorReason) codePointSizePair.second;
+
+      nativeint written = onCodePoint(codePointSizePair.first, output);
+      if (output != nullptr)
+        output += written;
+      cur += 2 * codePointSizePair.second;
+    }
+
+    return UnicodeErrorReason::empty;
+  }
+
+  static nativeint measure(const BaseLString<unsigned char>& input,
+                           EncodingVariant variant) {
+    if (input.isError())
+      return input.error;
+    else if (input.length % 2 != 0)
+      return UnicodeErrorReason::truncated;
+
+    bool littleEndian;
+    nativeint length = (input.length - start(input, variant, littleEndian)) / 2;
+    UnicodeErrorReason error = forEachUnit(input, variant, nullptr,
+      [&] (char32_t codePoint, nchar*) -> nativeint {
+        // Count the extra UTF-8 code units, the units themselves are counted
+        length += utf8Length(codePoint) - ((codePoint >= 0x10000) ? 2 : 1);
+        return 0;
+      });
+
+    return (error != UnicodeErrorReason::empty) ? error : length;
+  }
+
+  static void write(const BaseLString<unsigned char>& input,
+                    EncodingVariant variant, nchar* output) {
+    forEachUnit(input, variant, output,
+      [] (char32_t codePoint, nchar* output) -> nativeint {
+        return toUTF(codePoint, output);
+      });
+  }
+};
+
+struct UTF32Decoder {
+  template <class OnCodePoint>
+  static UnicodeErrorReason forEachCodePoint(
+    const BaseLString<unsigned char>& input, EncodingVariant variant,
+    const OnCodePoint& onCodePoint) {
+
+    nativeint start = 0;
+    bool littleEndian = isLittleEndian(variant);
+    if (hasBOM(variant) && input.length >= 4) {
+      if (memcmp(input.string, "\x00\x00\xfe\xff", 4) == 0) {
+        start = 4;
+        littleEndian = false;
+      } else if (memcmp(input.string, "\xff\xfe\x00\x00", 4) == 0) {
+        start = 4;
+        littleEndian = true;
+      }
+    }
+
+    for (nativeint i = start; i < input.length; i += 4) {
+      const unsigned char* unit = input.string + i;
+      unsigned char a = littleEndian ? unit[0] : unit[3];
+      unsigned char b = littleEndian ? unit[1] : unit[2];
+      unsigned char c = littleEndian ? unit[2] : unit[1];
+      unsigned char d = littleEndian ? unit[3] : unit[0];
+      char32_t codePoint = a | b << 8 | c << 16 | d << 24;
+
+      auto codePointSizePair = fromUTF(&codePoint, 1);
+      if (codePointSizePair.second < 0)
+        return (UnicodeErrorReason) codePointSizePair.second;
+
+      onCodePoint(codePoint);
+    }
+
+    return UnicodeErrorReason::empty;
+  }
+
+  static nativeint measure(const BaseLString<unsigned char>& input,
+                           EncodingVariant variant) {
+    if (input.isError())
+      return input.error;
+    else if (input.length % 4 != 0)
+      return UnicodeErrorReason::truncated;
+
+    nativeint length = 0;
+    UnicodeErrorReason error = forEachCodePoint(input, variant,
+      [&] (char32_t codePoint) {
+        length += utf8Length(codePoint);
+      });
+
+    return (error != UnicodeErrorReason::empty) ? error : length;
+  }
+
+  static void write(const BaseLString<unsigned char>& input,
+                    EncodingVariant variant, nchar* output) {
+    forEachCodePoint(input, variant,
+      [&] (char32_t codePoint) {
+        output += toUTF(codePoint, output);
+      });
+  }
+};
+
+} // namespace internal
+
+//////////////
+// Encoders //
+//////////////
+
+auto encodeLatin1(const BaseLString<nchar>& input, EncodingVariant variant)
+    -> ContainedLString<std::vector<unsigned char>> {
+  return internal::transcodeToVector<internal::Latin1Encoder, nchar,
+                                     unsigned char>(input, variant);
+}
+
+auto encodeUTF8(const BaseLString<nchar>& input, EncodingVariant variant)
+    -> ContainedLString<std::vector<unsigned char>> {
+  return internal::transcodeToVector<internal::UTF8Encoder, nchar,
+                                     unsigned char>(input, variant);
+}
+
+auto encodeUTF16(const BaseLString<nchar>& input, EncodingVariant variant)
+    -> ContainedLString<std::vector<unsigned char>> {
+  return internal::transcodeToVector<internal::UTF16Encoder, nchar,
+                                     unsigned char>(input, variant);
+}
+
+auto encodeUTF32(const BaseLString<nchar>& input, EncodingVariant variant)
+    -> ContainedLString<std::vector<unsigned char>> {
+  return internal::transcodeToVector<internal::UTF32Encoder, nchar,
+                                     unsigned char>(input, variant);
 }
 
 auto encodeGeneric(const BaseLString<nchar>& input,
@@ -166,6 +708,30 @@ auto encodeGeneric(const BaseLString<nchar>& input,
   }
 }
 
+auto encodeGeneric(VM vm, const BaseLString<nchar>& input,
+                   ByteStringEncoding encoding, EncodingVariant variant)
+    -> LString<unsigned char> {
+  using namespace internal;
+
+  switch (encoding) {
+    case ByteStringEncoding::latin1:
+      return transcodeToLString<Latin1Encoder, nchar, unsigned char>(
+        vm, input, variant);
+    case ByteStringEncoding::utf8:
+      return transcodeToLString<UTF8Encoder, nchar, unsigned char>(
+        vm, input, variant);
+    case ByteStringEncoding::utf16:
+      return transcodeToLString<UTF16Encoder, nchar, unsigned char>(
+        vm, input, variant);
+    case ByteStringEncoding::utf32:
+      return transcodeToLString<UTF32Encoder, nchar, unsigned char>(
+        vm, input, variant);
+    default:
+      assert(false);
+      std::abort();
+  }
+}
+
 //////////////
 // Decoders //
 //////////////
@@ -173,106 +739,29 @@ auto encodeGeneric(const BaseLString<nchar>& input,
 auto decodeLatin1(const BaseLString<unsigned char>& input,
                   EncodingVariant variant)
     -> ContainedLString<std::vector<nchar>> {
-
-  std::vector<nchar> tempVector;
-  tempVector.reserve(input.length);
-
-  if (std::is_same<nchar, char>::value) {
-    // UTF-8 needs special consideration, because 0x80~0xff maps to 2-byte
-    // sequences.
-    for (char32_t c : input) {
-      nchar encoded[4];
-      nativeint length = toUTF(c, encoded);   // always valid.
-      tempVector.insert(tempVector.end(), encoded, encoded + length);
-    }
-  } else {
-    std::copy(input.begin(), input.end(), std::back_inserter(tempVector));
-  }
-
-  return std::move(tempVector);
+  return internal::transcodeToVector<internal::Latin1Decoder, unsigned char,
+                                     nchar>(input, variant);
 }
 
 auto decodeUTF8(const BaseLString<unsigned char>& input,
                 EncodingVariant variant)
     -> ContainedLString<std::vector<nchar>> {
-
-  nativeint start = 0;
-  if ((variant & EncodingVariant::hasBOM) != 0 && input.length >= 3) {
-    if (memcmp(input.string, "\xef\xbb\xbf", 3) == 0) {
-      start = 3;
-    }
-  }
-
-  const auto& slice = input.unsafeSlice(start);
-  BaseLString<char> utf8Input(reinterpret_cast<const char*>(slice.string),
-                              slice.length);
-  return toUTF<nchar>(utf8Input);
+  return internal::transcodeToVector<internal::UTF8Decoder, unsigned char,
+                                     nchar>(input, variant);
 }
 
 auto decodeUTF16(const BaseLString<unsigned char>& input,
                  EncodingVariant variant)
     -> ContainedLString<std::vector<nchar>> {
-
-  if (input.isError())
-    return input.error;
-  else if (input.length % 2 != 0)
-    return UnicodeErrorReason::truncated;
-
-  nativeint start = 0;
-  bool isLittleEndian = (variant & EncodingVariant::littleEndian) != 0;
-  if ((variant & EncodingVariant::hasBOM) != 0 && input.length >= 2) {
-    if (memcmp(input.string, "\xfe\xff", 2) == 0) {
-      start = 2;
-      isLittleEndian = false;
-    } else if (memcmp(input.string, "\xff\xfe", 2) == 0) {
-      start = 2;
-      isLittleEndian = true;
-    }
-  }
-
-  std::vector<char16_t> buffer;
-  buffer.reserve(input.length / 2);
-  for (nativeint i = start; i < input.length; i += 2) {
-    unsigned char low = isLittleEndian ? input.string[i] : input.string[i+1];
-    unsigned char high = isLittleEndian ? input.string[i+1] : input.string[i];
-    buffer.push_back(low | high << 8);
-  }
-
-  return toUTF<nchar>(makeLString(buffer.data(), buffer.size()));
+  return internal::transcodeToVector<internal::UTF16Decoder, unsigned char,
+                                     nchar>(input, variant);
 }
 
 auto decodeUTF32(const BaseLString<unsigned char>& input,
                  EncodingVariant variant)
     -> ContainedLString<std::vector<nchar>> {
-
-  if (input.isError())
-    return input.error;
-  else if (input.length % 4 != 0)
-    return UnicodeErrorReason::truncated;
-
-  nativeint start = 0;
-  bool isLittleEndian = (variant & EncodingVariant::littleEndian) != 0;
-  if ((variant & EncodingVariant::hasBOM) != 0 && input.length >= 4) {
-    if (memcmp(input.string, "\x00\x00\xfe\xff", 4) == 0) {
-      start = 4;
-      isLittleEndian = false;
-    } else if (memcmp(input.string, "\xff\xfe\x00\x00", 4) == 0) {
-      start = 4;
-      isLittleEndian = true;
-    }
-  }
-
-  std::vector<char32_t> buffer;
-  buffer.reserve(input.length / 4);
-  for (nativeint i = start; i < input.length; i += 4) {
-    unsigned char a = isLittleEndian ? input.string[i] : input.string[i+3];
-    unsigned char b = isLittleEndian ? input.string[i+1] : input.string[i+2];
-    unsigned char c = isLittleEndian ? input.string[i+2] : input.string[i+1];
-    unsigned char d = isLittleEndian ? input.string[i+3] : input.string[i];
-    buffer.push_back(a | b << 8 | c << 16 | d << 24);
-  }
-
-  return toUTF<nchar>(makeLString(buffer.data(), buffer.size()));
+  return internal::transcodeToVector<internal::UTF32Decoder, unsigned char,
+                                     nchar>(input, variant);
 }
 
 auto decodeGeneric(const BaseLString<unsigned char>& input,
@@ -290,4 +779,28 @@ auto decodeGeneric(const BaseLString<unsigned char>& input,
   }
 }
 
+auto decodeGeneric(VM vm, const BaseLString<unsigned char>& input,
+                   ByteStringEncoding encoding, EncodingVariant variant)
+    -> LString<nchar> {
+  using namespace internal;
+
+  switch (encoding) {
+    case ByteStringEncoding::latin1:
+      return transcodeToLString<Latin1Decoder, unsigned char, nchar>(
+        vm, input, variant);
+    case ByteStringEncoding::utf8:
+      return transcodeToLString<UTF8Decoder, unsigned char, nchar>(
+        vm, input, variant);
+    case ByteStringEncoding::utf16:
+      return transcodeToLString<UTF16Decoder, unsigned char, nchar>(
+        vm, input, variant);
+    case ByteStringEncoding::utf32:
+      return transcodeToLString<UTF32Decoder, unsigned char, nchar>(
+        vm, input, variant);
+    default:
+      assert(false);
+      std::abort();
+  }
+}
+
 }
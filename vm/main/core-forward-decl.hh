@@ -85,6 +85,10 @@ public:
   inline
   const nchar* contents() const;
 
+  /** Hash of the contents, computed once when the atom is created */
+  inline
+  std::uint64_t hash() const;
+
   inline
   bool equals(const basic_atom_t<atom_type>& rhs) const;
 
@@ -73,6 +73,44 @@ struct CoreAtoms {
   atom_t invalidUTF16;
   atom_t truncated;
 
+  // Type atoms (see getTypeAtom())
+  atom_t typeArity;
+  atom_t typeArray;
+  atom_t typeAtom;
+  atom_t typeByteString;
+  atom_t typeCell;
+  atom_t typeChunk;
+  atom_t typeCodeArea;
+  atom_t typeDictionary;
+  atom_t typeFloat;
+  atom_t typeGNode;
+  atom_t typeInt;
+  atom_t typeName;
+  atom_t typeObject;
+  atom_t typePort;
+  atom_t typeProcedure;
+  atom_t typeRecord;
+  atom_t typeReflective;
+  atom_t typeSerializer;
+  atom_t typeSpace;
+  atom_t typeThread;
+  atom_t typeTuple;
+  atom_t typeUnicodeString;
+  atom_t typeUnpickler;
+
+  // Objects
+  atom_t apply;
+
+  // Stack traces
+  atom_t entry;
+  atom_t call;
+  atom_t PC;
+  atom_t column;
+  atom_t data;
+  atom_t file;
+  atom_t kind;
+  atom_t line;
+
   // Exceptions
   atom_t debug;
   atom_t error;
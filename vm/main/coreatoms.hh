@@ -62,6 +62,41 @@ void CoreAtoms::initialize(VM vm, AtomTable& atomTable) {
   invalidUTF16 = atomTable.get(vm, MOZART_STR("invalidUTF16"));
   truncated = atomTable.get(vm, MOZART_STR("truncated"));
 
+  typeArity = atomTable.get(vm, MOZART_STR("arity"));
+  typeArray = atomTable.get(vm, MOZART_STR("array"));
+  typeAtom = atomTable.get(vm, MOZART_STR("atom"));
+  typeByteString = atomTable.get(vm, MOZART_STR("byteString"));
+  typeCell = atomTable.get(vm, MOZART_STR("cell"));
+  typeChunk = atomTable.get(vm, MOZART_STR("chunk"));
+  typeCodeArea = atomTable.get(vm, MOZART_STR("codeArea"));
+  typeDictionary = atomTable.get(vm, MOZART_STR("dictionary"));
+  typeFloat = atomTable.get(vm, MOZART_STR("float"));
+  typeGNode = atomTable.get(vm, MOZART_STR("gNode"));
+  typeInt = atomTable.get(vm, MOZART_STR("int"));
+  typeName = atomTable.get(vm, MOZART_STR("name"));
+  typeObject = atomTable.get(vm, MOZART_STR("object"));
+  typePort = atomTable.get(vm, MOZART_STR("port"));
+  typeProcedure = atomTable.get(vm, MOZART_STR("procedure"));
+  typeRecord = atomTable.get(vm, MOZART_STR("record"));
+  typeReflective = atomTable.get(vm, MOZART_STR("reflective"));
+  typeSerializer = atomTable.get(vm, MOZART_STR("serializer"));
+  typeSpace = atomTable.get(vm, MOZART_STR("space"));
+  typeThread = atomTable.get(vm, MOZART_STR("thread"));
+  typeTuple = atomTable.get(vm, MOZART_STR("tuple"));
+  typeUnicodeString = atomTable.get(vm, MOZART_STR("unicodeString"));
+  typeUnpickler = atomTable.get(vm, MOZART_STR("unpickler"));
+
+  apply = atomTable.get(vm, MOZART_STR("apply"));
+
+  entry = atomTable.get(vm, MOZART_STR("entry"));
+  call = atomTable.get(vm, MOZART_STR("call"));
+  PC = atomTable.get(vm, MOZART_STR("PC"));
+  column = atomTable.get(vm, MOZART_STR("column"));
+  data = atomTable.get(vm, MOZART_STR("data"));
+  file = atomTable.get(vm, MOZART_STR("file"));
+  kind = atomTable.get(vm, MOZART_STR("kind"));
+  line = atomTable.get(vm, MOZART_STR("line"));
+
   debug = atomTable.get(vm, MOZART_STR("debug"));
   error = atomTable.get(vm, MOZART_STR("error"));
   system = atomTable.get(vm, MOZART_STR("system"));
@@ -660,6 +660,11 @@ struct Interface<StringLike>:
     raiseTypeError(vm, MOZART_STR("String"), self);
   }
 
+  UnstableNode stringSearchAll(RichNode self, VM vm, RichNode from,
+                               RichNode needle) {
+    raiseTypeError(vm, MOZART_STR("String"), self);
+  }
+
   bool stringHasPrefix(RichNode self, VM vm, RichNode prefix) {
     raiseTypeError(vm, MOZART_STR("String"), self);
   }
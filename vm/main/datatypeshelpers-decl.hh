@@ -131,6 +131,88 @@ protected:
   */
 };
 
+////////////////
+// RopeHelper //
+////////////////
+
+/**
+ * Rope representation for the string-like data type T, made of code units C.
+ *
+ * Concatenating long values does not copy them: it builds a node that only
+ * references both operands, and keeps the tree balanced like an AVL tree.
+ * The contents are copied into contiguous storage the first time they are
+ * needed, after which the node forgets its operands.
+ */
+template <class T, class C>
+class RopeHelper {
+private:
+  T* getThis() {
+    return static_cast<T*>(this);
+  }
+
+public:
+  /** Shorter concatenations are copied right away */
+  static constexpr nativeint minRopeLength = 256;
+
+protected:
+  RopeHelper(): _left(nullptr), _right(nullptr), _length(0), _height(0) {}
+
+  inline
+  RopeHelper(VM vm, StableNode* left, StableNode* right);
+
+  inline
+  RopeHelper(VM vm, GR gr, RopeHelper& from);
+
+public:
+  bool isRope() {
+    return _left != nullptr;
+  }
+
+  /** Length of the contents, in code units, without flattening them */
+  inline
+  nativeint length();
+
+  nativeint ropeHeight() {
+    return isRope() ? _height : 0;
+  }
+
+  StableNode* ropeLeft() {
+    return _left;
+  }
+
+  StableNode* ropeRight() {
+    return _right;
+  }
+
+protected:
+  /** Concatenate two values of type T */
+  inline
+  static UnstableNode concat(VM vm, RichNode left, RichNode right);
+
+  /** Make sure the contents are stored contiguously */
+  inline
+  void flatten(VM vm);
+
+  /* To be implemented in subclasses
+  LString<C>& ropeContents();
+  */
+
+private:
+  inline
+  static StableNode* join(VM vm, StableNode* left, StableNode* right);
+
+  inline
+  static StableNode* makeBalanced(VM vm, StableNode* left, StableNode* right);
+
+  inline
+  static StableNode* makeNode(VM vm, StableNode* left, StableNode* right);
+
+  StableNode* _left;
+  StableNode* _right;
+  nativeint _length;
+  nativeint _height;
+};
+
 }
 
 #endif // __DATATYPESHELPERS_DECL_H
@@ -126,6 +126,181 @@ bool IntegerDottableHelper<T>::lookupFeature(VM vm, nativeint feature,
   }
 }
 
+////////////////
+// RopeHelper //
+////////////////
+
+template <class T, class C>
+RopeHelper<T, C>::RopeHelper(VM vm, StableNode* left, StableNode* right)
+  : _left(left), _right(right) {
+
+  auto leftValue = RichNode(*left).as<T>();
+  auto rightValue = RichNode(*right).as<T>();
+
+  _length = leftValue.length() + rightValue.length();
+  _height = std::max(leftValue.ropeHeight(), rightValue.ropeHeight()) + 1;
+}
+
+template <class T, class C>
+RopeHelper<T, C>::RopeHelper(VM vm, GR gr, RopeHelper& from)
+  : _left(nullptr), _right(nullptr),
+    _length(from._length), _height(from._height) {
+
+  if (from.isRope()) {
+    gr->copyStableRef(_left, from._left);
+    gr->copyStableRef(_right, from._right);
+  }
+}
+
+template <class T, class C>
+nativeint RopeHelper<T, C>::length() {
+  return isRope() ? _length : getThis()->ropeContents().length;
+}
+
+template <class T, class C>
+UnstableNode RopeHelper<T, C>::concat(VM vm, RichNode left, RichNode right) {
+  auto leftValue = left.as<T>();
+  auto rightValue = right.as<T>();
+
+  if (rightValue.length() == 0)
+    return { vm, left };
+  else if (leftValue.length() == 0)
+    return { vm, right };
+
+  if (leftValue.length() + rightValue.length() < minRopeLength) {
+    return T::build(vm, concatLString(vm, leftValue.value(vm),
+                                      rightValue.value(vm)));
+  }
+
+  StableNode* result = join(vm, left.getStableRef(vm),
+                            right.getStableRef(vm));
+  return { vm, *result };
+}
+
+template <class T, class C>
+void RopeHelper<T, C>::flatten(VM vm) {
+  if (!isRope())
+    return;
+
+  getThis()->ropeContents() = LString<C>(vm, _length,
+    [this, vm] (C* buffer) {
+      // Copy the leaves from left to right
+      std::vector<StableNode*> pending = { _right, _left };
+      C* output = buffer;
+
+      while (!pending.empty()) {
+        auto node = RichNode(*pending.back()).as<T>();
+        pending.pop_back();
+
+        if (node.isRope()) {
+          pending.push_back(node.ropeRight());
+          pending.push_back(node.ropeLeft());
+        } else {
+          auto& contents = node.value(vm);
+          std::copy(contents.begin(), contents.end(), output);
+          output += contents.length;
+        }
+      }
+    });
+
+  // Let the operands be collected
+  _left = nullptr;
+  _right = nullptr;
+  _height = 0;
+}
+
+template <class T, class C>
+StableNode* RopeHelper<T, C>::join(VM vm, StableNode* left,
+                                   StableNode* right) {
+  auto leftValue = RichNode(*left).as<T>();
+  auto rightValue = RichNode(*right).as<T>();
+
+  nativeint leftHeight = leftValue.ropeHeight();
+  nativeint rightHeight = rightValue.ropeHeight();
+
+  // Coalesce short leaves, so that appending many small pieces does not
+  // create as many leaves
+  if (!rightValue.isRope() && (rightValue.length() < minRopeLength)) {
+    if (!leftValue.isRope()) {
+      if (leftValue.length() + rightValue.length() < minRopeLength) {
+        auto result = new (vm) StableNode;
+        result->init(vm, T::build(vm, concatLString(
+          vm, leftValue.value(vm), rightValue.value(vm))));
+        return result;
+      }
+    } else {
+      auto lastLeaf = RichNode(*leftValue.ropeRight()).as<T>();
+      if (!lastLeaf.isRope() &&
+          (lastLeaf.length() + rightValue.length() < minRopeLength)) {
+        return makeBalanced(vm, leftValue.ropeLeft(),
+                            join(vm, leftValue.ropeRight(), right));
+      }
+    }
+  }
+
+  // Descend along the side of the higher tree, as in an AVL tree
+  if (leftHeight > rightHeight + 1) {
+    StableNode* newRight = join(vm, leftValue.ropeRight(), right);
+    return makeBalanced(vm, leftValue.ropeLeft(), newRight);
+  } else if (rightHeight > leftHeight + 1) {
+    StableNode* newLeft = join(vm, left, rightValue.ropeLeft());
+    return makeBalanced(vm, newLeft, rightValue.ropeRight());
+  } else {
+    return makeNode(vm, left, right);
+  }
+}
+
+template <class T, class C>
+StableNode* RopeHelper<T, C>::makeBalanced(VM vm, StableNode* left,
+                                           StableNode* right) {
+  auto leftValue = RichNode(*left).as<T>();
+  auto rightValue = RichNode(*right).as<T>();
+
+  nativeint leftHeight = leftValue.ropeHeight();
+  nativeint rightHeight = rightValue.ropeHeight();
+
+  if (leftHeight > rightHeight + 1) {
+    auto leftLeft = RichNode(*leftValue.ropeLeft()).as<T>();
+    auto leftRight = RichNode(*leftValue.ropeRight()).as<T>();
+
+    if (leftLeft.ropeHeight() >= leftRight.ropeHeight()) {
+      // Single rotation
+      return makeNode(vm, leftValue.ropeLeft(),
+                      makeNode(vm, leftValue.ropeRight(), right));
+    } else {
+      // Double rotation
+      return makeNode(vm,
+                      makeNode(vm, leftValue.ropeLeft(), leftRight.ropeLeft()),
+                      makeNode(vm, leftRight.ropeRight(), right));
+    }
+  } else if (rightHeight > leftHeight + 1) {
+    auto rightLeft = RichNode(*rightValue.ropeLeft()).as<T>();
+    auto rightRight = RichNode(*rightValue.ropeRight()).as<T>();
+
+    if (rightRight.ropeHeight() >= rightLeft.ropeHeight()) {
+      // Single rotation
+      return makeNode(vm, makeNode(vm, left, rightValue.ropeLeft()),
+                      rightValue.ropeRight());
+    } else {
+      // Double rotation
+      return makeNode(vm,
+                      makeNode(vm, left, rightLeft.ropeLeft()),
+                      makeNode(vm, rightLeft.ropeRight(),
+                               rightValue.ropeRight()));
+    }
+  } else {
+    return makeNode(vm, left, right);
+  }
+}
+
+template <class T, class C>
+StableNode* RopeHelper<T, C>::makeNode(VM vm, StableNode* left,
+                                       StableNode* right) {
+  auto result = new (vm) StableNode;
+  result->init(vm, T::build(vm, left, right));
+  return result;
+}
+
 }
 
 #endif // MOZART_GENERATOR
@@ -129,25 +129,27 @@ namespace {
     UnstableNode debugData;
     Callable(*abstraction).getDebugInfo(vm, printName, debugData);
 
-    UnstableNode kind = build(vm, MOZART_STR("call"));
+    auto& coreatoms = vm->coreatoms;
+
+    UnstableNode kind = build(vm, coreatoms.call);
     UnstableNode data = build(vm, *abstraction);
 
     Dottable dotDebugData(debugData);
-    UnstableNode file = dotDebugData.condSelect(vm, MOZART_STR("file"),
-                                                vm->coreatoms.empty);
-    UnstableNode line = dotDebugData.condSelect(vm, MOZART_STR("line"), unit);
-    UnstableNode column = dotDebugData.condSelect(vm, MOZART_STR("column"), -1);
+    UnstableNode file = dotDebugData.condSelect(vm, coreatoms.file,
+                                                coreatoms.empty);
+    UnstableNode line = dotDebugData.condSelect(vm, coreatoms.line, unit);
+    UnstableNode column = dotDebugData.condSelect(vm, coreatoms.column, -1);
 
     UnstableNode PCNode = build(vm, reinterpret_cast<std::intptr_t>(PC));
 
     return buildRecord(
-      vm, buildArity(vm, MOZART_STR("entry"),
-                     MOZART_STR("PC"),
-                     MOZART_STR("column"),
-                     MOZART_STR("data"),
-                     MOZART_STR("file"),
-                     MOZART_STR("kind"),
-                     MOZART_STR("line")),
+      vm, buildArity(vm, coreatoms.entry,
+                     coreatoms.PC,
+                     coreatoms.column,
+                     coreatoms.data,
+                     coreatoms.file,
+                     coreatoms.kind,
+                     coreatoms.line),
       std::move(PCNode), std::move(column), std::move(data), std::move(file),
       std::move(kind), std::move(line)
     );
@@ -218,6 +220,7 @@ void Thread::constructor(VM vm, RichNode abstraction,
   pushFrame(vm, abstraction.getStableRef(vm), start, 0, nullptr, Gs, Ks);
 
   injectedException = nullptr;
+  _runningAbstraction = nullptr;
   _terminationVar.init(vm, OptVar::build(vm, getSpace()));
 
   // Resume the thread unless createSuspended
@@ -247,6 +250,8 @@ Thread::Thread(GR gr, Thread& from): Runnable(gr, from) {
   else
     gr->copyStableRef(injectedException, from.injectedException);
 
+  _runningAbstraction = nullptr;
+
   gr->copyStableNode(_terminationVar, from._terminationVar);
 }
 
@@ -267,6 +272,9 @@ void Thread::run() {
 
   popFrame(vm, abstraction, PC, yregCount, yregs, gregs, kregs);
 
+  // Let the allocation profiler see the procedure that is running
+  _runningAbstraction = &abstraction;
+
   getIntermediateState().rewind(vm);
 
   // Some helpers
@@ -1148,6 +1156,8 @@ void Thread::run() {
     }
   } MOZART_ENDTRY(vm);
 
+  _runningAbstraction = nullptr;
+
 #undef IntPC
 #undef XPC
 #undef YPC
@@ -1159,6 +1169,10 @@ void Thread::run() {
 
   // Store the current state in the stack frame, for next invocation of run()
   pushFrame(vm, abstraction, PC, yregCount, yregs, gregs, kregs);
+
+  // The profiler samples the stack at this safe point
+  if (vm->getProfiler().isSampleRequested())
+    vm->getProfiler().sample(vm, stack);
 }
 
 void Thread::pushFrame(VM vm, StableNode* abstraction,
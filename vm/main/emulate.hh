@@ -204,6 +204,14 @@ public:
       resume();
   }
 
+  ThreadStack* getStackForProfiling() {
+    return &stack;
+  }
+
+  StableNode* getRunningAbstractionForProfiling() {
+    return (_runningAbstraction != nullptr) ? *_runningAbstraction : nullptr;
+  }
+
 public:
   void beforeGR();
   void afterGR();
@@ -319,6 +327,9 @@ private:
   ThreadStack stack;
   StableNode* injectedException;
   StableNode _terminationVar;
+
+  // Local variable of run() holding the running procedure, while it runs
+  StableNode** _runningAbstraction;
 };
 
 }
@@ -29,6 +29,10 @@
 
 #include "graphreplicator-decl.hh"
 
+#include <cstdint>
+#include <functional>
+#include <map>
+
 namespace mozart {
 
 // Set this to true to print debug info about the GC
@@ -38,19 +42,103 @@ const bool OzDebugGC = true;
 const bool OzDebugGC = false;
 #endif
 
+//////////////////
+// GCStatistics //
+//////////////////
+
+struct GCTypeStatistics {
+  GCTypeStatistics(): objects(0), bytes(0) {}
+
+  size_t objects;
+  size_t bytes;
+};
+
+/**
+ * Telemetry about garbage collections
+ * Pause times are measured in microseconds. The pause histogram counts the
+ * collections whose pause was in [2^(i-1), 2^i) us, bucket 0 being < 1 us,
+ * and the last bucket gathering all the longer pauses.
+ */
+struct GCStatistics {
+  static const size_t PauseHistogramSize = 24;
+
+  GCStatistics():
+    lastPause(0), lastBytesBefore(0), lastBytesAfter(0),
+    lastObjectsCopied(0), lastThreads(0), lastSpaces(0),
+    lastAtoms(0), lastAtomsSwept(0), collections(0), totalPause(0), maxPause(0),
+    totalBytesCopied(0), totalBytesReclaimed(0), totalObjectsCopied(0) {
+
+    for (size_t i = 0; i < PauseHistogramSize; i++)
+      pauseHistogram[i] = 0;
+  }
+
+  // Last collection
+  std::uint64_t lastPause;
+  size_t lastBytesBefore;
+  size_t lastBytesAfter;
+  size_t lastObjectsCopied;
+  size_t lastThreads;
+  size_t lastSpaces;
+  size_t lastAtoms;       // live atoms after the collection
+  size_t lastAtomsSwept;
+
+  // Objects and bytes copied per type during the last collection, i.e., a
+  // census of the live heap. Only filled in when per-type statistics are
+  // enabled
+  std::map<const TypeInfo*, GCTypeStatistics> lastPerType;
+
+  // Cumulative totals
+  std::uint64_t collections;
+  std::uint64_t totalPause;
+  std::uint64_t maxPause;
+  std::uint64_t totalBytesCopied;
+  std::uint64_t totalBytesReclaimed;
+  std::uint64_t totalObjectsCopied;
+
+  std::uint64_t pauseHistogram[PauseHistogramSize];
+};
+
 //////////////////////
 // GarbageCollector //
 //////////////////////
 
 class GarbageCollector: public GraphReplicator {
+public:
+  typedef std::function<void(VM, const GCStatistics&)> Listener;
 public:
   GarbageCollector(VM vm):
-    GraphReplicator(vm, GraphReplicator::grkGarbageCollection) {}
+    GraphReplicator(vm, GraphReplicator::grkGarbageCollection),
+    _logEnabled(OzDebugGC), _perTypeEnabled(false),
+    _collectPerType(false) {}
 
   inline
   bool isGCRequired();
 
   void doGC();
+public:
+  const GCStatistics& getStatistics() {
+    return _stats;
+  }
+
+  /** Set a listener called at the end of each collection */
+  void setListener(const Listener& listener) {
+    _listener = listener;
+  }
+
+  /** Log each collection on stderr */
+  bool& logEnabled() {
+    return _logEnabled;
+  }
+
+  /** Gather objects and bytes copied per type
+   *  This costs a map lookup per copied node, hence it is off by default.
+   *  It is also done while the allocation profiler is enabled.
+   */
+  bool& perTypeEnabled() {
+    return _perTypeEnabled;
+  }
+private:
+  void recordCollection(std::uint64_t pause);
 private:
   friend class GraphReplicator;
 
@@ -63,6 +151,12 @@ private:
   template <class NodeType, class GCedType>
   inline
   void processNode(NodeType*& to, RichNode from);
+private:
+  GCStatistics _stats;
+  Listener _listener;
+  bool _logEnabled;
+  bool _perTypeEnabled;
+  bool _collectPerType;
 };
 
 }
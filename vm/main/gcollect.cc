@@ -24,6 +24,8 @@
 
 #include "mozart.hh"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 namespace mozart {
@@ -33,10 +35,19 @@ namespace mozart {
 //////////////////////
 
 void GarbageCollector::doGC() {
-  if (OzDebugGC) {
-    std::cerr << "Before GC: " << vm->getMemoryManager().getAllocated();
-    std::cerr << " bytes used." << std::endl;
-  }
+  auto startTime = std::chrono::steady_clock::now();
+
+  _stats.lastBytesBefore = vm->getMemoryManager().getAllocated();
+  _stats.lastObjectsCopied = 0;
+  _stats.lastThreads = 0;
+  _stats.lastSpaces = 0;
+  _stats.lastPerType.clear();
+
+  // The allocation profiler must not see the copies made by the GC, but it
+  // wants a census of the live nodes
+  auto& allocationProfiler = vm->getAllocationProfiler();
+  allocationProfiler.suspend();
+  _collectPerType = _perTypeEnabled || allocationProfiler.isEnabled();
 
   // General assumptions when running GC
   assert(vm->_currentSpace == vm->_topLevelSpace);
@@ -50,26 +61,88 @@ void GarbageCollector::doGC() {
   // GC loop
   runCopyLoop<GarbageCollector>();
 
+  // Free the atoms that were not reached
+  _stats.lastAtomsSwept = vm->atomTable.sweep();
+  _stats.lastAtoms = vm->atomTable.count();
+
   // After GR
   vm->afterGR(this);
 
-  if (OzDebugGC) {
-    std::cerr << "After GC: " << vm->getMemoryManager().getAllocated();
-    std::cerr << " bytes used." << std::endl;
+  allocationProfiler.resume();
+
+  auto pause = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - startTime);
+
+  recordCollection(pause.count());
+}
+
+void GarbageCollector::recordCollection(std::uint64_t pause) {
+  _stats.lastPause = pause;
+  _stats.lastBytesAfter = vm->getMemoryManager().getAllocated();
+
+  _stats.collections++;
+  _stats.totalPause += pause;
+  _stats.maxPause = std::max(_stats.maxPause, pause);
+  _stats.totalBytesCopied += _stats.lastBytesAfter;
+  if (_stats.lastBytesBefore > _stats.lastBytesAfter)
+    _stats.totalBytesReclaimed +=
+      _stats.lastBytesBefore - _stats.lastBytesAfter;
+  _stats.totalObjectsCopied += _stats.lastObjectsCopied;
+
+  size_t bucket = 0;
+  while ((pause >> bucket) != 0 &&
+         bucket < GCStatistics::PauseHistogramSize-1)
+    bucket++;
+  _stats.pauseHistogram[bucket]++;
+
+  if (_logEnabled) {
+    std::cerr << "GC #" << _stats.collections << ": ";
+    std::cerr << _stats.lastBytesBefore << " -> " << _stats.lastBytesAfter;
+    std::cerr << " bytes, " << _stats.lastObjectsCopied << " nodes, ";
+    std::cerr << _stats.lastThreads << " threads, ";
+    std::cerr << _stats.lastSpaces << " spaces, ";
+    std::cerr << _stats.lastAtoms << " atoms (";
+    std::cerr << _stats.lastAtomsSwept << " swept), ";
+    std::cerr << pause << " us" << std::endl;
+
+    for (auto& item: _stats.lastPerType) {
+      std::cerr << "  " << item.first->getName() << ": ";
+      std::cerr << item.second.objects << " nodes, ";
+      std::cerr << item.second.bytes << " bytes" << std::endl;
+    }
   }
+
+  if (_listener)
+    _listener(vm, _stats);
 }
 
 void GarbageCollector::processSpace(SpaceRef& to, SpaceRef from) {
+  _stats.lastSpaces++;
   to = from->gCollectOuter(this);
 }
 
 void GarbageCollector::processThread(Runnable*& to, Runnable* from) {
+  _stats.lastThreads++;
   to = from->gCollectOuter(this);
 }
 
 template <class NodeType, class GCedType>
 void GarbageCollector::processNode(NodeType*& to, RichNode from) {
-  from.type()->gCollect(this, from, *to);
+  _stats.lastObjectsCopied++;
+
+  if (!_collectPerType) {
+    from.type()->gCollect(this, from, *to);
+  } else {
+    Type type = from.type();
+    size_t before = vm->getMemoryManager().getAllocated();
+
+    type->gCollect(this, from, *to);
+
+    auto& typeStats = _stats.lastPerType[type.info()];
+    typeStats.objects++;
+    typeStats.bytes += vm->getMemoryManager().getAllocated() - before;
+  }
+
   from.reinit(vm, GCedType::build(vm, to));
 }
 
@@ -82,6 +82,9 @@ public:
 
   inline
   atom_t copyAtom(atom_t from);
+
+  inline
+  unique_name_t copyUniqueName(unique_name_t from);
 protected:
   template <class Self>
   void runCopyLoop();
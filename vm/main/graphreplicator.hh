@@ -96,10 +96,18 @@ void GraphReplicator::copyGNode(GlobalNode*& to, GlobalNode* from) {
 }
 
 atom_t GraphReplicator::copyAtom(atom_t from) {
+  // Atoms do not move, the GC only needs to keep them alive
   if (kind() == grkGarbageCollection)
-    return vm->getAtom(from.length(), from.contents());
-  else
-    return from;
+    AtomTable::mark(from);
+
+  return from;
+}
+
+unique_name_t GraphReplicator::copyUniqueName(unique_name_t from) {
+  if (kind() == grkGarbageCollection)
+    AtomTable::mark(from);
+
+  return from;
 }
 
 template <class Self>
@@ -245,6 +245,16 @@ inline auto newLStringInit(VM vm, nativeint len, const F& func)
 template <class C>
 inline LString<C> concatLString(VM vm, const LString<C>& a, const LString<C>& b);
 
+// Find the first occurrence of needle in haystack. Returns its offset, or -1.
+// An empty needle is found at offset 0.
+template <class C>
+inline nativeint searchLString(const BaseLString<C>& haystack,
+                               const BaseLString<C>& needle);
+
+// Byte-level kernel of searchLString (see lstring.cc)
+nativeint searchBytes(const unsigned char* haystack, nativeint haystackLength,
+                      const unsigned char* needle, nativeint needleLength);
+
 }
 
 #endif // __LSTRING_DECL_H
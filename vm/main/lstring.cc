@@ -0,0 +1,107 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "mozart.hh"
+
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__SSE2__) && \
+  (defined(__x86_64__) || defined(__i386__))
+#  define MOZART_LSTRING_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace mozart {
+
+/* Single bytes are searched with memchr, which the C library vectorizes.
+ * Longer needles use a first/last byte filter: 16 candidate positions are
+ * tested at once by comparing the first byte of the needle with a block of
+ * the haystack, and its last byte with the block needleLength-1 bytes
+ * further. Only the positions where both match are checked with memcmp,
+ * which makes the search linear in practice for delimiters and keywords.
+ */
+nativeint searchBytes(const unsigned char* haystack, nativeint haystackLength,
+                      const unsigned char* needle, nativeint needleLength) {
+  if (needleLength <= 0)
+    return 0;
+  else if (needleLength > haystackLength)
+    return -1;
+
+  if (needleLength == 1) {
+    const void* found = std::memchr(haystack, needle[0], haystackLength);
+    if (found == nullptr)
+      return -1;
+    else
+      return static_cast<const unsigned char*>(found) - haystack;
+  }
+
+  const unsigned char first = needle[0];
+  const unsigned char last = needle[needleLength-1];
+  const nativeint startCount = haystackLength - needleLength + 1;
+
+  nativeint i = 0;
+
+#ifdef MOZART_LSTRING_SSE2
+  const __m128i firstBytes = _mm_set1_epi8((char) first);
+  const __m128i lastBytes = _mm_set1_epi8((char) last);
+
+  for (; i + 16 <= startCount; i += 16) {
+    __m128i blockFirst = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(haystack + i));
+    __m128i blockLast = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(haystack + i + needleLength - 1));
+
+    unsigned int mask = _mm_movemask_epi8(
+      _mm_and_si128(_mm_cmpeq_epi8(blockFirst, firstBytes),
+                    _mm_cmpeq_epi8(blockLast, lastBytes)));
+
+    while (mask != 0) {
+      nativeint candidate = i + __builtin_ctz(mask);
+      if (std::memcmp(haystack + candidate + 1, needle + 1,
+                      needleLength - 2) == 0)
+        return candidate;
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  while (i < startCount) {
+    const void* found = std::memchr(haystack + i, first, startCount - i);
+    if (found == nullptr)
+      return -1;
+
+    nativeint candidate = static_cast<const unsigned char*>(found) - haystack;
+    if ((haystack[candidate + needleLength - 1] == last) &&
+        (std::memcmp(haystack + candidate + 1, needle + 1,
+                     needleLength - 2) == 0))
+      return candidate;
+
+    i = candidate + 1;
+  }
+
+  return -1;
+}
+
+}
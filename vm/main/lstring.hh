@@ -240,6 +240,16 @@ LString<C> concatLString(VM vm, const LString<C>& a, const LString<C>& b) {
   });
 }
 
+template <class C>
+nativeint searchLString(const BaseLString<C>& haystack,
+                        const BaseLString<C>& needle) {
+  static_assert(sizeof(C) == 1, "searchLString only supports byte strings");
+
+  return searchBytes(
+    reinterpret_cast<const unsigned char*>(haystack.string), haystack.length,
+    reinterpret_cast<const unsigned char*>(needle.string), needle.length);
+}
+
 }
 
 #endif // __LSTRING_H
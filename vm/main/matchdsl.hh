@@ -344,7 +344,7 @@ struct OzValueToPrimitiveValue<UUID> {
   static bool call(VM vm, RichNode value, UUID& primitive) {
     if (value.is<ByteString>()) {
       // Fast path for a raw ByteString
-      auto& bytes = value.as<ByteString>().value();
+      auto& bytes = value.as<ByteString>().value(vm);
       if (bytes.length == (nativeint) UUID::byte_count) {
         primitive = UUID(bytes.string);
         return true;
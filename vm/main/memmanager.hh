@@ -38,10 +38,12 @@ const size_t MemoryRoom = 10 * MegaBytes;
 class MemoryManager {
 public:
   MemoryManager(size_t maxMemory) :
-    _nextBlock(nullptr), _baseBlock(nullptr), _maxMemory(maxMemory) {}
+    _nextBlock(nullptr), _baseBlock(nullptr), _maxMemory(maxMemory),
+    _bytesServed(0) {}
 
   MemoryManager() :
-    _nextBlock(nullptr), _baseBlock(nullptr), _maxMemory(MAX_MEMORY) {}
+    _nextBlock(nullptr), _baseBlock(nullptr), _maxMemory(MAX_MEMORY),
+    _bytesServed(0) {}
 
   ~MemoryManager() {
     if (_baseBlock != nullptr)
@@ -73,14 +75,8 @@ public:
   }
 
   void* getMemory(size_t size) {
-    if (_allocated + size > _maxMemory) {
-      return getMoreMemory(size);
-    } else {
-      void* result = static_cast<void*>(_nextBlock);
-      _nextBlock += size;
-      _allocated += size;
-      return result;
-    }
+    _bytesServed += size;
+    return allocate(size);
   }
 
   void* malloc(size_t size) {
@@ -91,16 +87,20 @@ public:
 
     if (bucket < MaxBuckets) {
       // Small block - use free list
+      size_t blockSize = bucket * AllocGranularity;
+      _bytesServed += blockSize;
+
       void* list = freeListBuckets[bucket];
       if (list != nullptr) {
         freeListBuckets[bucket] = *static_cast<void**>(list);
         return list;
       } else {
-        return getMemory(bucket * AllocGranularity);
+        return allocate(blockSize);
       }
     } else {
       // Big block - for now use regular malloc/free
       // TODO Allocate a new big block instead
+      _bytesServed += size;
       return ::malloc(size);
     }
   }
@@ -125,10 +125,30 @@ public:
     return _allocated;
   }
 
+  /**
+   * Total size of the blocks handed out by getMemory() and malloc(), be they
+   * new, reused from a free list, or big blocks obtained from ::malloc().
+   * This counter only grows, and is not exchanged by swapWith().
+   */
+  size_t getBytesServed() {
+    return _bytesServed;
+  }
+
   bool isGCRequired() {
     return (_allocated + MemoryRoom > _maxMemory);
   }
 private:
+  void* allocate(size_t size) {
+    if (_allocated + size > _maxMemory) {
+      return getMoreMemory(size);
+    } else {
+      void* result = static_cast<void*>(_nextBlock);
+      _nextBlock += size;
+      _allocated += size;
+      return result;
+    }
+  }
+
   size_t bucketFor(size_t size) {
     return (size + (AllocGranularity-1)) / AllocGranularity;
   }
@@ -143,6 +163,7 @@ private:
 
   size_t _maxMemory;
   size_t _allocated;
+  size_t _bytesServed;
 
   void* freeListBuckets[MaxBuckets];
 };
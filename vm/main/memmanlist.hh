@@ -37,6 +37,11 @@ MemoryManager& virtualMMToActualMM(MemoryManager& mm) {
   return mm;
 }
 
+inline
+void* mallocListNode(MemoryManager& mm, size_t size) {
+  return mm.malloc(size);
+}
+
 ////////////////////
 // MemManagedList //
 ////////////////////
@@ -345,8 +350,7 @@ private:
   }
 
   ListNode* mallocNode(MM mm) {
-    return static_cast<ListNode*>(
-      virtualMMToActualMM(mm).malloc(sizeof(ListNode)));
+    return static_cast<ListNode*>(mallocListNode(mm, sizeof(ListNode)));
   }
 
   void freeNode(MM mm, ListNode* node) {
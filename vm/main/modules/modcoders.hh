@@ -55,7 +55,7 @@ private:
     } else if (matches(vm, encodingNode, MOZART_STR("utf16"))) {
       encoding = ByteStringEncoding::utf16;
     } else if (matches(vm, encodingNode, MOZART_STR("utf32"))) {
-      encoding = ByteStringEncoding::utf8;
+      encoding = ByteStringEncoding::utf32;
     } else {
       raiseTypeError(vm, MOZART_STR("latin1, utf8, utf16 or utf32"),
                      encodingNode);
@@ -97,12 +97,15 @@ public:
       size_t bufSize = ozVSLengthForBuffer(vm, string);
 
       mut::LString<unsigned char> encoded(nullptr);
-      {
+      if (string.is<String>()) {
+        encoded = encodeGeneric(vm, string.as<String>().value(vm),
+                                encoding, variant);
+      } else {
         std::vector<nchar> buffer;
         ozVSGet(vm, string, bufSize, buffer);
         auto rawString = makeLString(buffer.data(), buffer.size());
 
-        encoded = newLString(vm, encodeGeneric(rawString, encoding, variant));
+        encoded = encodeGeneric(vm, rawString, encoding, variant);
       }
 
       if (encoded.isError())
@@ -125,12 +128,15 @@ public:
       size_t bufSize = ozVBSLengthForBuffer(vm, value);
 
       mut::LString<nchar> decoded(nullptr);
-      {
+      if (value.is<ByteString>()) {
+        decoded = decodeGeneric(vm, value.as<ByteString>().value(vm),
+                                encoding, variant);
+      } else {
         std::vector<unsigned char> buffer;
         ozVBSGet(vm, value, bufSize, buffer);
         auto rawString = makeLString(buffer.data(), buffer.size());
 
-        decoded = newLString(vm, decodeGeneric(rawString, encoding, variant));
+        decoded = decodeGeneric(vm, rawString, encoding, variant);
       }
 
       if (decoded.isError())
@@ -95,6 +95,16 @@ public:
     }
   };
 
+  /** List of the starting indices of all the non-overlapping occurrences */
+  class SearchAll : public Builtin<SearchAll> {
+  public:
+    SearchAll() : Builtin("searchAll") {}
+
+    static void call(VM vm, In value, In from, In needle, Out result) {
+      result = StringLike(value).stringSearchAll(vm, from, needle);
+    }
+  };
+
   class HasPrefix : public Builtin<HasPrefix> {
   public:
     HasPrefix() : Builtin("hasPrefix") {}
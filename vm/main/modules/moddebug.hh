@@ -27,6 +27,8 @@
 
 #include "../mozartcore.hh"
 
+#include <sstream>
+
 #ifndef MOZART_GENERATOR
 
 namespace mozart {
@@ -81,6 +83,93 @@ public:
       // TODO
     }
   };
+
+  class StartProfiler: public Builtin<StartProfiler> {
+  public:
+    StartProfiler(): Builtin("startProfiler") {}
+
+    static void call(VM vm) {
+      vm->getProfiler().start();
+    }
+  };
+
+  class StopProfiler: public Builtin<StopProfiler> {
+  public:
+    StopProfiler(): Builtin("stopProfiler") {}
+
+    static void call(VM vm) {
+      vm->getProfiler().stop();
+    }
+  };
+
+  class ResetProfiler: public Builtin<ResetProfiler> {
+  public:
+    ResetProfiler(): Builtin("resetProfiler") {}
+
+    static void call(VM vm) {
+      vm->getProfiler().reset();
+    }
+  };
+
+  class GetProfile: public Builtin<GetProfile> {
+  public:
+    GetProfile(): Builtin("getProfile") {}
+
+    /** Returns the samples in the collapsed-stack format, as a ByteString */
+    static void call(VM vm, Out result) {
+      std::stringstream out;
+      vm->getProfiler().writeCollapsed(out);
+      std::string collapsed = out.str();
+
+      auto data = reinterpret_cast<const unsigned char*>(collapsed.data());
+      result = ByteString::build(
+        vm, newLString(vm, data, collapsed.size()));
+    }
+  };
+
+  class StartAllocProfiler: public Builtin<StartAllocProfiler> {
+  public:
+    StartAllocProfiler(): Builtin("startAllocProfiler") {}
+
+    static void call(VM vm) {
+      vm->getAllocationProfiler().start();
+    }
+  };
+
+  class StopAllocProfiler: public Builtin<StopAllocProfiler> {
+  public:
+    StopAllocProfiler(): Builtin("stopAllocProfiler") {}
+
+    static void call(VM vm) {
+      vm->getAllocationProfiler().stop();
+    }
+  };
+
+  class ResetAllocProfiler: public Builtin<ResetAllocProfiler> {
+  public:
+    ResetAllocProfiler(): Builtin("resetAllocProfiler") {}
+
+    static void call(VM vm) {
+      vm->getAllocationProfiler().reset();
+    }
+  };
+
+  class GetAllocProfile: public Builtin<GetAllocProfile> {
+  public:
+    GetAllocProfile(): Builtin("getAllocProfile") {}
+
+    /** Returns the sampled allocation sites in the collapsed-stack format,
+     *  weighted by bytes, as a ByteString */
+    static void call(VM vm, Out result) {
+      std::stringstream out;
+      vm->getAllocationProfiler().writeCollapsed(out);
+      std::string collapsed = out.str();
+
+      auto data = reinterpret_cast<const unsigned char*>(collapsed.data());
+      result = ByteString::build(
+        vm, newLString(vm, data, collapsed.size()));
+    }
+  };
 };
 
 }
@@ -65,6 +65,111 @@ public:
       }
     }
   };
+
+  class SerializeBinary: public Builtin<SerializeBinary> {
+  public:
+    SerializeBinary(): Builtin("serializeBinary") {}
+
+    static void call(VM vm, In value, Out result) {
+      StreamSerializer::checkSerializable(vm, value);
+      ByteStringListSink sink(vm);
+
+      auto& buffer = vm->getOutputBuffer();
+      buffer.clear();
+      StreamSerializer(vm, buffer, &sink).serialize(value);
+
+      result = sink.get(vm);
+    }
+
+  private:
+    /** Sink that makes a list of ByteStrings out of the chunks */
+    class ByteStringListSink: public SerializationSink {
+    public:
+      explicit ByteStringListSink(VM vm): _chunks(vm) {}
+
+      void write(VM vm, ChunkedBuffer& buffer) {
+        buffer.forEachChunk([&] (const char* data, size_t size) {
+          auto bytes = reinterpret_cast<const unsigned char*>(data);
+          _chunks.push_back(
+            vm, ByteString::build(vm, newLString(vm, bytes, size)));
+        });
+      }
+
+      UnstableNode get(VM vm) {
+        return _chunks.get(vm);
+      }
+    private:
+      OzListBuilder _chunks;
+    };
+  };
+
+  class NewUnpickler: public Builtin<NewUnpickler> {
+  public:
+    NewUnpickler(): Builtin("newUnpickler") {}
+
+    static void call(VM vm, Out unpickler, Out result) {
+      result = OptVar::build(vm);
+      unpickler = Unpickler::build(vm, result);
+    }
+  };
+
+  class UnpicklerFeed: public Builtin<UnpicklerFeed> {
+  public:
+    UnpicklerFeed(): Builtin("unpicklerFeed") {}
+
+    static void call(VM vm, In unpickler, In chunk, Out status) {
+      auto u = getUnpickler(vm, unpickler);
+
+      if (chunk.isTransient())
+        waitFor(vm, chunk);
+      else if (!chunk.is<ByteString>())
+        raiseTypeError(vm, MOZART_STR("ByteString"), chunk);
+
+      u.feed(vm, chunk);
+      status = resume(vm, u);
+    }
+  };
+
+  class UnpicklerResume: public Builtin<UnpicklerResume> {
+  public:
+    UnpicklerResume(): Builtin("unpicklerResume") {}
+
+    static void call(VM vm, In unpickler, Out status) {
+      auto u = getUnpickler(vm, unpickler);
+      status = resume(vm, u);
+    }
+  };
+
+private:
+  /**
+   * Number of node records decoded by one call to UnpicklerFeed or
+   * UnpicklerResume, after which the calling thread should yield, as
+   * OS.unpickle does
+   */
+  static const size_t unpicklerQuota = 10000;
+
+  static TypedRichNode<Unpickler> getUnpickler(VM vm, RichNode unpickler) {
+    if (unpickler.isTransient())
+      waitFor(vm, unpickler);
+    else if (!unpickler.is<Unpickler>())
+      raiseTypeError(vm, MOZART_STR("Unpickler"), unpickler);
+
+    return unpickler.as<Unpickler>();
+  }
+
+  /** Resume, and return needInput, yield or done(Rest) */
+  static UnstableNode resume(VM vm, TypedRichNode<Unpickler> unpickler) {
+    switch (unpickler.resume(vm, unpicklerQuota)) {
+      case usNeedInput:
+        return build(vm, MOZART_STR("needInput"));
+      case usYield:
+        return build(vm, MOZART_STR("yield"));
+      case usDone:
+        return buildTuple(vm, MOZART_STR("done"), unpickler.getRest(vm));
+      default:
+        raiseError(vm, MOZART_STR("unpickle"), unpickler.getError(vm));
+    }
+  }
 };
 
 }
@@ -110,17 +110,18 @@ public:
       auto boolToStdErr = getArgument<bool>(vm, toStdErr, MOZART_STR("Boolean"));
       auto boolNewLine = getArgument<bool>(vm, newLine, MOZART_STR("Boolean"));
 
-      size_t valueBufSize = ozVSLengthForBuffer(vm, value);
+      auto& buffer = vm->getOutputBuffer();
+      buffer.clear();
+      ozVSWrite(vm, value, buffer);
 
-      {
-        std::string valueStr;
-        ozVSGet(vm, value, valueBufSize, valueStr);
+      auto& stream = boolToStdErr ? std::cerr : std::cout;
+      buffer.forEachChunk([&stream] (const char* data, size_t size) {
+        stream.write(data, size);
+      });
+      if (boolNewLine)
+        stream << std::endl;
 
-        auto& stream = boolToStdErr ? std::cerr : std::cout;
-        stream << valueStr;
-        if (boolNewLine)
-          stream << std::endl;
-      }
+      buffer.clear();
     }
   };
 
@@ -46,14 +46,30 @@ public:
     Alarm(): Builtin("alarm") {}
 
     static void call(VM vm, In delay, Out result) {
-      auto intDelay = getArgument<nativeint>(vm, delay, MOZART_STR("integer"));
-
-      if (intDelay <= 0) {
-        result = build(vm, unit);
-      } else {
-        result = Variable::build(vm, vm->getTopLevelSpace());
-        vm->setAlarm(intDelay, RichNode(result).getStableRef(vm));
-      }
+      setAlarm(vm, delay, result);
+    }
+  };
+
+  class SetAlarm: public Builtin<SetAlarm> {
+  public:
+    SetAlarm(): Builtin("setAlarm") {}
+
+    static void call(VM vm, In delay, Out result, Out handle) {
+      auto alarm = setAlarm(vm, delay, result);
+      handle = build(vm, std::make_shared<AlarmHandle>(alarm));
+    }
+  };
+
+  class CancelAlarm: public Builtin<CancelAlarm> {
+  public:
+    CancelAlarm(): Builtin("cancelAlarm") {}
+
+    static void call(VM vm, In handle, Out result) {
+      auto alarm = getPointerArgument<AlarmHandle>(
+        vm, handle, MOZART_STR("alarm handle"));
+
+      // The variable of a cancelled alarm is never bound
+      result = build(vm, vm->cancelAlarm(*alarm));
     }
   };
 
@@ -65,6 +81,23 @@ public:
       result = build(vm, vm->getReferenceTime());
     }
   };
+
+private:
+  /**
+   * Bind result to a variable that is bound to unit in delay milliseconds,
+   * and return the handle of the alarm
+   */
+  static AlarmHandle setAlarm(VM vm, RichNode delay, UnstableNode& result) {
+    auto intDelay = getArgument<nativeint>(vm, delay, MOZART_STR("integer"));
+
+    if (intDelay <= 0) {
+      result = build(vm, unit);
+      return AlarmHandle();
+    } else {
+      result = Variable::build(vm, vm->getTopLevelSpace());
+      return vm->setAlarm(intDelay, RichNode(result).getStableRef(vm));
+    }
+  }
 };
 
 }
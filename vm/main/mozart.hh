@@ -39,6 +39,7 @@
 #include "graphreplicator.hh"
 #include "lstring.hh"
 #include "ozcalls.hh"
+#include "profiler.hh"
 #include "properties.hh"
 #include "runnable.hh"
 #include "sclone.hh"
@@ -172,7 +172,7 @@ void Object::getCallInfo(
     auto ooFallback = mozart::build(vm, vm->coreatoms.ooFallback);
     auto fallback = Dottable(_clazz).dot(vm, ooFallback);
 
-    auto apply = mozart::build(vm, MOZART_STR("apply"));
+    auto apply = mozart::build(vm, vm->coreatoms.apply);
     auto fallbackApply = Dottable(fallback).dot(vm, apply);
 
     _Gs[0].init(vm, self);
@@ -0,0 +1,166 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __PARSEARCH_DECL_H
+#define __PARSEARCH_DECL_H
+
+#include "mozartcore.hh"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mozart {
+
+////////////////////
+// ParallelSearch //
+////////////////////
+
+/**
+ * Search engine exploring the search tree of a script with several worker
+ * VMs, each of them running in its own OS thread.
+ *
+ * VMs do not share their stores, so the workers exchange work as paths in
+ * the search tree, i.e., as the sequences of alternatives to commit to from
+ * the root space, and recompute the corresponding spaces. Each worker
+ * explores its subtree depth-first with cloning, and gives away the
+ * shallowest of its open alternatives whenever another worker runs out of
+ * work. Solutions are delivered as paths too, so that the originating VM can
+ * recompute them with Space.new and Space.commit.
+ *
+ * For best-solution search, a worker that does not know the current best
+ * solution recomputes it in its own VM before constraining its spaces with
+ * the order. This is only correct if the script distributes the same way
+ * regardless of how much the bound has pruned.
+ */
+class ParallelSearch {
+public:
+  /** Path from the root space, alternatives are numbered from 1 */
+  typedef std::vector<nativeint> Path;
+
+  enum Kind {
+    psOne, psAll, psBest
+  };
+
+  /**
+   * Installs the script in a worker VM. Sets script to a unary procedure
+   * {Script Root} and, for best-solution search, order to a binary
+   * procedure {Order Old New}. Returns false if the script is unavailable.
+   * It is called from the worker threads, possibly concurrently.
+   */
+  typedef std::function<bool(VM vm, UnstableNode& script,
+                             UnstableNode& order)> ScriptLoader;
+
+  /**
+   * Receives a solution (an improved one for best-solution search). Calls
+   * come from the worker threads, with the engine locked.
+   */
+  typedef std::function<void(const Path& solution)> SolutionHandler;
+
+  struct Statistics {
+    Statistics(): nodes(0), failures(0), solutions(0), suspended(0),
+      recomputations(0), recomputedCommits(0), steals(0) {}
+
+    size_t nodes;
+    size_t failures;
+    size_t solutions;
+    size_t suspended;
+    size_t recomputations;
+    size_t recomputedCommits;
+    size_t steals;
+  };
+
+  /**
+   * Receives the total statistics once the search is over, from the last
+   * worker thread to exit and with the engine unlocked. This is the last
+   * call made by the engine, which must not be destroyed from the handler.
+   */
+  typedef std::function<void(const Statistics& stats,
+                             bool loadFailed)> DoneHandler;
+public:
+  ParallelSearch(Kind kind, size_t workerCount, const ScriptLoader& loader);
+
+  ParallelSearch(const ParallelSearch& from) = delete;
+
+  /** Stops and waits for the workers */
+  ~ParallelSearch();
+
+  Kind kind() {
+    return _kind;
+  }
+
+  /** Start the workers on the whole search tree */
+  void start(const SolutionHandler& onSolution, const DoneHandler& onDone);
+
+  /** Ask the workers to stop as soon as possible */
+  void stop();
+
+  /** Wait until all the workers are done */
+  void wait();
+private:
+  class Worker;
+
+  // Called by the workers, with _mutex not held
+
+  bool takeWork(Path& path);
+  void releaseWork(const Statistics& stats);
+  void giveWork(Path&& path);
+  bool isHungry();
+  bool isStopped();
+  bool publishSolution(const Path& path, size_t& bestVersion);
+  size_t getBest(Path& path);
+  void notifyLoadFailed();
+private:
+  Kind _kind;
+  size_t _workerCount;
+  ScriptLoader _loader;
+
+  SolutionHandler _onSolution;
+  DoneHandler _onDone;
+
+  std::vector<std::thread> _threads;
+
+  std::mutex _mutex;
+  std::condition_variable _workAvailable;
+
+  std::deque<Path> _pool;
+  size_t _busy;
+  size_t _hungry;
+  bool _stopped;
+  bool _loadFailed;
+  size_t _exitedWorkers;
+
+  Path _best;
+  size_t _bestVersion;
+
+  Statistics _stats;
+};
+
+}
+
+#endif // __PARSEARCH_DECL_H
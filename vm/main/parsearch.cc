@@ -0,0 +1,619 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "mozart.hh"
+#include "parsearch-decl.hh"
+
+#include <chrono>
+#include <random>
+
+namespace mozart {
+
+////////////////////////////
+// ParallelSearch::Worker //
+////////////////////////////
+
+class ParallelSearch::Worker {
+private:
+  class Environment: public VirtualMachineEnvironment {
+  public:
+    Environment(): VirtualMachineEnvironment(false),
+      _generator(std::random_device()()) {}
+
+    UUID genUUID() {
+      std::uint64_t data0 = _generator();
+      std::uint64_t data1 = _generator();
+      return UUID(data0, data1);
+    }
+  private:
+    std::mt19937_64 _generator;
+  };
+
+  enum NodeStatus {
+    nsFailed, nsSucceeded, nsAlternatives, nsSuspended
+  };
+
+  /** Choice node with alternatives that are still to be explored */
+  struct OpenNode {
+    OpenNode(const Path& path, const ProtectedNode& space,
+             nativeint alternatives, size_t version):
+      path(path), space(space), next(1), last(alternatives),
+      version(version) {}
+
+    Path path;
+    ProtectedNode space; // kept stable, cloned for every alternative but last
+    nativeint next;      // next alternative explored by this worker
+    nativeint last;      // last alternative not given away
+    size_t version;      // version of the best solution space is bound by
+  };
+public:
+  Worker(ParallelSearch& engine): engine(engine),
+    virtualMachine(environment), vm(&virtualMachine), bestVersion(0) {}
+
+  void run();
+private:
+  bool loadScript();
+
+  void explore(const Path& path);
+
+  bool nextLocalNode(Path& path, ProtectedNode& space, size_t& version);
+
+  void giveWorkAway();
+
+  void onSolution(const Path& path, const ProtectedNode& space);
+
+  void updateBest();
+
+  ProtectedNode mergeSolution(const ProtectedNode& space);
+
+  ProtectedNode recompute(const Path& path);
+
+  ProtectedNode clone(const ProtectedNode& space);
+
+  bool commit(const ProtectedNode& space, nativeint alternative);
+
+  void constrain(const ProtectedNode& space);
+
+  NodeStatus askStatus(const ProtectedNode& space, nativeint& alternatives);
+
+  void runUntilIdle();
+private:
+  ParallelSearch& engine;
+
+  Environment environment;
+  VirtualMachine virtualMachine;
+  VM vm;
+
+  ProtectedNode script;
+  ProtectedNode order;
+
+  // Best solution known by this worker (best-solution search only)
+  ProtectedNode best;
+  size_t bestVersion;
+
+  std::vector<OpenNode> openNodes;
+  Statistics stats;
+};
+
+void ParallelSearch::Worker::run() {
+  if (!loadScript()) {
+    engine.notifyLoadFailed();
+    return;
+  }
+
+  Path path;
+  while (engine.takeWork(path)) {
+    explore(path);
+    engine.releaseWork(stats);
+    stats = Statistics();
+  }
+}
+
+bool ParallelSearch::Worker::loadScript() {
+  UnstableNode scriptNode, orderNode;
+  bool ok = false;
+
+  MOZART_TRY(vm) {
+    ok = engine._loader(vm, scriptNode, orderNode);
+  } MOZART_CATCH(vm, kind, node) {
+    ok = false;
+  } MOZART_ENDTRY(vm);
+
+  if (!ok)
+    return false;
+
+  script = vm->protect(std::move(scriptNode));
+  order = vm->protect(std::move(orderNode));
+  return true;
+}
+
+void ParallelSearch::Worker::explore(const Path& root) {
+  Path path = root;
+  ProtectedNode space = recompute(path);
+  size_t version = 0;
+
+  if (!space) {
+    stats.failures++;
+    return;
+  }
+
+  while (!engine.isStopped()) {
+    if (engine.kind() == psBest) {
+      updateBest();
+      if (version != bestVersion) {
+        constrain(space);
+        version = bestVersion;
+      }
+    }
+
+    stats.nodes++;
+
+    nativeint alternatives = 0;
+    switch (askStatus(space, alternatives)) {
+      case nsFailed: {
+        stats.failures++;
+        break;
+      }
+
+      case nsSuspended: {
+        stats.suspended++;
+        break;
+      }
+
+      case nsSucceeded: {
+        stats.solutions++;
+        onSolution(path, space);
+        break;
+      }
+
+      case nsAlternatives: {
+        openNodes.emplace_back(path, space, alternatives, version);
+        break;
+      }
+    }
+
+    if (engine.isHungry())
+      giveWorkAway();
+
+    if (!nextLocalNode(path, space, version))
+      return;
+  }
+
+  openNodes.clear();
+}
+
+bool ParallelSearch::Worker::nextLocalNode(Path& path, ProtectedNode& space,
+                                           size_t& version) {
+  while (!openNodes.empty()) {
+    OpenNode& node = openNodes.back();
+    nativeint alternative = node.next++;
+
+    path = node.path;
+    path.push_back(alternative);
+    version = node.version;
+
+    if (alternative == node.last) {
+      // Last alternative of this node: no need to clone anymore
+      space = std::move(node.space);
+      openNodes.pop_back();
+    } else {
+      space = clone(node.space);
+    }
+
+    if (space && commit(space, alternative))
+      return true;
+
+    stats.failures++;
+  }
+
+  return false;
+}
+
+void ParallelSearch::Worker::giveWorkAway() {
+  // Give away the last alternative of the shallowest node, i.e., the one
+  // which this worker would explore last and is likely the biggest
+  for (auto iter = openNodes.begin(); iter != openNodes.end(); ++iter) {
+    if (iter->next <= iter->last) {
+      Path path = iter->path;
+      path.push_back(iter->last);
+      iter->last--;
+
+      if (iter->next > iter->last)
+        openNodes.erase(iter);
+
+      engine.giveWork(std::move(path));
+      return;
+    }
+  }
+}
+
+void ParallelSearch::Worker::onSolution(const Path& path,
+                                        const ProtectedNode& space) {
+  if (engine.kind() != psBest) {
+    engine.publishSolution(path, bestVersion);
+    return;
+  }
+
+  // Another worker may have found a better solution since this space was
+  // constrained, in which case the candidate must be checked again
+  ProtectedNode candidate = space;
+  while (!engine.publishSolution(path, bestVersion)) {
+    updateBest();
+
+    candidate = clone(candidate);
+    if (!candidate)
+      return;
+
+    constrain(candidate);
+
+    nativeint alternatives = 0;
+    if (askStatus(candidate, alternatives) != nsSucceeded)
+      return;
+  }
+
+  // This is the new best solution, and a leaf that can be merged right away
+  best = mergeSolution(candidate);
+}
+
+void ParallelSearch::Worker::updateBest() {
+  Path path;
+  size_t version = engine.getBest(path);
+
+  if (version == bestVersion)
+    return;
+
+  bestVersion = version;
+  best = nullptr;
+
+  ProtectedNode space = recompute(path);
+  nativeint alternatives = 0;
+  if (space && (askStatus(space, alternatives) == nsSucceeded))
+    best = mergeSolution(space);
+}
+
+ProtectedNode ParallelSearch::Worker::mergeSolution(
+  const ProtectedNode& space) {
+
+  UnstableNode value;
+  bool ok = true;
+
+  MOZART_TRY(vm) {
+    value = SpaceLike(*space).mergeSpace(vm);
+  } MOZART_CATCH(vm, kind, node) {
+    ok = false;
+  } MOZART_ENDTRY(vm);
+
+  if (!ok)
+    return nullptr;
+
+  return vm->protect(std::move(value));
+}
+
+ProtectedNode ParallelSearch::Worker::recompute(const Path& path) {
+  stats.recomputations++;
+
+  Space* space = new (vm) Space(vm, vm->getTopLevelSpace());
+  ozcalls::asyncOzCall(vm, space, *script, *space->getRootVar());
+  ProtectedNode result = vm->protect(ReifiedSpace::build(vm, space));
+
+  runUntilIdle();
+
+  for (nativeint alternative: path) {
+    nativeint alternatives = 0;
+    if (askStatus(result, alternatives) != nsAlternatives)
+      return nullptr;
+
+    if (!commit(result, alternative))
+      return nullptr;
+
+    stats.recomputedCommits++;
+  }
+
+  return result;
+}
+
+ProtectedNode ParallelSearch::Worker::clone(const ProtectedNode& space) {
+  UnstableNode result;
+  bool ok = true;
+
+  MOZART_TRY(vm) {
+    result = SpaceLike(*space).cloneSpace(vm);
+  } MOZART_CATCH(vm, kind, node) {
+    ok = false;
+  } MOZART_ENDTRY(vm);
+
+  if (!ok)
+    return nullptr;
+
+  return vm->protect(std::move(result));
+}
+
+bool ParallelSearch::Worker::commit(const ProtectedNode& space,
+                                    nativeint alternative) {
+  UnstableNode value = build(vm, alternative);
+  bool ok = true;
+
+  MOZART_TRY(vm) {
+    SpaceLike(*space).commitSpace(vm, value);
+  } MOZART_CATCH(vm, kind, node) {
+    ok = false;
+  } MOZART_ENDTRY(vm);
+
+  if (ok)
+    runUntilIdle();
+
+  return ok;
+}
+
+void ParallelSearch::Worker::constrain(const ProtectedNode& space) {
+  if (!best)
+    return;
+
+  RichNode node = *space;
+  if (!node.is<ReifiedSpace>())
+    return;
+
+  Space* s = node.as<ReifiedSpace>().getSpace();
+  if (s->isFailed())
+    return;
+
+  s->inject(vm, *order, *best);
+  runUntilIdle();
+}
+
+auto ParallelSearch::Worker::askStatus(const ProtectedNode& space,
+                                       nativeint& alternatives) -> NodeStatus {
+  using namespace patternmatching;
+
+  RichNode node = *space;
+  if (!node.is<ReifiedSpace>())
+    return nsFailed;
+
+  Space* s = node.as<ReifiedSpace>().getSpace();
+  if (s->isFailed())
+    return nsFailed;
+
+  RichNode statusVar = *s->getStatusVar();
+  if (statusVar.isTransient())
+    return nsSuspended;
+
+  NodeStatus result = nsSuspended;
+
+  MOZART_TRY(vm) {
+    if (matches(vm, statusVar, vm->coreatoms.failed))
+      result = nsFailed;
+    else if (matchesTuple(vm, statusVar, vm->coreatoms.succeeded, wildcard()))
+      result = nsSucceeded;
+    else if (matchesTuple(vm, statusVar, vm->coreatoms.alternatives,
+                          capture(alternatives)))
+      result = nsAlternatives;
+  } MOZART_CATCH(vm, kind, node) {
+    result = nsSuspended;
+  } MOZART_ENDTRY(vm);
+
+  return result;
+}
+
+void ParallelSearch::Worker::runUntilIdle() {
+  using namespace std::chrono;
+
+  auto now = [] () -> std::int64_t {
+    return duration_cast<milliseconds>(
+      system_clock::now().time_since_epoch()).count();
+  };
+
+  while (true) {
+    vm->setReferenceTime(now());
+
+    auto next = vm->run();
+
+    if (next.first == VirtualMachine::recNeverInvokeAgain)
+      return;
+
+    if (next.first == VirtualMachine::recInvokeAgainLater) {
+      if (engine.isStopped())
+        return;
+
+      std::int64_t delay = next.second - now();
+      if (delay > 0)
+        std::this_thread::sleep_for(milliseconds(delay));
+    }
+  }
+}
+
+////////////////////
+// ParallelSearch //
+////////////////////
+
+ParallelSearch::ParallelSearch(Kind kind, size_t workerCount,
+                               const ScriptLoader& loader):
+  _kind(kind), _workerCount(workerCount == 0 ? 1 : workerCount),
+  _loader(loader), _busy(0), _hungry(0), _stopped(false),
+  _loadFailed(false), _exitedWorkers(0), _bestVersion(0) {
+}
+
+ParallelSearch::~ParallelSearch() {
+  stop();
+  wait();
+}
+
+void ParallelSearch::start(const SolutionHandler& onSolution,
+                           const DoneHandler& onDone) {
+  assert(_threads.empty());
+
+  _onSolution = onSolution;
+  _onDone = onDone;
+
+  _pool.push_back(Path());
+
+  for (size_t i = 0; i < _workerCount; i++) {
+    _threads.emplace_back([this] () {
+      {
+        Worker worker(*this);
+        worker.run();
+      }
+
+      DoneHandler onDone;
+      Statistics stats;
+      bool loadFailed;
+
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (++_exitedWorkers != _workerCount)
+          return;
+
+        _pool.clear();
+        onDone = std::move(_onDone);
+        stats = _stats;
+        loadFailed = _loadFailed;
+      }
+
+      // Unlocked, so that the handler may use the engine; nothing of the
+      // engine is accessed by this thread afterwards
+      if (onDone)
+        onDone(stats, loadFailed);
+    });
+  }
+}
+
+void ParallelSearch::stop() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _stopped = true;
+  _workAvailable.notify_all();
+}
+
+void ParallelSearch::wait() {
+  for (auto& thread: _threads) {
+    if (!thread.joinable())
+      continue;
+
+    // The engine must not be released by its own handlers
+    assert(thread.get_id() != std::this_thread::get_id());
+    thread.join();
+  }
+}
+
+bool ParallelSearch::takeWork(Path& path) {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  _hungry++;
+  while (!_stopped && _pool.empty() && (_busy > 0))
+    _workAvailable.wait(lock);
+  _hungry--;
+
+  if (_stopped || _pool.empty()) {
+    // Either stopped or the whole tree has been explored
+    _workAvailable.notify_all();
+    return false;
+  }
+
+  path = std::move(_pool.front());
+  _pool.pop_front();
+  _busy++;
+
+  return true;
+}
+
+void ParallelSearch::releaseWork(const Statistics& stats) {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  _busy--;
+
+  _stats.nodes += stats.nodes;
+  _stats.failures += stats.failures;
+  _stats.solutions += stats.solutions;
+  _stats.suspended += stats.suspended;
+  _stats.recomputations += stats.recomputations;
+  _stats.recomputedCommits += stats.recomputedCommits;
+
+  if ((_busy == 0) && _pool.empty())
+    _workAvailable.notify_all();
+}
+
+void ParallelSearch::giveWork(Path&& path) {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  _pool.push_back(std::move(path));
+  _stats.steals++;
+  _workAvailable.notify_one();
+}
+
+bool ParallelSearch::isHungry() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  return (_hungry > 0) && _pool.empty();
+}
+
+bool ParallelSearch::isStopped() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  return _stopped;
+}
+
+bool ParallelSearch::publishSolution(const Path& path, size_t& bestVersion) {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  if (_stopped)
+    return true;
+
+  switch (_kind) {
+    case psOne: {
+      _stopped = true;
+      _workAvailable.notify_all();
+      break;
+    }
+
+    case psAll: {
+      break;
+    }
+
+    case psBest: {
+      if (bestVersion != _bestVersion)
+        return false;
+
+      _best = path;
+      bestVersion = ++_bestVersion;
+      break;
+    }
+  }
+
+  if (_onSolution)
+    _onSolution(path);
+
+  return true;
+}
+
+size_t ParallelSearch::getBest(Path& path) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  path = _best;
+  return _bestVersion;
+}
+
+void ParallelSearch::notifyLoadFailed() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _loadFailed = true;
+  _stopped = true;
+  _workAvailable.notify_all();
+}
+
+}
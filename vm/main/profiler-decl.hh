@@ -0,0 +1,345 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef __PROFILER_DECL_H
+#define __PROFILER_DECL_H
+
+#include "core-forward-decl.hh"
+
+#include "memmanager.hh"
+#include "opcodes.hh"
+
+#include <atomic>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mozart {
+
+class ThreadStack;
+
+///////////////////
+// ProfileStacks //
+///////////////////
+
+/**
+ * Aggregation of weighted stack samples
+ * Frames are described by the print name and debug info of their procedure.
+ */
+class ProfileStacks {
+public:
+  ProfileStacks() {}
+
+  ProfileStacks(const ProfileStacks& src) = delete;
+
+  /** Add a sample of the given thread stack
+   *  If running is not null, it is the procedure running on top of the stack.
+   *  If leaf is not empty, it is added as an innermost pseudo-frame.
+   *  Returns false if the sample was empty, in which case it is dropped.
+   */
+  bool add(VM vm, StableNode* running, ThreadStack& stack,
+           const std::string& leaf, size_t weight);
+
+  void clear();
+
+  /** Dump the samples in the collapsed-stack format
+   *  Each line is made of the frames separated by ';', outermost first,
+   *  followed by a space and the total weight of that stack.
+   */
+  void writeCollapsed(std::ostream& out);
+
+  inline
+  void gCollect(GC gc);
+
+private:
+  size_t getFrameId(VM vm, StableNode* abstraction);
+
+  size_t getFrameId(const std::string& description);
+
+  std::string describeFrame(VM vm, StableNode* abstraction);
+
+private:
+  // Cache from the start of code areas to frame ids - invalidated by GC
+  std::unordered_map<ProgramCounter, size_t> _frameCache;
+
+  // Frame descriptions, which survive GCs
+  std::unordered_map<std::string, size_t> _frameIds;
+  std::vector<std::string> _frameNames;
+
+  // Total weight per stack of frame ids, innermost first
+  std::map<std::vector<size_t>, size_t> _stacks;
+};
+
+//////////////
+// Profiler //
+//////////////
+
+/**
+ * Sampling profiler for Oz code
+ *
+ * When the profiler is running, every preemption tick requests a sample.
+ * The sample is taken by the emulator at the next point where the current
+ * thread gives control back to the VM (which is at the latest the next call,
+ * since that is where preemption is tested). It records the stack of
+ * procedures of that thread, described by their debug info.
+ *
+ * Samples are aggregated per stack, and can be dumped in the collapsed-stack
+ * format understood by flame graph tools.
+ *
+ * When the profiler is not running, the only overhead is a test of a flag
+ * each time a thread is preempted or suspended.
+ */
+class Profiler {
+public:
+  Profiler(): _running(false), _sampleRequested(false), _sampleCount(0) {}
+
+  Profiler(const Profiler& src) = delete;
+
+  bool isRunning() {
+    return _running;
+  }
+
+  void start() {
+    _running = true;
+  }
+
+  void stop() {
+    _running = false;
+    _sampleRequested = false;
+  }
+
+  void reset();
+
+  size_t getSampleCount() {
+    return _sampleCount;
+  }
+
+  /** Request a sample at the next safe point.
+   *  This is typically called from another thread than the VM thread.
+   */
+  void requestSample() {
+    if (_running)
+      _sampleRequested = true;
+  }
+
+  bool isSampleRequested() {
+    return _sampleRequested;
+  }
+
+  /** Take a sample of the given thread stack */
+  void sample(VM vm, ThreadStack& stack);
+
+  /** Dump the samples in the collapsed-stack format */
+  void writeCollapsed(std::ostream& out) {
+    _stacks.writeCollapsed(out);
+  }
+
+  inline
+  void gCollect(GC gc);
+
+private:
+  std::atomic<bool> _running;
+  std::atomic<bool> _sampleRequested; // set by requestSample(), any thread
+  size_t _sampleCount;
+
+  ProfileStacks _stacks;
+};
+
+////////////////////////
+// AllocationProfiler //
+////////////////////////
+
+struct AllocationStatistics {
+  AllocationStatistics(): objects(0), bytes(0) {}
+
+  size_t objects;
+  size_t bytes;
+};
+
+/**
+ * Allocation profiler
+ *
+ * When it is running, the allocation profiler counts the objects and bytes
+ * allocated for nodes of each type, and for the internals of the VM that are
+ * not nodes (static arrays and list nodes).
+ *
+ * Bytes are measured with the counter of blocks served by the memory
+ * manager, so that blocks reused from free lists and big blocks are
+ * included. Each allocation is measured in a scope, and scopes nest: the
+ * bytes of a node built, or of a static array allocated, by the constructor
+ * of another node are counted only once, for the inner allocation.
+ *
+ * In addition, one allocation every sampleInterval bytes (on average) is
+ * attributed to the stack of the current thread, with the type of the
+ * allocated node as innermost pseudo-frame. The innermost real frame is the
+ * procedure that is running when the allocation is made.
+ *
+ * Allocations made by the GC itself are not counted. While the profiler is
+ * running, the GC gathers a census of the live nodes per type, which is
+ * available through its statistics.
+ */
+class AllocationProfiler {
+public:
+  static constexpr size_t DefaultSampleInterval = 512 * 1024;
+public:
+  explicit AllocationProfiler(MemoryManager& memoryManager):
+    _memoryManager(memoryManager), _claimed(0),
+    _enabled(false), _suspended(false), _active(false),
+    _sampleInterval(DefaultSampleInterval),
+    _untilNextSample(DefaultSampleInterval) {}
+
+  AllocationProfiler(const AllocationProfiler& src) = delete;
+
+  /** Is the profiler enabled (even if temporarily suspended)? */
+  bool isEnabled() {
+    return _enabled;
+  }
+
+  /** Does the profiler currently record allocations? */
+  bool isActive() {
+    return _active;
+  }
+
+  void start() {
+    _enabled = true;
+    updateActive();
+  }
+
+  void stop() {
+    _enabled = false;
+    updateActive();
+  }
+
+  /** Temporarily stop recording allocations, e.g., during GC */
+  void suspend() {
+    _suspended = true;
+    updateActive();
+  }
+
+  void resume() {
+    _suspended = false;
+    updateActive();
+  }
+
+  void reset();
+
+  size_t& sampleInterval() {
+    return _sampleInterval;
+  }
+
+  /** Open a scope around one allocation, and return its token */
+  size_t enterScope() {
+    return _memoryManager.getBytesServed() - _claimed;
+  }
+
+  /** Close a scope, and return the bytes allocated in it
+   *  The bytes of the scopes nested in this one are not included.
+   */
+  size_t leaveScope(size_t scope) {
+    size_t bytes = (_memoryManager.getBytesServed() - _claimed) - scope;
+    _claimed += bytes;
+    return bytes;
+  }
+
+  void recordNode(VM vm, const TypeInfo* type, size_t bytes) {
+    AllocationStatistics& stats = _perType[type];
+    stats.objects++;
+    stats.bytes += bytes;
+    countForSample(vm, type, bytes);
+  }
+
+  void recordStaticArray(VM vm, size_t bytes) {
+    _staticArrays.objects++;
+    _staticArrays.bytes += bytes;
+    countForSample(vm, nullptr, bytes);
+  }
+
+  void recordListNode(VM vm, size_t bytes) {
+    _listNodes.objects++;
+    _listNodes.bytes += bytes;
+    countForSample(vm, nullptr, bytes);
+  }
+
+  const std::map<const TypeInfo*, AllocationStatistics>& getPerType() {
+    return _perType;
+  }
+
+  const AllocationStatistics& getStaticArrays() {
+    return _staticArrays;
+  }
+
+  const AllocationStatistics& getListNodes() {
+    return _listNodes;
+  }
+
+  /** Dump the sampled allocation sites in the collapsed-stack format
+   *  The weight of each stack is an estimate of the bytes allocated there.
+   */
+  void writeCollapsed(std::ostream& out) {
+    _stacks.writeCollapsed(out);
+  }
+
+  inline
+  void gCollect(GC gc);
+
+private:
+  void updateActive() {
+    _active = _enabled && !_suspended;
+  }
+
+  void countForSample(VM vm, const TypeInfo* type, size_t bytes) {
+    if (bytes < _untilNextSample)
+      _untilNextSample -= bytes;
+    else
+      takeSample(vm, type);
+  }
+
+  void takeSample(VM vm, const TypeInfo* type);
+
+private:
+  MemoryManager& _memoryManager;
+
+  // Bytes attributed by closed scopes (modulo the size of size_t)
+  size_t _claimed;
+
+  bool _enabled;
+  bool _suspended;
+  bool _active;
+
+  size_t _sampleInterval;
+  size_t _untilNextSample;
+
+  std::map<const TypeInfo*, AllocationStatistics> _perType;
+  AllocationStatistics _staticArrays;
+  AllocationStatistics _listNodes;
+
+  ProfileStacks _stacks;
+};
+
+}
+
+#endif // __PROFILER_DECL_H
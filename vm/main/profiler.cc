@@ -0,0 +1,236 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "mozart.hh"
+
+#include <algorithm>
+#include <sstream>
+
+namespace mozart {
+
+///////////////////
+// ProfileStacks //
+///////////////////
+
+bool ProfileStacks::add(VM vm, StableNode* running, ThreadStack& stack,
+                        const std::string& leaf, size_t weight) {
+  std::vector<size_t> frames;
+
+  if (!leaf.empty())
+    frames.push_back(getFrameId(leaf));
+
+  if (running != nullptr)
+    frames.push_back(getFrameId(vm, running));
+
+  for (auto iter = stack.begin(); iter != stack.end(); ++iter) {
+    StackEntry& entry = *iter;
+
+    if (!entry.isExceptionHandler())
+      frames.push_back(getFrameId(vm, entry.abstraction));
+  }
+
+  if (frames.empty())
+    return false;
+
+  _stacks[frames] += weight;
+  return true;
+}
+
+void ProfileStacks::clear() {
+  _frameCache.clear();
+  _frameIds.clear();
+  _frameNames.clear();
+  _stacks.clear();
+}
+
+size_t ProfileStacks::getFrameId(VM vm, StableNode* abstraction) {
+  ProgramCounter start = nullptr;
+
+  MOZART_TRY(vm) {
+    size_t arity = 0;
+    size_t Xcount = 0;
+    StaticArray<StableNode> Gs;
+    StaticArray<StableNode> Ks;
+
+    Callable(*abstraction).getCallInfo(vm, arity, start, Xcount, Gs, Ks);
+  } MOZART_CATCH(vm, kind, node) {
+    start = nullptr;
+  } MOZART_ENDTRY(vm);
+
+  if (start != nullptr) {
+    auto cached = _frameCache.find(start);
+    if (cached != _frameCache.end())
+      return cached->second;
+  }
+
+  size_t result = getFrameId(describeFrame(vm, abstraction));
+
+  if (start != nullptr)
+    _frameCache[start] = result;
+
+  return result;
+}
+
+size_t ProfileStacks::getFrameId(const std::string& description) {
+  auto known = _frameIds.find(description);
+  if (known != _frameIds.end())
+    return known->second;
+
+  size_t result = _frameNames.size();
+  _frameIds[description] = result;
+  _frameNames.push_back(description);
+
+  return result;
+}
+
+std::string ProfileStacks::describeFrame(VM vm, StableNode* abstraction) {
+  atom_t printName = vm->coreatoms.empty;
+  atom_t file = vm->coreatoms.empty;
+  nativeint line = -1;
+  nativeint column = -1;
+
+  MOZART_TRY(vm) {
+    UnstableNode debugData;
+    Callable(*abstraction).getDebugInfo(vm, printName, debugData);
+
+    Dottable dotDebugData(debugData);
+
+    UnstableNode fileNode = dotDebugData.condSelect(
+      vm, vm->coreatoms.file, vm->coreatoms.empty);
+    if (RichNode(fileNode).is<Atom>())
+      file = RichNode(fileNode).as<Atom>().value();
+
+    UnstableNode lineNode = dotDebugData.condSelect(
+      vm, vm->coreatoms.line, -1);
+    if (RichNode(lineNode).is<SmallInt>())
+      line = RichNode(lineNode).as<SmallInt>().value();
+
+    UnstableNode columnNode = dotDebugData.condSelect(
+      vm, vm->coreatoms.column, -1);
+    if (RichNode(columnNode).is<SmallInt>())
+      column = RichNode(columnNode).as<SmallInt>().value();
+  } MOZART_CATCH(vm, kind, node) {
+    // Keep whatever we could get
+  } MOZART_ENDTRY(vm);
+
+  std::stringstream out;
+
+  if (printName.length() == 0)
+    out << "<anonymous>";
+  else
+    out.write(printName.contents(), printName.length());
+
+  if (file.length() != 0) {
+    out << " (";
+    out.write(file.contents(), file.length());
+    if (line >= 0) {
+      out << ":" << line;
+      if (column >= 0)
+        out << ":" << column;
+    }
+    out << ")";
+  }
+
+  // ';' separates frames and '\n' separates stacks in the collapsed format
+  std::string result = out.str();
+  std::replace(result.begin(), result.end(), ';', ',');
+  std::replace(result.begin(), result.end(), '\n', ' ');
+
+  return result;
+}
+
+void ProfileStacks::writeCollapsed(std::ostream& out) {
+  for (auto& stack: _stacks) {
+    auto& frames = stack.first;
+
+    for (auto iter = frames.rbegin(); iter != frames.rend(); ++iter) {
+      if (iter != frames.rbegin())
+        out << ';';
+      out << _frameNames[*iter];
+    }
+
+    out << ' ' << stack.second << '\n';
+  }
+}
+
+//////////////
+// Profiler //
+//////////////
+
+void Profiler::reset() {
+  _sampleRequested = false;
+  _sampleCount = 0;
+  _stacks.clear();
+}
+
+void Profiler::sample(VM vm, ThreadStack& stack) {
+  _sampleRequested = false;
+
+  if (!_running)
+    return;
+
+  if (_stacks.add(vm, nullptr, stack, std::string(), 1))
+    _sampleCount++;
+}
+
+////////////////////////
+// AllocationProfiler //
+////////////////////////
+
+constexpr size_t AllocationProfiler::DefaultSampleInterval;
+
+void AllocationProfiler::reset() {
+  _untilNextSample = _sampleInterval;
+  _perType.clear();
+  _staticArrays = AllocationStatistics();
+  _listNodes = AllocationStatistics();
+  _stacks.clear();
+}
+
+void AllocationProfiler::takeSample(VM vm, const TypeInfo* type) {
+  _untilNextSample = std::max(_sampleInterval, (size_t) 1);
+
+  Runnable* thread = vm->getCurrentThread();
+  if (thread == nullptr)
+    return;
+
+  ThreadStack* stack = thread->getStackForProfiling();
+  if (stack == nullptr)
+    return;
+
+  // Describing the frames allocates, which must not be recorded
+  suspend();
+
+  std::string leaf = "[";
+  leaf += (type == nullptr) ? "internal" : type->getName();
+  leaf += "]";
+
+  _stacks.add(vm, thread->getRunningAbstractionForProfiling(), *stack, leaf,
+              _sampleInterval);
+
+  resume();
+}
+
+}
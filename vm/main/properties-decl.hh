@@ -164,6 +164,9 @@ public:
     nativeint errorsDepth;
     nativeint errorsWidth;
     nativeint errorsThread;
+
+    // Spaces
+    nativeint spacesRecomputation;
   } config;
 };
 
@@ -50,6 +50,10 @@ void PropertyRegistry::initConfig(VM vm) {
   config.errorsDepth = 10;
   config.errorsWidth = 20;
   config.errorsThread = 40;
+
+  // Spaces
+
+  config.spacesRecomputation = 1;
 }
 
 void PropertyRegistry::registerPredefined(VM vm) {
@@ -60,6 +64,152 @@ void PropertyRegistry::registerPredefined(VM vm) {
       return vm->getThreadPool().getRunnableCount();
     });
 
+  // GC
+
+  auto& gc = vm->getGarbageCollector();
+  auto& gcStats = gc.getStatistics();
+
+  registerReadWriteProp(vm, MOZART_STR("gc.log"), gc.logEnabled());
+  registerReadWriteProp(vm, MOZART_STR("gc.types.enabled"),
+                        gc.perTypeEnabled());
+
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.count"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.collections;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.pause.last"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.lastPause;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.pause.max"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.maxPause;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.pause.total"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.totalPause;
+    });
+  registerProp(vm, MOZART_STR("gc.pause.histogram"),
+    [&gcStats] (VM vm) -> UnstableNode {
+      OzListBuilder result(vm);
+      for (size_t i = 0; i < GCStatistics::PauseHistogramSize; i++)
+        result.push_back(vm, (nativeint) gcStats.pauseHistogram[i]);
+      return result.get(vm);
+    },
+    nullptr);
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.before"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.lastBytesBefore;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.after"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.lastBytesAfter;
+    });
+  registerReadOnlyProp<double>(vm, MOZART_STR("gc.survival"),
+    [&gcStats] (VM vm) -> double {
+      if (gcStats.lastBytesBefore == 0)
+        return 0.0;
+      return (double) gcStats.lastBytesAfter / gcStats.lastBytesBefore;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.nodes"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.lastObjectsCopied;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.threads"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.lastThreads;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.spaces"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.lastSpaces;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.atoms"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.lastAtoms;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.total.copied"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.totalBytesCopied;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.total.reclaimed"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.totalBytesReclaimed;
+    });
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("gc.total.nodes"),
+    [&gcStats] (VM vm) -> nativeint {
+      return gcStats.totalObjectsCopied;
+    });
+  registerProp(vm, MOZART_STR("gc.types"),
+    [&gcStats] (VM vm) -> UnstableNode {
+      OzListBuilder result(vm);
+      for (auto& item: gcStats.lastPerType) {
+        auto& name = item.first->getName();
+        result.push_back(vm, buildTuple(
+          vm, MOZART_STR("type"), vm->getAtom(name.size(), name.c_str()),
+          item.second.objects, item.second.bytes));
+      }
+      return result.get(vm);
+    },
+    nullptr);
+
+  // Profiler
+
+  registerReadWriteProp<bool>(vm, MOZART_STR("profiler.running"),
+    [] (VM vm) -> bool {
+      return vm->getProfiler().isRunning();
+    },
+    [] (VM vm, bool value) {
+      if (value)
+        vm->getProfiler().start();
+      else
+        vm->getProfiler().stop();
+    });
+
+  registerReadOnlyProp<nativeint>(vm, MOZART_STR("profiler.samples"),
+    [] (VM vm) -> nativeint {
+      return vm->getProfiler().getSampleCount();
+    });
+
+  auto& allocationProfiler = vm->getAllocationProfiler();
+
+  registerReadWriteProp<bool>(vm, MOZART_STR("profiler.alloc.running"),
+    [] (VM vm) -> bool {
+      return vm->getAllocationProfiler().isEnabled();
+    },
+    [] (VM vm, bool value) {
+      if (value)
+        vm->getAllocationProfiler().start();
+      else
+        vm->getAllocationProfiler().stop();
+    });
+
+  registerReadWriteProp(vm, MOZART_STR("profiler.alloc.interval"),
+                        allocationProfiler.sampleInterval());
+
+  registerProp(vm, MOZART_STR("profiler.alloc.types"),
+    [&allocationProfiler] (VM vm) -> UnstableNode {
+      OzListBuilder result(vm);
+
+      auto addEntry = [vm, &result] (atom_t name,
+                                     const AllocationStatistics& stats) {
+        result.push_back(vm, buildTuple(vm, MOZART_STR("type"), name,
+                                        stats.objects, stats.bytes));
+      };
+
+      for (auto& item: allocationProfiler.getPerType()) {
+        auto& name = item.first->getName();
+        addEntry(vm->getAtom(name.size(), name.c_str()), item.second);
+      }
+
+      addEntry(vm->getAtom(MOZART_STR("StaticArray")),
+               allocationProfiler.getStaticArrays());
+      addEntry(vm->getAtom(MOZART_STR("VMAllocatedList")),
+               allocationProfiler.getListNodes());
+
+      return result.get(vm);
+    },
+    nullptr);
+
   // Print
 
   registerReadWriteProp(vm, MOZART_STR("print.depth"), config.printDepth);
@@ -81,6 +231,11 @@ void PropertyRegistry::registerPredefined(VM vm) {
   registerReadWriteProp(vm, MOZART_STR("errors.width"), config.errorsWidth);
   registerReadWriteProp(vm, MOZART_STR("errors.thread"), config.errorsThread);
 
+  // Spaces
+
+  registerReadWriteProp(vm, MOZART_STR("spaces.recomputation"),
+                        config.spacesRecomputation);
+
   // Limits
 
   registerConstantProp(vm, MOZART_STR("limits.int.min"),
@@ -43,7 +43,7 @@ namespace mozart {
 class ReflectiveEntity: public DataType<ReflectiveEntity> {
 public:
   static atom_t getTypeAtom(VM vm) {
-    return vm->getAtom(MOZART_STR("reflective"));
+    return vm->coreatoms.typeReflective;
   }
 
   inline
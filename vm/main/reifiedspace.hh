@@ -128,6 +128,9 @@ UnstableNode ReifiedSpace::askSpace(RichNode self, VM vm) {
   if (!space->isAdmissible(vm))
     raise(vm, vm->coreatoms.spaceAdmissible, self);
 
+  if (space->isLazy())
+    space = space->materialize(vm);
+
   RichNode statusVar = *space->getStatusVar();
 
   if (matchesTuple(vm, statusVar, vm->coreatoms.succeeded, wildcard())) {
@@ -143,6 +146,9 @@ UnstableNode ReifiedSpace::askVerboseSpace(RichNode self, VM vm) {
   if (!space->isAdmissible(vm))
     raise(vm, vm->coreatoms.spaceAdmissible, self);
 
+  if (space->isLazy())
+    space = space->materialize(vm);
+
   if (space->isBlocked() && !space->isStable()) {
     return buildTuple(vm, vm->coreatoms.suspended, *space->getStatusVar());
   } else {
@@ -162,6 +168,13 @@ UnstableNode ReifiedSpace::mergeSpace(RichNode self, VM vm) {
     raise(vm, MOZART_STR("spaceMergeNotImplemented"));
   }
 
+  if (space->isLazy())
+    space = space->materialize(vm);
+
+  // The commits of a lazy clone must be replayed before merging
+  if (space->isReplaying())
+    waitFor(vm, *space->getStatusVar());
+
   // Update status var
   RichNode statusVar = *space->getStatusVar();
   if (statusVar.isTransient()) {
@@ -190,6 +203,13 @@ void ReifiedSpace::commitSpace(RichNode self, VM vm, RichNode value) {
   if (!space->isAdmissible(vm))
     raise(vm, vm->coreatoms.spaceAdmissible);
 
+  if (space->isLazy())
+    space = space->materialize(vm);
+
+  // The commits of a lazy clone must be replayed before committing again
+  if (space->isReplaying())
+    waitFor(vm, *space->getStatusVar());
+
   if (!space->hasDistributor())
     raise(vm, vm->coreatoms.spaceNoChoice, self);
 
@@ -212,11 +232,21 @@ UnstableNode ReifiedSpace::cloneSpace(RichNode self, VM vm) {
   if (!space->isAdmissible(vm))
     raise(vm, vm->coreatoms.spaceAdmissible);
 
-  RichNode statusVar = *space->getStatusVar();
-  if (statusVar.isTransient())
-    waitFor(vm, statusVar);
+  if (!space->isLazy()) {
+    RichNode statusVar = *space->getStatusVar();
+    if (statusVar.isTransient())
+      waitFor(vm, statusVar);
+  }
+
+  // Every k-th clone is a copy, the others are recomputed on demand
+  nativeint distance = vm->getPropertyRegistry().config.spacesRecomputation;
+
+  Space* copy;
+  if ((distance > 1) || space->isLazy())
+    copy = space->cloneWithRecomputation(vm, distance);
+  else
+    copy = space->clone(vm);
 
-  Space* copy = space->clone(vm);
   return ReifiedSpace::build(vm, copy);
 }
 
@@ -33,6 +33,8 @@
 
 namespace mozart {
 
+class ThreadStack;
+
 // This enum is often used for indexing in arrays
 // tpCount reflects the number of valid ThreadPriority's
 // And you probably don't want to add or remove existing ThreadPriority's
@@ -145,6 +147,16 @@ public:
     return _intermediateState;
   }
 
+  /** Stack of Oz frames of this runnable, if it has any (for profiling) */
+  virtual ThreadStack* getStackForProfiling() {
+    return nullptr;
+  }
+
+  /** Procedure running on top of that stack, if any (for profiling) */
+  virtual StableNode* getRunningAbstractionForProfiling() {
+    return nullptr;
+  }
+
   virtual void beforeGR() {}
   virtual void afterGR() {}
 
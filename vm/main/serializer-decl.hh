@@ -28,8 +28,12 @@
 #include "mozartcore-decl.hh"
 
 #include "memmanlist.hh"
+#include "chunkedbuffer.hh"
 
 #include <cassert>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
 
 namespace mozart {
 
@@ -48,6 +52,7 @@ public:
 
 private:
   friend class Serializer;
+  friend class StreamSerializer;
 
   MemoryManager& secondMM;
   MemManagedList<RichNode> todoFrom;
@@ -95,7 +100,7 @@ private:
 class Serializer: public DataType<Serializer> {
 public:
   static atom_t getTypeAtom(VM vm) {
-    return vm->getAtom(MOZART_STR("serializer"));
+    return vm->coreatoms.typeSerializer;
   }
 
   inline
@@ -115,6 +120,298 @@ private:
 #include "Serializer-implem-decl-after.hh"
 #endif
 
+///////////////////
+// Binary pickle //
+///////////////////
+
+/**
+ * Binary pickles, as written by StreamSerializer, are laid out as:
+ *   magic            the 4 bytes of pickleMagic, whose last one is the
+ *                    version of the format
+ *   value            the serialized value
+ *   node*            one record for each node introduced by pvNewNode
+ *
+ * Nodes are numbered from 0 in the order in which pvNewNode introduces them,
+ * and their records follow in the same order. The pickle ends when every
+ * node introduced so far has its record.
+ *
+ * A value is a PickleValueTag followed by:
+ *   pvNewNode        nothing, this is the next node
+ *   pvRef            varint index of a node already introduced
+ *   pvInt            zigzag varint
+ *   pvFloat          the 8 bytes of the IEEE double, little-endian first
+ *   pvAtom           varint index in the atom table
+ *   pvNewAtom        varint length, UTF-8 contents; appended to the table
+ *   pvTrue, pvFalse, pvUnit
+ *   pvString         varint length, UTF-8 contents
+ *   pvByteString     varint length, contents
+ *   pvTuple          varint width, label value, width values
+ *   pvArity          varint index in the arity table
+ *   pvNewArity       varint width, label value, width feature values;
+ *                    appended to the table
+ *
+ * A node record is a PickleNodeKind followed by:
+ *   pnCons           head value, tail value
+ *   pnTuple          varint width, label value, width values
+ *   pnRecord         arity value, varint width, width values
+ *   pnOther          the value returned by the serialize() hook of the node,
+ *                    in which the nodes given to SerializationCallback::copy()
+ *                    stand for their sources
+ *
+ * Arities are values rather than nodes, so that a reader can build every
+ * record as soon as it reads it. Varints are unsigned LEB128.
+ *
+ * Values keep their canonical form: labels are literals, the labels of
+ * pvTuple are atoms, records whose features are 1 to n are tuples, and
+ * '|'/2 tuples are conses. The reader rejects the other forms, except for
+ * '|'/2 in a pvTuple, which it reads as a cons.
+ */
+
+const char pickleMagic[4] = { 'O', 'z', 'P', '\x01' };
+
+enum PickleValueTag: unsigned char {
+  pvNewNode, pvRef, pvInt, pvFloat, pvAtom, pvNewAtom,
+  pvTrue, pvFalse, pvUnit, pvString, pvByteString, pvTuple,
+  pvArity, pvNewArity,
+  pvCount
+};
+
+enum PickleNodeKind: unsigned char {
+  pnCons, pnTuple, pnRecord, pnOther,
+  pnCount
+};
+
+///////////////////////
+// SerializationSink //
+///////////////////////
+
+/**
+ * Destination of the output of a StreamSerializer
+ */
+class SerializationSink {
+public:
+  /**
+   * Consume the bytes in buffer
+   * The serializer clears the buffer afterwards.
+   */
+  virtual void write(VM vm, ChunkedBuffer& buffer) = 0;
+};
+
+//////////////////////
+// StreamSerializer //
+//////////////////////
+
+/**
+ * Serializer that writes a binary pickle of a value to a ChunkedBuffer
+ *
+ * Unlike Serializer, it does not modify the graph and builds nothing on the
+ * heap for records, tuples, lists, strings and scalars. If it is given a
+ * sink, the output is handed to it every flushThreshold bytes, so that the
+ * memory used does not depend on the size of the pickle.
+ *
+ * The value must first go through checkSerializable(), which may raise. Then
+ * serialize() never raises, and must not be interrupted by a garbage
+ * collection.
+ */
+class StreamSerializer {
+public:
+  static constexpr size_t flushThreshold =
+    ChunkedBuffer::retainedChunks * ChunkedBuffer::chunkSize;
+
+public:
+  StreamSerializer(VM vm, ChunkedBuffer& output,
+                   SerializationSink* sink = nullptr):
+    vm(vm), _output(output), _sink(sink) {}
+
+  /**
+   * Wait for the transients in value, and raise on the entities that the
+   * Unpickler cannot rebuild, e.g., cells and ports. Builtins call this before
+   * they write anything.
+   */
+  static void checkSerializable(VM vm, RichNode value);
+
+  /** Write the pickle of value, then give what is left to the sink */
+  void serialize(RichNode value);
+
+private:
+  void writeValue(RichNode value);
+  void writeArity(RichNode arity);
+  void writeNode(RichNode node);
+  void writeHookValue(StableNode& value);
+  void writeHookTree(RichNode tree);
+
+  void writeAtom(atom_t atom);
+
+  void writeByte(unsigned char value) {
+    _output.push_back((char) value);
+  }
+
+  void writeVarUInt(std::uint64_t value) {
+    char bytes[10];
+    size_t count = 0;
+    while (value >= 0x80) {
+      bytes[count++] = (char) (value | 0x80);
+      value >>= 7;
+    }
+    bytes[count++] = (char) value;
+    _output.append(bytes, count);
+  }
+
+  void writeVarInt(std::int64_t value) {
+    writeVarUInt(((std::uint64_t) value << 1) ^ (std::uint64_t) (value >> 63));
+  }
+
+private:
+  VM vm;
+  ChunkedBuffer& _output;
+  SerializationSink* _sink;
+
+  std::unordered_map<StableNode*, size_t> _nodes;
+  std::deque<StableNode*> _todo;
+  std::unordered_map<const nchar*, size_t> _atoms;
+  std::unordered_map<StableNode*, size_t> _arities;
+
+  // Nodes of the hook result being written -> what they stand for
+  std::unordered_map<StableNode*, StableNode*> _placeholders;
+};
+
+
+////////////////////
+// UnpicklerTable //
+////////////////////
+
+/**
+ * Growable array of nodes, allocated in the memory of the VM
+ */
+class UnpicklerTable {
+public:
+  UnpicklerTable(): _array(nullptr), _capacity(0), _size(0) {}
+
+  inline
+  UnpicklerTable(VM vm, GR gr, UnpicklerTable& from);
+
+  size_t size() {
+    return _size;
+  }
+
+  UnstableNode& operator[](size_t index) {
+    return _array[index];
+  }
+
+  UnstableNode& back() {
+    return _array[_size-1];
+  }
+
+  inline
+  void push_back(VM vm, UnstableNode&& node);
+
+  /** Remove the count first nodes */
+  inline
+  void drop_front(VM vm, size_t count);
+private:
+  StaticArray<UnstableNode> _array;
+  size_t _capacity;
+  size_t _size;
+};
+
+///////////////
+// Unpickler //
+///////////////
+
+enum UnpicklerStatus {
+  usNeedInput,  // all the input has been consumed
+  usYield,      // the quota of nodes has been reached
+  usDone,       // the result has been bound
+  usFailed      // the input is not a valid pickle
+};
+
+#ifndef MOZART_GENERATOR
+#include "Unpickler-implem-decl.hh"
+#endif
+
+/**
+ * Incremental reader of the binary pickles written by StreamSerializer
+ *
+ * The input is given as ByteStrings, cut anywhere, and every call to
+ * resume() decodes the nodes whose records are complete, up to a quota. The
+ * nodes that are referenced before their record is read are bound to
+ * variables until then, and the result variable is bound once the last
+ * record is read.
+ */
+class Unpickler: public DataType<Unpickler>, public WithHome {
+public:
+  static atom_t getTypeAtom(VM vm) {
+    return vm->coreatoms.typeUnpickler;
+  }
+
+  inline
+  Unpickler(VM vm, RichNode result);
+
+  inline
+  Unpickler(VM vm, GR gr, Unpickler& from);
+
+public:
+  /** Append a ByteString to the input */
+  inline
+  void feed(VM vm, RichNode chunk);
+
+  /** Decode the available input, and at most maxNodes node records */
+  UnpicklerStatus resume(VM vm, size_t maxNodes);
+
+  /** The input that follows the pickle, once the status is usDone */
+  UnstableNode getRest(VM vm);
+
+  /** The reason of the failure, once the status is usFailed */
+  UnstableNode getError(VM vm) {
+    return { vm, _error };
+  }
+
+private:
+  enum Stage {
+    stMagic, stRoot, stNodes, stDone, stFailed
+  };
+
+  class Cursor;
+  struct NewEntries;
+
+  bool scanIndex(Cursor& cursor, size_t tableSize, size_t newEntries);
+  bool scanAtomTag(Cursor& cursor);
+  bool scanValue(Cursor& cursor, size_t depth, NewEntries& entries);
+  bool scanNode(Cursor& cursor);
+
+  template <class T>
+  void decodeValue(VM vm, Cursor& cursor, T& dest);
+  bool decodeNode(VM vm, Cursor& cursor, UnstableNode& dest);
+  bool rebuildFromHook(VM vm, RichNode tree, UnstableNode& dest);
+  bool checkRecords(VM vm);
+
+  void fail(VM vm, const nchar* reason);
+
+private:
+  Stage _stage;
+
+  UnstableNode _result;
+  UnstableNode _root;
+  UnstableNode _error;
+
+  UnpicklerTable _nodes;
+  UnpicklerTable _atoms;
+  UnpicklerTable _arities;
+  size_t _readNodes;
+
+  // ByteStrings not consumed yet; the first one from _inputOffset
+  UnpicklerTable _input;
+  size_t _inputOffset;
+  size_t _inputSize;
+
+  // Size of the input needed by the next item, as far as known
+  size_t _wanted;
+};
+
+#ifndef MOZART_GENERATOR
+#include "Unpickler-implem-decl-after.hh"
+#endif
+
 }
 
 #endif // __SERIALIZER_DECL_H
@@ -24,7 +24,11 @@
 
 #include "mozart.hh"
 
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <unordered_set>
+#include <vector>
 
 namespace mozart {
 
@@ -92,4 +96,1191 @@ UnstableNode Serializer::doSerialize(VM vm, RichNode todo) {
   return UnstableNode(vm, done);
 }
 
+
+//////////////////////
+// StreamSerializer //
+//////////////////////
+
+namespace {
+  /** Whether the Unpickler rebuilds the result of the serialize() hook */
+  bool hasPickleHook(RichNode node) {
+    return node.is<NamedName>() || node.is<UniqueName>() ||
+      node.is<BuiltinProcedure>() || node.is<Chunk>() ||
+      node.is<Abstraction>() || node.is<CodeArea>() ||
+      node.is<PatMatCapture>() || node.is<PatMatConjunction>() ||
+      node.is<PatMatOpenRecord>();
+  }
+}
+
+void StreamSerializer::checkSerializable(VM vm, RichNode value) {
+  RichNode culprit;
+  bool found = false;
+
+  vm->getSecondMemoryManager().init();
+
+  // Scoped so that the containers are destroyed before raising
+  {
+    std::unordered_set<StableNode*> visited;
+    std::vector<RichNode> todo;
+    todo.push_back(value);
+
+    while (!todo.empty() && !found) {
+      RichNode node = todo.back();
+      todo.pop_back();
+
+      if (node.is<SmallInt>() || node.is<Atom>() || node.is<Boolean>() ||
+          node.is<Unit>() || node.is<Float>() || node.is<String>() ||
+          node.is<ByteString>())
+        continue;
+
+      if (node.isTransient()) {
+        culprit = node;
+        found = true;
+        break;
+      }
+
+      if (!visited.insert(node.getStableRef(vm)).second)
+        continue;
+
+      if (node.is<Cons>()) {
+        auto cons = node.as<Cons>();
+        todo.push_back(*cons.getHead());
+        todo.push_back(*cons.getTail());
+      } else if (node.is<Tuple>()) {
+        auto tuple = node.as<Tuple>();
+        auto elements = tuple.getElementsArray();
+        todo.push_back(*tuple.getLabel());
+        for (size_t i = 0; i < tuple.getWidth(); i++)
+          todo.push_back(elements[i]);
+      } else if (node.is<Record>()) {
+        auto record = node.as<Record>();
+        auto elements = record.getElementsArray();
+        todo.push_back(*record.getArity());
+        for (size_t i = 0; i < record.getWidth(); i++)
+          todo.push_back(elements[i]);
+      } else if (node.is<Arity>()) {
+        auto arity = node.as<Arity>();
+        auto elements = arity.getElementsArray();
+        todo.push_back(*arity.getLabel());
+        for (size_t i = 0; i < arity.getWidth(); i++)
+          todo.push_back(elements[i]);
+      } else if (hasPickleHook(node)) {
+        // The hook gives the nodes it refers to through the callback
+        SerializationCallback cb(vm);
+        node.type()->serialize(vm, &cb, node);
+
+        while (!cb.todoFrom.empty()) {
+          todo.push_back(cb.todoFrom.pop_front(cb.secondMM));
+          cb.todoTo.pop_front(cb.secondMM);
+        }
+      } else {
+        culprit = node;
+        found = true;
+      }
+    }
+  }
+
+  if (found) {
+    if (culprit.isTransient())
+      waitFor(vm, culprit);
+
+    raiseError(vm, MOZART_STR("serialize"), MOZART_STR("unsupportedValue"),
+               culprit);
+  }
+}
+
+void StreamSerializer::serialize(RichNode value) {
+  vm->getSecondMemoryManager().init();
+
+  _output.append(pickleMagic, sizeof(pickleMagic));
+  writeValue(value);
+
+  while (!_todo.empty()) {
+    StableNode* node = _todo.front();
+    _todo.pop_front();
+    writeNode(*node);
+
+    if ((_sink != nullptr) && (_output.size() >= flushThreshold)) {
+      _sink->write(vm, _output);
+      _output.clear();
+    }
+  }
+
+  if (_sink != nullptr) {
+    _sink->write(vm, _output);
+    _output.clear();
+  }
+}
+
+void StreamSerializer::writeValue(RichNode value) {
+  if (value.is<SmallInt>()) {
+    writeByte(pvInt);
+    writeVarInt(value.as<SmallInt>().value());
+  } else if (value.is<Atom>()) {
+    writeAtom(value.as<Atom>().value());
+  } else if (value.is<Boolean>()) {
+    writeByte(value.as<Boolean>().value() ? pvTrue : pvFalse);
+  } else if (value.is<Unit>()) {
+    writeByte(pvUnit);
+  } else if (value.is<Float>()) {
+    double doubleValue = value.as<Float>().value();
+    std::uint64_t bits;
+    std::memcpy(&bits, &doubleValue, sizeof(bits));
+
+    char bytes[8];
+    for (size_t i = 0; i < 8; i++)
+      bytes[i] = (char) (bits >> (8*i));
+
+    writeByte(pvFloat);
+    _output.append(bytes, 8);
+  } else if (value.is<String>()) {
+    auto& str = value.as<String>().value(vm);
+    writeByte(pvString);
+    writeVarUInt(str.length);
+    _output.append(str.string, str.length);
+  } else if (value.is<ByteString>()) {
+    auto& bytes = value.as<ByteString>().value(vm);
+    writeByte(pvByteString);
+    writeVarUInt(bytes.length);
+    _output.append(bytes.string, bytes.length);
+  } else if (value.is<Arity>()) {
+    writeArity(value);
+  } else {
+    StableNode* node = value.getStableRef(vm);
+    auto iter = _nodes.find(node);
+
+    if (iter != _nodes.end()) {
+      writeByte(pvRef);
+      writeVarUInt(iter->second);
+    } else {
+      _nodes.emplace(node, _nodes.size());
+      _todo.push_back(node);
+      writeByte(pvNewNode);
+    }
+  }
+}
+
+void StreamSerializer::writeArity(RichNode value) {
+  StableNode* node = value.getStableRef(vm);
+  auto iter = _arities.find(node);
+
+  if (iter != _arities.end()) {
+    writeByte(pvArity);
+    writeVarUInt(iter->second);
+  } else {
+    _arities.emplace(node, _arities.size());
+
+    auto arity = value.as<Arity>();
+    size_t width = arity.getWidth();
+    auto elements = arity.getElementsArray();
+
+    writeByte(pvNewArity);
+    writeVarUInt(width);
+    writeValue(*arity.getLabel());
+    for (size_t i = 0; i < width; i++)
+      writeValue(elements[i]);
+  }
+}
+
+void StreamSerializer::writeNode(RichNode node) {
+  if (node.is<Cons>()) {
+    auto cons = node.as<Cons>();
+    writeByte(pnCons);
+    writeValue(*cons.getHead());
+    writeValue(*cons.getTail());
+  } else if (node.is<Tuple>()) {
+    auto tuple = node.as<Tuple>();
+    size_t width = tuple.getWidth();
+    auto elements = tuple.getElementsArray();
+
+    writeByte(pnTuple);
+    writeVarUInt(width);
+    writeValue(*tuple.getLabel());
+    for (size_t i = 0; i < width; i++)
+      writeValue(elements[i]);
+  } else if (node.is<Record>()) {
+    auto record = node.as<Record>();
+    size_t width = record.getWidth();
+    auto elements = record.getElementsArray();
+
+    writeByte(pnRecord);
+    writeValue(*record.getArity());
+    writeVarUInt(width);
+    for (size_t i = 0; i < width; i++)
+      writeValue(elements[i]);
+  } else {
+    SerializationCallback cb(vm);
+    UnstableNode result = node.type()->serialize(vm, &cb, node);
+
+    while (!cb.todoFrom.empty()) {
+      RichNode from = cb.todoFrom.pop_front(cb.secondMM);
+      RichNode to = cb.todoTo.pop_front(cb.secondMM);
+      _placeholders[to.getStableRef(vm)] = from.getStableRef(vm);
+    }
+
+    writeByte(pnOther);
+    writeHookTree(result);
+
+    _placeholders.clear();
+  }
+}
+
+void StreamSerializer::writeHookValue(StableNode& value) {
+  auto iter = _placeholders.find(&value);
+  if (iter != _placeholders.end())
+    writeValue(*iter->second);
+  else
+    writeHookTree(value);
+}
+
+void StreamSerializer::writeHookTree(RichNode tree) {
+  // The tuples built by the hook are not shared, hence written inline
+  if (tree.is<Tuple>()) {
+    auto tuple = tree.as<Tuple>();
+    size_t width = tuple.getWidth();
+    auto elements = tuple.getElementsArray();
+
+    writeByte(pvTuple);
+    writeVarUInt(width);
+    writeValue(*tuple.getLabel());
+    for (size_t i = 0; i < width; i++)
+      writeHookValue(elements[i]);
+  } else {
+    writeValue(tree);
+  }
+}
+
+void StreamSerializer::writeAtom(atom_t atom) {
+  auto iter = _atoms.find(atom.contents());
+
+  if (iter != _atoms.end()) {
+    writeByte(pvAtom);
+    writeVarUInt(iter->second);
+  } else {
+    _atoms.emplace(atom.contents(), _atoms.size());
+    writeByte(pvNewAtom);
+    writeVarUInt(atom.length());
+    _output.append(atom.contents(), atom.length());
+  }
+}
+
+
+///////////////
+// Unpickler //
+///////////////
+
+namespace {
+  // Maximum nesting of the inline tuples written for serialize() hooks
+  const size_t maxTreeDepth = 64;
+
+  bool isValidUTF8(const char* data, size_t size) {
+    nativeint remaining = (nativeint) size;
+    while (remaining > 0) {
+      nativeint length = fromUTF(data, remaining).second;
+      if (length <= 0)
+        return false;
+      data += length;
+      remaining -= length;
+    }
+    return true;
+  }
+}
+
+/**
+ * Cursor on the input of an Unpickler, i.e., on the bytes of a sequence of
+ * ByteStrings. The read operations return false when there is not enough
+ * input, or when malformed() is true.
+ */
+class Unpickler::Cursor {
+public:
+  struct Mark {
+    size_t segment;
+    size_t offset;
+    size_t position;
+  };
+
+public:
+  Cursor(VM vm, UnpicklerTable& input, size_t offset):
+    vm(vm), _input(input), _segment(0), _offset(offset), _position(0),
+    _missing(0), _malformed(false) {
+    load();
+  }
+
+  Mark mark() {
+    return { _segment, _offset, _position };
+  }
+
+  void rewind(const Mark& mark) {
+    _segment = mark.segment;
+    _offset = mark.offset;
+    _position = mark.position;
+    _missing = 0;
+    load();
+  }
+
+  /** Index of the current ByteString */
+  size_t segment() {
+    return _segment;
+  }
+
+  /** Offset in the current ByteString */
+  size_t offset() {
+    return _offset;
+  }
+
+  /** Number of bytes read since the creation of the cursor */
+  size_t position() {
+    return _position;
+  }
+
+  /** Number of bytes that the last failed read lacked */
+  size_t missing() {
+    return _missing;
+  }
+
+  bool malformed() {
+    return _malformed;
+  }
+
+  bool setMalformed() {
+    _malformed = true;
+    return false;
+  }
+
+  bool readByte(unsigned char& value) {
+    if (!ensureAvailable()) {
+      _missing = 1;
+      return false;
+    }
+
+    value = _data[_offset++];
+    _position++;
+    return true;
+  }
+
+  bool readVarUInt(std::uint64_t& value) {
+    value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7) {
+      unsigned char byte;
+      if (!readByte(byte))
+        return false;
+
+      value |= (std::uint64_t) (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        return true;
+    }
+
+    return setMalformed();
+  }
+
+  bool readVarInt(std::int64_t& value) {
+    std::uint64_t zigzag;
+    if (!readVarUInt(zigzag))
+      return false;
+
+    value = (std::int64_t) (zigzag >> 1) ^ -(std::int64_t) (zigzag & 1);
+    return true;
+  }
+
+  /** Read a length or a width, which must fit in a nativeint */
+  bool readLength(size_t& value) {
+    std::uint64_t length;
+    if (!readVarUInt(length))
+      return false;
+
+    if (length > (std::uint64_t) std::numeric_limits<nativeint>::max())
+      return setMalformed();
+
+    value = (size_t) length;
+    return true;
+  }
+
+  bool read(unsigned char* buffer, size_t size) {
+    return forEachPart(size, [&] (const unsigned char* data, size_t count) {
+      std::memcpy(buffer, data, count);
+      buffer += count;
+    });
+  }
+
+  bool skip(size_t size) {
+    return forEachPart(size, [] (const unsigned char* data, size_t count) {});
+  }
+
+  /** Skip size bytes, which must be valid UTF-8 */
+  bool skipUTF8(size_t size) {
+    auto start = mark();
+    if (!skip(size))
+      return false;
+
+    rewind(start);
+    bool valid = false;
+    withBytes(size, [&] (const unsigned char* data) {
+      valid = isValidUTF8(reinterpret_cast<const char*>(data), size);
+    });
+
+    return valid || setMalformed();
+  }
+
+  /**
+   * Call f(const unsigned char* data) on the size next bytes, which must be
+   * available, and skip them
+   */
+  template <class F>
+  void withBytes(size_t size, const F& f) {
+    if (ensureAvailable() && (size <= _size - _offset)) {
+      const unsigned char* data = _data + _offset;
+      skip(size);
+      f(data);
+    } else {
+      auto buffer = vm->newStaticArray<unsigned char>(size);
+      read(buffer, size);
+      f((const unsigned char*) buffer);
+      vm->deleteStaticArray<unsigned char>(buffer, size);
+    }
+  }
+
+private:
+  template <class F>
+  bool forEachPart(size_t size, const F& f) {
+    while (size > 0) {
+      if (!ensureAvailable()) {
+        _missing = size;
+        return false;
+      }
+
+      size_t count = _size - _offset;
+      if (count > size)
+        count = size;
+
+      f(_data + _offset, count);
+      _offset += count;
+      _position += count;
+      size -= count;
+    }
+
+    return true;
+  }
+
+  bool ensureAvailable() {
+    while (_offset == _size) {
+      if (_segment + 1 >= _input.size())
+        return false;
+
+      _segment++;
+      _offset = 0;
+      load();
+    }
+
+    return true;
+  }
+
+  void load() {
+    if (_segment < _input.size()) {
+      auto& bytes = RichNode(_input[_segment]).as<ByteString>().value(vm);
+      _data = bytes.string;
+      _size = bytes.length;
+    } else {
+      _data = nullptr;
+      _size = 0;
+    }
+  }
+
+private:
+  VM vm;
+  UnpicklerTable& _input;
+
+  size_t _segment;
+  const unsigned char* _data;
+  size_t _size;
+  size_t _offset;
+
+  size_t _position;
+  size_t _missing;
+  bool _malformed;
+};
+
+/** Entries of the tables that the item being scanned adds */
+struct Unpickler::NewEntries {
+  NewEntries(): nodes(0), atoms(0), arities(0) {}
+
+  size_t nodes;
+  size_t atoms;
+  size_t arities;
+};
+
+UnpicklerStatus Unpickler::resume(VM vm, size_t maxNodes) {
+  if (!isHomedInCurrentSpace(vm))
+    raise(vm, MOZART_STR("globalState"), MOZART_STR("unpickler"));
+
+  if (_stage == stDone)
+    return usDone;
+  else if (_stage == stFailed)
+    return usFailed;
+  else if (_inputSize < _wanted)
+    return usNeedInput;
+
+  Cursor cursor(vm, _input, _inputOffset);
+  auto committed = cursor.mark();
+  UnpicklerStatus status = usNeedInput;
+
+  /* Every item is first scanned, which checks that it is complete and well
+   * formed without side effects, then decoded from the same position. */
+  while (true) {
+    bool complete;
+
+    if (_stage == stMagic) {
+      unsigned char magic[sizeof(pickleMagic)];
+      complete = cursor.read(magic, sizeof(magic));
+
+      if (complete && (std::memcmp(magic, pickleMagic, sizeof(magic)) != 0)) {
+        fail(vm, MOZART_STR("badMagic"));
+        status = usFailed;
+        break;
+      } else if (complete) {
+        _stage = stRoot;
+      }
+    } else if (_stage == stRoot) {
+      NewEntries entries;
+      complete = scanValue(cursor, 0, entries);
+
+      if (complete) {
+        cursor.rewind(committed);
+        decodeValue(vm, cursor, _root);
+        _stage = stNodes;
+      }
+    } else if (_readNodes == _nodes.size()) {
+      // Labels and features may be nodes, hence they are checked once all
+      // the nodes are read
+      if (!checkRecords(vm)) {
+        fail(vm, MOZART_STR("malformed"));
+        status = usFailed;
+        break;
+      }
+
+      _stage = stDone;
+      status = usDone;
+      break;
+    } else if (maxNodes == 0) {
+      status = usYield;
+      break;
+    } else {
+      complete = scanNode(cursor);
+
+      if (complete) {
+        cursor.rewind(committed);
+
+        UnstableNode value;
+        if (!decodeNode(vm, cursor, value)) {
+          fail(vm, MOZART_STR("unsupportedValue"));
+          status = usFailed;
+          break;
+        }
+
+        RichNode(_nodes[_readNodes]).as<OptVar>().bind(vm, std::move(value));
+        _readNodes++;
+        maxNodes--;
+      }
+    }
+
+    if (!complete) {
+      if (cursor.malformed()) {
+        fail(vm, MOZART_STR("malformed"));
+        status = usFailed;
+      } else {
+        _wanted = (cursor.position() - committed.position) + cursor.missing();
+      }
+      break;
+    }
+
+    committed = cursor.mark();
+    _wanted = 0;
+  }
+
+  // Drop the input that has been consumed
+  cursor.rewind(committed);
+  _input.drop_front(vm, cursor.segment());
+  _inputOffset = cursor.offset();
+  _inputSize -= committed.position;
+
+  if (status == usDone) {
+    unify(vm, _result, _root);
+  } else if ((status == usFailed) && RichNode(_result).isTransient()) {
+    UnstableNode exception = buildRecord(
+      vm, buildArity(vm, vm->coreatoms.error, 1, vm->coreatoms.debug),
+      buildTuple(vm, MOZART_STR("unpickle"), _error), unit);
+    UnstableNode failed = FailedValue::build(
+      vm, RichNode(exception).getStableRef(vm));
+    DataflowVariable(_result).bind(vm, failed);
+  }
+
+  return status;
+}
+
+bool Unpickler::checkRecords(VM vm) {
+  using namespace patternmatching;
+
+  for (size_t i = 0; i < _arities.size(); i++) {
+    auto arity = RichNode(_arities[i]).as<Arity>();
+    auto features = arity.getElementsArray();
+
+    if (!Literal(*arity.getLabel()).isLiteral(vm))
+      return false;
+
+    // Features must be sorted and unique, for the lookups to be correct
+    bool isTupleArity = true;
+    for (size_t j = 0; j < arity.getWidth(); j++) {
+      RichNode feature = features[j];
+      if (!feature.isFeature())
+        return false;
+      if ((j > 0) && (compareFeatures(vm, features[j-1], feature) >= 0))
+        return false;
+
+      isTupleArity = isTupleArity && matches(vm, feature, (nativeint) j+1);
+    }
+
+    // Such records are always represented as tuples
+    if (isTupleArity)
+      return false;
+  }
+
+  // Lists are always represented as conses
+  for (size_t i = 0; i < _nodes.size(); i++) {
+    RichNode node = _nodes[i];
+    if (node.is<Tuple>()) {
+      auto tuple = node.as<Tuple>();
+      RichNode label = *tuple.getLabel();
+
+      if (!Literal(label).isLiteral(vm))
+        return false;
+      if ((tuple.getWidth() == 2) && label.is<Atom>() &&
+          (label.as<Atom>().value() == vm->coreatoms.pipe))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+UnstableNode Unpickler::getRest(VM vm) {
+  Cursor cursor(vm, _input, _inputOffset);
+  auto rest = newLStringInit(vm, _inputSize, [&] (unsigned char* buffer) {
+    cursor.read(buffer, _inputSize);
+  });
+
+  return ByteString::build(vm, rest);
+}
+
+bool Unpickler::scanIndex(Cursor& cursor, size_t tableSize,
+                          size_t newEntries) {
+  std::uint64_t index;
+  if (!cursor.readVarUInt(index))
+    return false;
+
+  if (index >= tableSize + newEntries)
+    return cursor.setMalformed();
+
+  return true;
+}
+
+bool Unpickler::scanAtomTag(Cursor& cursor) {
+  auto mark = cursor.mark();
+
+  unsigned char tag;
+  if (!cursor.readByte(tag))
+    return false;
+
+  if ((tag != pvAtom) && (tag != pvNewAtom))
+    return cursor.setMalformed();
+
+  cursor.rewind(mark);
+  return true;
+}
+
+bool Unpickler::scanValue(Cursor& cursor, size_t depth, NewEntries& entries) {
+  unsigned char tag;
+  std::int64_t intValue;
+  size_t length;
+
+  if (!cursor.readByte(tag))
+    return false;
+
+  switch (tag) {
+    case pvNewNode: {
+      entries.nodes++;
+      return true;
+    }
+
+    case pvRef:
+      return scanIndex(cursor, _nodes.size(), entries.nodes);
+
+    case pvInt: {
+      // The value must fit in a SmallInt
+      if (!cursor.readVarInt(intValue))
+        return false;
+      if ((std::int64_t) (nativeint) intValue != intValue)
+        return cursor.setMalformed();
+      return true;
+    }
+
+    case pvFloat:
+      return cursor.skip(8);
+
+    case pvAtom:
+      return scanIndex(cursor, _atoms.size(), entries.atoms);
+
+    case pvNewAtom: {
+      entries.atoms++;
+      return cursor.readLength(length) && cursor.skipUTF8(length);
+    }
+
+    case pvTrue:
+    case pvFalse:
+    case pvUnit:
+      return true;
+
+    case pvString:
+      return cursor.readLength(length) && cursor.skipUTF8(length);
+
+    case pvByteString:
+      return cursor.readLength(length) && cursor.skip(length);
+
+    case pvArity:
+      return scanIndex(cursor, _arities.size(), entries.arities);
+
+    case pvTuple:
+    case pvNewArity: {
+      if (depth >= maxTreeDepth)
+        return cursor.setMalformed();
+
+      if (!cursor.readLength(length))
+        return false;
+      if (length == 0)
+        return cursor.setMalformed();
+
+      // The tuples of hooks are labelled by atoms
+      if ((tag == pvTuple) && !scanAtomTag(cursor))
+        return false;
+
+      // The label, then the elements or features
+      for (size_t i = 0; i <= length; i++) {
+        if (!scanValue(cursor, depth+1, entries))
+          return false;
+      }
+
+      if (tag == pvNewArity)
+        entries.arities++;
+      return true;
+    }
+
+    default:
+      return cursor.setMalformed();
+  }
+}
+
+bool Unpickler::scanNode(Cursor& cursor) {
+  unsigned char kind;
+  unsigned char tag;
+  size_t width;
+  size_t arityWidth;
+  std::uint64_t index;
+  NewEntries entries;
+
+  if (!cursor.readByte(kind))
+    return false;
+
+  switch (kind) {
+    case pnCons:
+      return scanValue(cursor, 0, entries) && scanValue(cursor, 0, entries);
+
+    case pnTuple:
+    case pnRecord: {
+      if (kind == pnTuple) {
+        if (!cursor.readLength(width))
+          return false;
+      } else {
+        // The arity must be given as such, so that the record can be built
+        auto arityMark = cursor.mark();
+        if (!cursor.readByte(tag))
+          return false;
+
+        if (tag == pvArity) {
+          if (!cursor.readVarUInt(index))
+            return false;
+          if (index >= _arities.size())
+            return cursor.setMalformed();
+          RichNode arity = _arities[(size_t) index];
+          arityWidth = arity.as<Arity>().getWidth();
+        } else if (tag == pvNewArity) {
+          if (!cursor.readLength(arityWidth))
+            return false;
+        } else {
+          return cursor.setMalformed();
+        }
+
+        cursor.rewind(arityMark);
+        if (!scanValue(cursor, 0, entries) || !cursor.readLength(width))
+          return false;
+
+        // Otherwise the record would read past the features of its arity
+        if (width != arityWidth)
+          return cursor.setMalformed();
+      }
+
+      if (width == 0)
+        return cursor.setMalformed();
+
+      // For a tuple, the label comes first
+      size_t count = (kind == pnTuple) ? width+1 : width;
+      for (size_t i = 0; i < count; i++) {
+        if (!scanValue(cursor, 0, entries))
+          return false;
+      }
+      return true;
+    }
+
+    case pnOther:
+      return scanValue(cursor, 0, entries);
+
+    default:
+      return cursor.setMalformed();
+  }
+}
+
+template <class T>
+void Unpickler::decodeValue(VM vm, Cursor& cursor, T& dest) {
+  unsigned char tag;
+  std::uint64_t index;
+  size_t length;
+
+  cursor.readByte(tag);
+
+  switch (tag) {
+    case pvNewNode: {
+      _nodes.push_back(vm, OptVar::build(vm));
+      dest.init(vm, _nodes.back());
+      break;
+    }
+
+    case pvRef: {
+      cursor.readVarUInt(index);
+      dest.init(vm, _nodes[(size_t) index]);
+      break;
+    }
+
+    case pvInt: {
+      std::int64_t value;
+      cursor.readVarInt(value);
+      dest.init(vm, SmallInt::build(vm, (nativeint) value));
+      break;
+    }
+
+    case pvFloat: {
+      unsigned char bytes[8];
+      cursor.read(bytes, 8);
+
+      std::uint64_t bits = 0;
+      for (size_t i = 0; i < 8; i++)
+        bits |= (std::uint64_t) bytes[i] << (8*i);
+
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      dest.init(vm, Float::build(vm, value));
+      break;
+    }
+
+    case pvAtom: {
+      cursor.readVarUInt(index);
+      dest.init(vm, _atoms[(size_t) index]);
+      break;
+    }
+
+    case pvNewAtom: {
+      cursor.readLength(length);
+      cursor.withBytes(length, [&] (const unsigned char* data) {
+        auto contents = reinterpret_cast<const nchar*>(data);
+        _atoms.push_back(vm, Atom::build(vm, length, contents));
+      });
+      dest.init(vm, _atoms.back());
+      break;
+    }
+
+    case pvTrue:
+    case pvFalse: {
+      dest.init(vm, Boolean::build(vm, tag == pvTrue));
+      break;
+    }
+
+    case pvUnit: {
+      dest.init(vm, Unit::build(vm));
+      break;
+    }
+
+    case pvString: {
+      cursor.readLength(length);
+      cursor.withBytes(length, [&] (const unsigned char* data) {
+        auto contents = reinterpret_cast<const nchar*>(data);
+        dest.init(vm, String::build(vm, newLString(vm, contents, length)));
+      });
+      break;
+    }
+
+    case pvByteString: {
+      cursor.readLength(length);
+      cursor.withBytes(length, [&] (const unsigned char* data) {
+        dest.init(vm, ByteString::build(vm, newLString(vm, data, length)));
+      });
+      break;
+    }
+
+    case pvArity: {
+      cursor.readVarUInt(index);
+      dest.init(vm, _arities[(size_t) index]);
+      break;
+    }
+
+    case pvTuple: {
+      cursor.readLength(length);
+
+      UnstableNode label;
+      decodeValue(vm, cursor, label);
+
+      // The scan checked that the label is an atom
+      atom_t labelAtom = RichNode(label).as<Atom>().value();
+      if ((length == 2) && (labelAtom == vm->coreatoms.pipe)) {
+        UnstableNode head, tail;
+        decodeValue(vm, cursor, head);
+        decodeValue(vm, cursor, tail);
+        dest.init(vm, buildCons(vm, std::move(head), std::move(tail)));
+        break;
+      }
+
+      UnstableNode tuple = Tuple::build(vm, length, label);
+      auto elements = RichNode(tuple).as<Tuple>().getElementsArray();
+      for (size_t i = 0; i < length; i++)
+        decodeValue(vm, cursor, elements[i]);
+
+      dest.init(vm, std::move(tuple));
+      break;
+    }
+
+    case pvNewArity: {
+      cursor.readLength(length);
+
+      UnstableNode label;
+      decodeValue(vm, cursor, label);
+
+      UnstableNode arity = Arity::build(vm, length, label);
+      auto elements = RichNode(arity).as<Arity>().getElementsArray();
+      for (size_t i = 0; i < length; i++)
+        decodeValue(vm, cursor, elements[i]);
+
+      _arities.push_back(vm, std::move(arity));
+      dest.init(vm, _arities.back());
+      break;
+    }
+  }
+}
+
+bool Unpickler::decodeNode(VM vm, Cursor& cursor, UnstableNode& dest) {
+  unsigned char kind;
+  size_t width;
+
+  cursor.readByte(kind);
+
+  switch (kind) {
+    case pnCons: {
+      UnstableNode head, tail;
+      decodeValue(vm, cursor, head);
+      decodeValue(vm, cursor, tail);
+      dest = buildCons(vm, std::move(head), std::move(tail));
+      return true;
+    }
+
+    case pnTuple: {
+      cursor.readLength(width);
+
+      UnstableNode label;
+      decodeValue(vm, cursor, label);
+
+      dest = Tuple::build(vm, width, label);
+      auto elements = RichNode(dest).as<Tuple>().getElementsArray();
+      for (size_t i = 0; i < width; i++)
+        decodeValue(vm, cursor, elements[i]);
+      return true;
+    }
+
+    case pnRecord: {
+      UnstableNode arity;
+      decodeValue(vm, cursor, arity);
+      cursor.readLength(width);
+
+      dest = Record::build(vm, width, arity);
+      auto elements = RichNode(dest).as<Record>().getElementsArray();
+      for (size_t i = 0; i < width; i++)
+        decodeValue(vm, cursor, elements[i]);
+      return true;
+    }
+
+    default: {
+      UnstableNode tree;
+      decodeValue(vm, cursor, tree);
+      return rebuildFromHook(vm, tree, dest);
+    }
+  }
+}
+
+namespace {
+  /**
+   * Match the tuples built by serialize() hooks, which are atoms when they
+   * have no field. This does not wait for anything.
+   */
+  bool matchesHookTuple(VM vm, RichNode tree, const nchar* label,
+                        size_t& width, StaticArray<StableNode>& elements) {
+    atom_t labelAtom = vm->getAtom(label);
+
+    if (tree.is<Atom>()) {
+      width = 0;
+      elements = nullptr;
+      return tree.as<Atom>().value() == labelAtom;
+    } else if (tree.is<Tuple>()) {
+      auto tuple = tree.as<Tuple>();
+      RichNode treeLabel = *tuple.getLabel();
+
+      width = tuple.getWidth();
+      elements = tuple.getElementsArray();
+      return treeLabel.is<Atom>() && (treeLabel.as<Atom>().value() == labelAtom);
+    } else {
+      return false;
+    }
+  }
+
+  bool getAtomField(RichNode field, atom_t& value) {
+    if (!field.is<Atom>())
+      return false;
+
+    value = field.as<Atom>().value();
+    return true;
+  }
+
+  bool getSizeField(RichNode field, size_t& value) {
+    if (!field.is<SmallInt>() || (field.as<SmallInt>().value() < 0))
+      return false;
+
+    value = (size_t) field.as<SmallInt>().value();
+    return true;
+  }
+}
+
+bool Unpickler::rebuildFromHook(VM vm, RichNode tree, UnstableNode& dest) {
+  size_t width;
+  StaticArray<StableNode> fields;
+  atom_t atom;
+  size_t size;
+
+  if (matchesHookTuple(vm, tree, MOZART_STR("namedname"), width, fields)) {
+    if ((width != 1) || !getAtomField(fields[0], atom))
+      return false;
+    dest = NamedName::build(vm, atom);
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("uniquename"),
+                              width, fields)) {
+    if ((width != 1) || !getAtomField(fields[0], atom))
+      return false;
+    dest = mozart::build(vm, unique_name_t(atom));
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("builtin"), width, fields)) {
+    atom_t moduleName;
+    if ((width != 2) || !getAtomField(fields[0], moduleName) ||
+        !getAtomField(fields[1], atom))
+      return false;
+
+    bool found = false;
+    MOZART_TRY(vm) {
+      dest = vm->findBuiltin(moduleName, atom);
+      found = true;
+    } MOZART_CATCH(vm, kind, node) {
+    } MOZART_ENDTRY(vm);
+
+    return found;
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("chunk"), width, fields)) {
+    if (width != 1)
+      return false;
+    dest = Chunk::build(vm, fields[0]);
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("abstraction"),
+                              width, fields)) {
+    if (width == 0)
+      return false;
+
+    size_t Gc = width-1;
+    dest = Abstraction::build(vm, Gc, fields[Gc]);
+    auto elements = RichNode(dest).as<Abstraction>().getElementsArray();
+    for (size_t i = 0; i < Gc; i++)
+      elements[i].init(vm, fields[i]);
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("codearea"),
+                              width, fields)) {
+    // codearea(code(...) Arity Xcount registers(...) PrintName DebugData)
+    size_t codeSize, Kc, arity, Xcount;
+    StaticArray<StableNode> code, Ks;
+
+    if ((width != 6) ||
+        !matchesHookTuple(vm, fields[0], MOZART_STR("code"), codeSize, code) ||
+        !getSizeField(fields[1], arity) || !getSizeField(fields[2], Xcount) ||
+        !matchesHookTuple(vm, fields[3], MOZART_STR("registers"), Kc, Ks) ||
+        !getAtomField(fields[4], atom))
+      return false;
+
+    auto codeBlock = vm->newStaticArray<ByteCode>(codeSize);
+    bool valid = true;
+    for (size_t i = 0; i < codeSize; i++) {
+      valid = valid && getSizeField(code[i], size) && (size <= 0xffff);
+      codeBlock[i] = (ByteCode) size;
+    }
+
+    if (valid) {
+      dest = CodeArea::build(vm, Kc, (ByteCode*) codeBlock,
+                             codeSize * sizeof(ByteCode), arity, Xcount,
+                             atom, fields[5]);
+      auto elements = RichNode(dest).as<CodeArea>().getElementsArray();
+      for (size_t i = 0; i < Kc; i++)
+        elements[i].init(vm, Ks[i]);
+    }
+
+    vm->deleteStaticArray<ByteCode>(codeBlock, codeSize);
+    return valid;
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("patmatwildcard"),
+                              width, fields)) {
+    if (width != 0)
+      return false;
+    dest = PatMatCapture::build(vm, -1);
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("patmatcapture"),
+                              width, fields)) {
+    if ((width != 1) || !getSizeField(fields[0], size))
+      return false;
+    dest = PatMatCapture::build(vm, (nativeint) size);
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("patmatconjunction"),
+                              width, fields)) {
+    dest = PatMatConjunction::build(vm, width);
+    auto elements = RichNode(dest).as<PatMatConjunction>().getElementsArray();
+    for (size_t i = 0; i < width; i++)
+      elements[i].init(vm, fields[i]);
+  } else if (matchesHookTuple(vm, tree, MOZART_STR("patmatopenrecord"),
+                              width, fields)) {
+    if ((width == 0) || !RichNode(fields[width-1]).is<Arity>())
+      return false;
+
+    size_t count = width-1;
+    dest = PatMatOpenRecord::build(vm, count, fields[count]);
+    auto elements = RichNode(dest).as<PatMatOpenRecord>().getElementsArray();
+    for (size_t i = 0; i < count; i++)
+      elements[i].init(vm, fields[i]);
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+void Unpickler::fail(VM vm, const nchar* reason) {
+  _stage = stFailed;
+  _error = mozart::build(vm, reason);
+}
+
 }
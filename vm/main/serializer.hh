@@ -62,6 +62,83 @@ Serializer::Serializer(VM vm, GR gr, Serializer& from) {
   gr->copyUnstableNode(done, from.done);
 }
 
+
+////////////////////
+// UnpicklerTable //
+////////////////////
+
+UnpicklerTable::UnpicklerTable(VM vm, GR gr, UnpicklerTable& from):
+  _array(nullptr), _capacity(from._size), _size(from._size) {
+
+  if (_capacity != 0) {
+    _array = vm->newStaticArray<UnstableNode>(_capacity);
+    for (size_t i = 0; i < _size; i++)
+      gr->copyUnstableNode(_array[i], from._array[i]);
+  }
+}
+
+void UnpicklerTable::push_back(VM vm, UnstableNode&& node) {
+  if (_size == _capacity) {
+    StaticArray<UnstableNode> oldArray = _array;
+    size_t oldCapacity = _capacity;
+
+    _capacity = (oldCapacity == 0) ? 16 : 2*oldCapacity;
+    _array = vm->newStaticArray<UnstableNode>(_capacity);
+
+    for (size_t i = 0; i < _size; i++)
+      _array[i] = std::move(oldArray[i]); // freed just below, so that's OK
+
+    if (oldCapacity != 0)
+      vm->deleteStaticArray<UnstableNode>(oldArray, oldCapacity);
+  }
+
+  _array[_size++] = std::move(node);
+}
+
+void UnpicklerTable::drop_front(VM vm, size_t count) {
+  for (size_t i = count; i < _size; i++)
+    _array[i-count] = std::move(_array[i]);
+  _size -= count;
+}
+
+///////////////
+// Unpickler //
+///////////////
+
+#include "Unpickler-implem.hh"
+
+Unpickler::Unpickler(VM vm, RichNode result):
+  WithHome(vm), _stage(stMagic), _result(vm, result), _readNodes(0),
+  _inputOffset(0), _inputSize(0), _wanted(0) {
+
+  _root.init(vm);
+  _error.init(vm);
+}
+
+Unpickler::Unpickler(VM vm, GR gr, Unpickler& from):
+  WithHome(vm, gr, from), _stage(from._stage), _nodes(vm, gr, from._nodes),
+  _atoms(vm, gr, from._atoms), _arities(vm, gr, from._arities),
+  _readNodes(from._readNodes),
+  _input(vm, gr, from._input), _inputOffset(from._inputOffset),
+  _inputSize(from._inputSize), _wanted(from._wanted) {
+
+  gr->copyUnstableNode(_result, from._result);
+  gr->copyUnstableNode(_root, from._root);
+  gr->copyUnstableNode(_error, from._error);
+}
+
+void Unpickler::feed(VM vm, RichNode chunk) {
+  if (!isHomedInCurrentSpace(vm))
+    raise(vm, MOZART_STR("globalState"), MOZART_STR("unpickler"));
+
+  size_t size = chunk.as<ByteString>().value(vm).length;
+  if (size == 0)
+    return;
+
+  _input.push_back(vm, UnstableNode(vm, chunk));
+  _inputSize += size;
+}
+
 }
 
 #endif // MOZART_GENERATOR
@@ -0,0 +1,138 @@
+// Copyright © 2013, Université catholique de Louvain
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// *  Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// *  Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __SLOTTABLE_H
+#define __SLOTTABLE_H
+
+#include <cstdint>
+#include <cassert>
+#include <vector>
+
+namespace mozart {
+
+/**
+ * Handle to a slot of a SlotTable, made of the index of the slot and of its
+ * generation, so that handles to released slots can be detected.
+ * The default handle is never valid.
+ */
+struct SlotHandle {
+  SlotHandle(): index(0), generation(0) {}
+
+  SlotHandle(std::uint32_t index, std::uint32_t generation):
+    index(index), generation(generation) {}
+
+  std::uint32_t index;
+  std::uint32_t generation;
+};
+
+/**
+ * Table of values referred to by generational handles.
+ * Acquiring and releasing a slot are O(1) thanks to a free list, and the
+ * slots in use can be scanned linearly. It is not thread-safe.
+ */
+template <typename T>
+class SlotTable {
+private:
+  static constexpr std::uint32_t noSlot = (std::uint32_t) -1;
+public:
+  SlotTable(): _firstFree(noSlot), _count(0) {}
+
+  // Make this class non-copyable
+  SlotTable(const SlotTable& from) = delete;
+  SlotTable& operator=(const SlotTable& from) = delete;
+
+  size_t count() {
+    return _count;
+  }
+
+  SlotHandle acquire(const T& value) {
+    std::uint32_t index;
+    if (_firstFree != noSlot) {
+      index = _firstFree;
+      _firstFree = _slots[index].nextFree;
+    } else {
+      index = (std::uint32_t) _slots.size();
+      _slots.emplace_back();
+    }
+
+    Slot& slot = _slots[index];
+    slot.value = value;
+    slot.used = true;
+    _count++;
+
+    return SlotHandle(index, slot.generation);
+  }
+
+  bool isValid(SlotHandle handle) {
+    return (handle.index < _slots.size()) &&
+      (_slots[handle.index].generation == handle.generation) &&
+      _slots[handle.index].used;
+  }
+
+  T& get(SlotHandle handle) {
+    assert(isValid(handle));
+    return _slots[handle.index].value;
+  }
+
+  void release(SlotHandle handle) {
+    assert(isValid(handle));
+    Slot& slot = _slots[handle.index];
+
+    slot.value = T();
+    slot.used = false;
+    // Generation 0 is reserved for the default handle, which is never valid
+    if (++slot.generation == 0)
+      slot.generation = 1;
+
+    slot.nextFree = _firstFree;
+    _firstFree = handle.index;
+    _count--;
+  }
+
+  /** Apply f to the T& of every slot in use */
+  template <typename F>
+  void forEach(const F& f) {
+    for (auto& slot: _slots) {
+      if (slot.used)
+        f(slot.value);
+    }
+  }
+private:
+  struct Slot {
+    Slot(): value(), generation(1), nextFree(noSlot), used(false) {}
+
+    T value;
+    std::uint32_t generation;
+    std::uint32_t nextFree;
+    bool used;
+  };
+
+  std::vector<Slot> _slots;
+  std::uint32_t _firstFree;
+  size_t _count;
+};
+
+}
+
+#endif // __SLOTTABLE_H
@@ -39,7 +39,7 @@ public:
   static constexpr UUID uuid = "{00000000-0000-4f00-0000-000000000001}";
 
   static atom_t getTypeAtom(VM vm) {
-    return vm->getAtom(MOZART_STR("int"));
+    return vm->coreatoms.typeInt;
   }
 
   explicit SmallInt(nativeint value) : _value(value) {}
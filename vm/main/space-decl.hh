@@ -173,6 +173,14 @@ public:
   inline
   void kill(VM vm);
 
+  /**
+   * Run {Callable Args... Root} in a new thread of this space, which becomes
+   * unstable again until that thread is done.
+   */
+  template <typename... Args>
+  inline
+  void inject(VM vm, RichNode callable, Args&&... args);
+
 // Distributor
 
 public:
@@ -188,6 +196,52 @@ public:
     _distributor = distributor;
   }
 
+// Recomputation
+
+  /* With a recomputation distance k > 1, Space.clone copies a space only
+   * every k commits. The last copy, the snapshot, is kept aside, and the
+   * space records the commits it receives afterwards. Clones taken in
+   * between are lazy: they only reference the snapshot and the commits to
+   * replay, and are recomputed the first time they are used. This assumes
+   * that the script is deterministic.
+   */
+
+public:
+  bool isLazy() {
+    return _isLazy;
+  }
+
+  /** Is this space still replaying the commits of a lazy clone? */
+  bool isReplaying() {
+    return _replaying;
+  }
+
+  /**
+   * Clone this space with the given recomputation distance. The result is
+   * lazy unless a new snapshot had to be taken.
+   */
+  inline
+  Space* cloneWithRecomputation(VM vm, nativeint distance);
+
+  /**
+   * Recompute a lazy space. This space becomes a reference to the result,
+   * which replays its commits asynchronously.
+   */
+  inline
+  Space* materialize(VM vm);
+private:
+  inline
+  bool hasSnapshot();
+
+  inline
+  void clearSnapshot(VM vm);
+
+  inline
+  bool replayNextCommit(VM vm);
+
+  inline
+  void stopReplaying(VM vm);
+
 // Status variable
 
 private:
@@ -360,6 +414,14 @@ private:
   SpaceTrail trail;
   SpaceScript script;
 
+  // Recomputation
+  bool _isLazy;
+  bool _replaying;
+  UnstableNode _snapshot; // ReifiedSpace of the snapshot, or unit
+  VMAllocatedList<nativeint> _commits; // since the snapshot
+  nativeint _commitCount;
+  VMAllocatedList<nativeint> _replay;  // still to be replayed
+
   /*
    * Maintaining a counter of threads
    * Invariants:
@@ -124,6 +124,11 @@ void Space::constructor(VM vm, bool isTopLevel, Space* parent) {
 
   _distributor = nullptr;
 
+  _isLazy = false;
+  _replaying = false;
+  _snapshot = build(vm, unit);
+  _commitCount = 0;
+
   threadCount = 0;
   cascadedRunnableThreadCount = 0;
 }
@@ -158,7 +163,7 @@ Space::Space(GR gr, Space* from) {
      * determined status variable.
      */
     RichNode fromStatusVar = from->_statusVar;
-    assert(!fromStatusVar.isTransient());
+    assert(!fromStatusVar.isTransient() || from->_isLazy);
   }
 #endif
 
@@ -178,6 +183,15 @@ Space::Space(GR gr, Space* from) {
     gr->copyUnstableNode(entry.right, iter->right);
   }
 
+  _isLazy = from->_isLazy;
+  _replaying = from->_replaying;
+  gr->copyUnstableNode(_snapshot, from->_snapshot);
+  for (auto iter = from->_commits.begin(); iter != from->_commits.end(); ++iter)
+    _commits.push_back(gr->vm, *iter);
+  _commitCount = from->_commitCount;
+  for (auto iter = from->_replay.begin(); iter != from->_replay.end(); ++iter)
+    _replay.push_back(gr->vm, *iter);
+
   threadCount = from->threadCount;
   cascadedRunnableThreadCount = from->cascadedRunnableThreadCount;
 
@@ -242,6 +256,7 @@ void Space::fail(VM vm) {
   Space* parent = getParent();
   _status = ssFailed;
   parent->decRunnableThreadCount();
+  stopReplaying(vm);
 
   deinstallThisFailed();
   vm->setCurrentSpace(parent);
@@ -276,21 +291,47 @@ nativeint Space::commit(VM vm, nativeint value) {
     clearStatusVar(vm);
     if (commitResult == 0)
       _distributor = nullptr;
+
+    if (hasSnapshot()) {
+      _commits.push_back(vm, value);
+      _commitCount++;
+    }
   }
 
   return commitResult;
 }
 
 Space* Space::clone(VM vm) {
-  return vm->cloneSpace(this);
+  if (!hasSnapshot())
+    return vm->cloneSpace(this);
+
+  // The snapshot is a sibling of this space: it would be copied along
+  UnstableNode snapshot = std::move(_snapshot);
+  _snapshot = build(vm, unit);
+
+  Space* result = vm->cloneSpace(this);
+  result->clearSnapshot(vm);
+
+  _snapshot = std::move(snapshot);
+  return result;
 }
 
 void Space::kill(VM vm) {
   assert(!isTopLevel());
 
+  if (isLazy()) {
+    // Nothing to recompute
+    _isLazy = false;
+    _commits.clear(vm);
+    _status = ssFailed;
+    bindStatusVar(vm, build(vm, vm->coreatoms.failed));
+    return;
+  }
+
   Space* parent = getParent();
   _status = ssFailed;
   parent->decRunnableThreadCount();
+  stopReplaying(vm);
 
   clearStatusVar(vm);
 
@@ -298,6 +339,92 @@ void Space::kill(VM vm) {
   bindStatusVar(vm, build(vm, vm->coreatoms.failed));
 }
 
+template <typename... Args>
+void Space::inject(VM vm, RichNode callable, Args&&... args) {
+  assert(!isTopLevel() && !isFailed() && !isLazy());
+
+  // Replaying the commits on the snapshot would not reproduce this
+  clearSnapshot(vm);
+
+  clearStatusVar(vm);
+  ozcalls::asyncOzCall(vm, this, callable, std::forward<Args>(args)...,
+                       *getRootVar());
+}
+
+// Recomputation
+
+Space* Space::cloneWithRecomputation(VM vm, nativeint distance) {
+  if (!isLazy() && (!hasSnapshot() || (_commitCount >= distance))) {
+    // Take a new snapshot, without the previous one
+    clearSnapshot(vm);
+    Space* snapshot = clone(vm);
+
+    _snapshot = ReifiedSpace::build(vm, snapshot);
+  }
+
+  Space* result = new (vm) Space(vm, getParent());
+  result->_isLazy = true;
+  result->_snapshot.copy(vm, _snapshot);
+  for (auto iter = _commits.begin(); iter != _commits.end(); ++iter)
+    result->_commits.push_back(vm, *iter);
+  result->_commitCount = _commitCount;
+
+  return result;
+}
+
+Space* Space::materialize(VM vm) {
+  assert(isLazy());
+
+  Space* snapshot = RichNode(_snapshot).as<ReifiedSpace>().getSpace();
+  Space* result = snapshot->clone(vm);
+
+  result->_snapshot.copy(vm, _snapshot);
+  if (!_commits.empty())
+    result->_replay.splice(vm, _commits);
+
+  _isLazy = false;
+  _commitCount = 0;
+  setReference(result);
+
+  if (!result->_replay.empty()) {
+    result->_replaying = true;
+    result->replayNextCommit(vm);
+  }
+
+  return result;
+}
+
+bool Space::hasSnapshot() {
+  return RichNode(_snapshot).is<ReifiedSpace>();
+}
+
+void Space::clearSnapshot(VM vm) {
+  _snapshot = build(vm, unit);
+  _commits.clear(vm);
+  _commitCount = 0;
+}
+
+void Space::stopReplaying(VM vm) {
+  _replay.clear(vm);
+  _replaying = false;
+}
+
+bool Space::replayNextCommit(VM vm) {
+  if (_replay.empty())
+    return false;
+
+  nativeint value = _replay.pop_front(vm);
+  if (hasDistributor() && (commit(vm, value) >= 0))
+    return true;
+
+  // The recomputation diverged from the original computation
+  stopReplaying(vm);
+  _status = ssFailed;
+  clearStatusVar(vm);
+  bindStatusVar(vm, build(vm, vm->coreatoms.failed));
+  return true;
+}
+
 // Status variable
 
 void Space::clearStatusVar(VM vm) {
@@ -459,6 +586,13 @@ void Space::checkStability() {
     // Succeeded
     vm->setCurrentSpace(parent);
 
+    if (_replaying) {
+      // Replaying the commits of a lazy clone: wait until it is done
+      if (replayNextCommit(vm))
+        return;
+      _replaying = false;
+    }
+
     if (hasDistributor()) {
       nativeint alternatives = getDistributor()->getAlternatives();
       UnstableNode newStatus = buildTuple(vm, vm->coreatoms.alternatives,
@@ -30,11 +30,28 @@
 #include "memword.hh"
 #include "storage-decl.hh"
 #include "uuid-decl.hh"
+#include "slottable.hh"
 
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
 
 namespace mozart {
 
+namespace internal {
+  /** Hooks for the allocation profiler, defined in vm.hh */
+  inline
+  bool isAllocationProfilerActive(VM vm);
+
+  inline
+  size_t enterAllocationScope(VM vm);
+
+  inline
+  void recordNodeAllocation(VM vm, Type type, size_t scope);
+}
+
 /**
  * A value node in the store.
  * The store is entirely made of nodes. A node is basically a typed value.
@@ -63,7 +80,15 @@ private:
 
   template<class T, class... Args>
   void make(VM vm, Args&&... args) {
-    Accessor<T>::init(data.type, data.value, vm, std::forward<Args>(args)...);
+    if (!internal::isAllocationProfilerActive(vm)) {
+      Accessor<T>::init(data.type, data.value, vm,
+                        std::forward<Args>(args)...);
+    } else {
+      size_t scope = internal::enterAllocationScope(vm);
+      Accessor<T>::init(data.type, data.value, vm,
+                        std::forward<Args>(args)...);
+      internal::recordNodeAllocation(vm, data.type, scope);
+    }
   }
 
   Type type() {
@@ -392,10 +417,94 @@ public:
   UUID uuid;
   StableNode self;
   StableNode protocol;
+};
+
+/**
+ * Index of the global nodes of a VM by UUID.
+ * This is a hash table with open addressing and linear probing. It is
+ * cleared at the beginning of each garbage collection, and the GC adds back
+ * the global nodes it reaches, so that unreachable ones are forgotten.
+ */
+class GlobalNodeTable {
+private:
+  static constexpr size_t initialBucketCount = 64;
+public:
+  GlobalNodeTable(): _buckets(nullptr), _bucketMask(0), _count(0) {}
+
+  ~GlobalNodeTable() {
+    delete[] _buckets;
+  }
+
+  // Make this class non-copyable
+  GlobalNodeTable(const GlobalNodeTable& from) = delete;
+  GlobalNodeTable& operator=(const GlobalNodeTable& from) = delete;
+
+  size_t count() {
+    return _count;
+  }
+
+  /** Find the global node with the given UUID, or nullptr if there is none */
+  GlobalNode* find(const UUID& uuid) {
+    if (_buckets == nullptr)
+      return nullptr;
+
+    for (size_t i = bucketFor(uuid); _buckets[i] != nullptr;
+         i = (i + 1) & _bucketMask) {
+      if (_buckets[i]->uuid == uuid)
+        return _buckets[i];
+    }
 
+    return nullptr;
+  }
+
+  /** Add a global node, whose UUID must not be in the table yet */
+  void insert(GlobalNode* node) {
+    if (2 * (_count + 1) > _bucketMask + 1)
+      grow();
+
+    place(node);
+    _count++;
+  }
+
+  /** Forget all the global nodes, but keep the allocated buckets */
+  void clear() {
+    if (_count != 0) {
+      std::fill(_buckets, _buckets + _bucketMask + 1, nullptr);
+      _count = 0;
+    }
+  }
 private:
-  GlobalNode* left;
-  GlobalNode* right;
+  size_t bucketFor(const UUID& uuid) {
+    return (size_t) uuid.hash() & _bucketMask;
+  }
+
+  void place(GlobalNode* node) {
+    size_t i = bucketFor(node->uuid);
+    while (_buckets[i] != nullptr)
+      i = (i + 1) & _bucketMask;
+    _buckets[i] = node;
+  }
+
+  void grow() {
+    GlobalNode** oldBuckets = _buckets;
+    size_t oldBucketCount = (oldBuckets == nullptr) ? 0 : _bucketMask + 1;
+    size_t newBucketCount =
+      (oldBucketCount == 0) ? initialBucketCount : 2 * oldBucketCount;
+
+    _buckets = new GlobalNode*[newBucketCount]();
+    _bucketMask = newBucketCount - 1;
+
+    for (size_t i = 0; i < oldBucketCount; i++) {
+      if (oldBuckets[i] != nullptr)
+        place(oldBuckets[i]);
+    }
+
+    delete[] oldBuckets;
+  }
+private:
+  GlobalNode** _buckets;
+  size_t _bucketMask;
+  size_t _count;
 };
 
 /**
@@ -451,6 +560,18 @@ private:
   std::shared_ptr<StableNode*> _node;
 };
 
+/**
+ * The returned value of 'vm->protectInSlot()', a handle to a node protected
+ * from GC until it is released with 'vm->releaseProtectedSlot()'.
+ */
+typedef SlotHandle ProtectedSlot;
+
+/**
+ * Table of the slots of the protected nodes that are released explicitly.
+ * The GC scans it linearly.
+ */
+typedef SlotTable<StableNode*> ProtectedSlotTable;
+
 }
 
 #endif // __STORE_DECL_H
@@ -272,7 +272,7 @@ StableNode* RichNode::destOf(Node* node) {
 // GlobalNode //
 ////////////////
 
-GlobalNode::GlobalNode(UUID uuid): uuid(uuid), left(nullptr), right(nullptr) {
+GlobalNode::GlobalNode(UUID uuid): uuid(uuid) {
 }
 
 template <class Self, class Proto>
@@ -292,20 +292,13 @@ GlobalNode* GlobalNode::make(VM vm, Self&& self, Proto&& proto) {
 }
 
 bool GlobalNode::get(VM vm, UUID uuid, GlobalNode*& to) {
-  GlobalNode** cur = &(vm->rootGlobalNode);
-  while (true) {
-    if (!*cur) {
-      to = *cur = new (vm) GlobalNode(uuid);
-      return false;
-    } else if ((*cur)->uuid < uuid) {
-      cur = &((*cur)->right);
-    } else if ((*cur)->uuid > uuid) {
-      cur = &((*cur)->left);
-    } else {
-      to = *cur;
-      return true;
-    }
-  }
+  to = vm->globalNodes.find(uuid);
+  if (to != nullptr)
+    return true;
+
+  to = new (vm) GlobalNode(uuid);
+  vm->globalNodes.insert(to);
+  return false;
 }
 
 }
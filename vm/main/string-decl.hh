@@ -39,21 +39,33 @@ namespace mozart {
 #include "String-implem-decl.hh"
 #endif
 
-class String: public DataType<String>, WithValueBehavior {
+class String: public DataType<String>,
+  public RopeHelper<String, nchar>, WithValueBehavior {
 public:
   static constexpr UUID uuid = "{163123b5-feaa-4e1d-8917-f74d81e11236}";
 
   static atom_t getTypeAtom(VM vm) {
-    return vm->getAtom(MOZART_STR("unicodeString"));
+    return vm->coreatoms.typeUnicodeString;
   }
 
-  String(VM vm, const LString<nchar>& string) : _string(string) {}
+  inline
+  String(VM vm, const LString<nchar>& string);
+
+  inline
+  String(VM vm, StableNode* left, StableNode* right);
 
   inline
   String(VM vm, GR gr, String& self);
 
 public:
-  const LString<nchar>& value() const { return _string; }
+  const LString<nchar>& value(VM vm) {
+    flatten(vm);
+    return _string;
+  }
+
+  bool isASCII() {
+    return _isASCII;
+  }
 
   inline
   bool equals(VM vm, RichNode right);
@@ -95,6 +107,11 @@ public:
   void stringSearch(RichNode self, VM vm, RichNode from, RichNode needle,
                     UnstableNode& begin, UnstableNode& end);
 
+  // Search for all the occurrences of a string or a character.
+  inline
+  UnstableNode stringSearchAll(RichNode self, VM vm, RichNode from,
+                               RichNode needle);
+
   inline
   bool stringHasPrefix(VM vm, RichNode prefix);
 
@@ -121,8 +138,50 @@ public:
   inline
   void printReprToStream(VM vm, std::ostream& out, int depth, int width);
 
+private:
+  friend class RopeHelper<String, nchar>;
+
+  LString<nchar>& ropeContents() {
+    return _string;
+  }
+
+private:
+  // Needle of a search: either a code point, encoded into utf, or a string
+  inline
+  mut::BaseLString<nchar> getSearchNeedle(VM vm, RichNode needleNode,
+                                          nchar (&utf)[4]);
+
+private:
+  // Code point indexing
+
+  /* ASCII strings are indexed directly. Other strings lazily build a sparse
+   * index holding the byte offset of every codePointIndexStep-th code point,
+   * so that finding a code point never scans more than one step.
+   */
+
+  static constexpr nativeint codePointIndexStep = 64;
+
+  /** Raises a unicode error if the string is not valid */
+  inline
+  nativeint getCodePointCount(RichNode self, VM vm);
+
+  /**
+   * Byte offset of the code point at the given index. An index equal to the
+   * number of code points gives the length of the string. Returns -1 if the
+   * index is out of bounds.
+   */
+  inline
+  nativeint getCodePointOffset(RichNode self, VM vm, nativeint index);
+
+  inline
+  void buildCodePointIndex(RichNode self, VM vm);
+
 private:
   LString<nchar> _string;
+
+  bool _isASCII;
+  nativeint _codePointCount;              // -1 until the index is built
+  StaticArray<nativeint> _codePointIndex; // null for ASCII strings
 };
 
 #ifndef MOZART_GENERATOR
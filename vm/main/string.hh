@@ -40,17 +40,52 @@ namespace mozart {
 
 // Core methods ----------------------------------------------------------------
 
+String::String(VM vm, const LString<nchar>& string)
+  : _string(string), _codePointCount(-1) {
+
+  _isASCII = !string.isError() &&
+    std::all_of(string.begin(), string.end(), [](nchar c) {
+      return (unsigned char) c < 0x80;
+    });
+
+  if (_isASCII)
+    _codePointCount = string.length;
+}
+
+String::String(VM vm, StableNode* left, StableNode* right)
+  : RopeHelper(vm, left, right), _string(nullptr), _codePointCount(-1) {
+
+  _isASCII = RichNode(*left).as<String>().isASCII() &&
+    RichNode(*right).as<String>().isASCII();
+
+  if (_isASCII)
+    _codePointCount = length();
+}
+
 String::String(VM vm, GR gr, String& from)
-  : _string(vm, from._string) {
+  : RopeHelper(vm, gr, from),
+    _string(vm, from._string), _isASCII(from._isASCII),
+    _codePointCount(from._codePointCount) {
+
+  // Keep the index across garbage collections
+  if (from._codePointIndex != nullptr) {
+    nativeint entries =
+      (_codePointCount + codePointIndexStep - 1) / codePointIndexStep;
+    _codePointIndex = vm->newStaticArray<nativeint>(entries);
+    std::copy((nativeint*) from._codePointIndex,
+              (nativeint*) from._codePointIndex + entries,
+              (nativeint*) _codePointIndex);
+  }
 }
 
 bool String::equals(VM vm, RichNode right) {
-  return value() == right.as<String>().value();
+  return value(vm) == right.as<String>().value(vm);
 }
 
 // Comparable ------------------------------------------------------------------
 
 int String::compare(VM vm, RichNode right) {
+  flatten(vm);
   auto rightString = StringLike(right).stringGet(vm);
   return compareByCodePoint(_string, *rightString);
 }
@@ -58,6 +93,7 @@ int String::compare(VM vm, RichNode right) {
 // StringLike ------------------------------------------------------------------
 
 LString<nchar>* String::stringGet(VM vm) {
+  flatten(vm);
   return &_string;
 }
 
@@ -68,17 +104,18 @@ LString<unsigned char>* String::byteStringGet(RichNode self, VM vm) {
 nativeint String::stringCharAt(RichNode self, VM vm, RichNode indexNode) {
   auto index = getArgument<nativeint>(vm, indexNode);
 
-  LString<nchar> slice = sliceByCodePointsFromTo(_string, index, index+1);
-  if (slice.isError()) {
-    if (slice.error == UnicodeErrorReason::indexOutOfBounds)
-      raiseIndexOutOfBounds(vm, indexNode, self);
-    else
-      raiseUnicodeError(vm, slice.error, self);
-  }
+  flatten(vm);
+  nativeint offset = getCodePointOffset(self, vm, index);
+  if ((offset < 0) || (offset >= _string.length))
+    raiseIndexOutOfBounds(vm, indexNode, self);
+
+  if (_isASCII)
+    return (unsigned char) _string.string[offset];
 
   char32_t codePoint;
   nativeint length;
-  std::tie(codePoint, length) = fromUTF(slice.string, slice.length);
+  std::tie(codePoint, length) = fromUTF(_string.string + offset,
+                                        _string.length - offset);
   if (length <= 0)
     raiseUnicodeError(vm, (UnicodeErrorReason) length, self, indexNode);
 
@@ -86,6 +123,10 @@ nativeint String::stringCharAt(RichNode self, VM vm, RichNode indexNode) {
 }
 
 UnstableNode String::stringAppend(RichNode self, VM vm, RichNode right) {
+  if (right.is<String>())
+    return concat(vm, self, right);
+
+  flatten(vm);
   auto rightString = StringLike(right).stringGet(vm);
   auto resultString = concatLString(vm, _string, *rightString);
 
@@ -100,17 +141,35 @@ UnstableNode String::stringSlice(RichNode self, VM vm,
   auto fromIndex = getArgument<nativeint>(vm, from);
   auto toIndex = getArgument<nativeint>(vm, to);
 
-  LString<nchar> resultString =
-    sliceByCodePointsFromTo(_string, fromIndex, toIndex);
+  if (toIndex < fromIndex)
+    raiseIndexOutOfBounds(vm, self, from, to);
 
-  if (resultString.isError()) {
-    if (resultString.error == UnicodeErrorReason::indexOutOfBounds)
-      raiseIndexOutOfBounds(vm, self, from, to);
-    else
-      raiseUnicodeError(vm, resultString.error, self);
-  }
+  flatten(vm);
 
-  return String::build(vm, resultString);
+  nativeint fromOffset = getCodePointOffset(self, vm, fromIndex);
+  nativeint toOffset = getCodePointOffset(self, vm, toIndex);
+  if ((fromOffset < 0) || (toOffset < 0))
+    raiseIndexOutOfBounds(vm, self, from, to);
+
+  return String::build(vm, _string.slice(fromOffset, toOffset));
+}
+
+mut::BaseLString<nchar> String::getSearchNeedle(VM vm, RichNode needleNode,
+                                                nchar (&utf)[4]) {
+  using namespace patternmatching;
+
+  nativeint codePointInteger = 0;
+  if (matches(vm, needleNode, capture(codePointInteger))) {
+    char32_t codePoint = (char32_t) codePointInteger;
+    nativeint length = toUTF(codePoint, utf);
+    if (length <= 0)
+      raiseUnicodeError(vm, (UnicodeErrorReason) length, needleNode);
+
+    return mut::BaseLString<nchar>(utf, length);
+  } else {
+    auto needle = StringLike(needleNode).stringGet(vm);
+    return mut::BaseLString<nchar>(needle->string, needle->length);
+  }
 }
 
 void String::stringSearch(RichNode self, VM vm, RichNode from,
@@ -119,65 +178,77 @@ void String::stringSearch(RichNode self, VM vm, RichNode from,
   auto fromIndex = getArgument<nativeint>(vm, from);
 
   nchar utf[4];
-  mut::BaseLString<nchar> needleStorage;
-  BaseLString<nchar>* needle;
-
-  // Extract the needle. Could be a code point, or a string.
-  {
-    using namespace patternmatching;
-    nativeint codePointInteger = 0;
-    if (matches(vm, needleNode, capture(codePointInteger))) {
-
-      char32_t codePoint = (char32_t) codePointInteger;
-      nativeint length = toUTF(codePoint, utf);
-      if (length <= 0)
-        raiseUnicodeError(vm, (UnicodeErrorReason) length, needleNode);
-
-      needle = new (&needleStorage) BaseLString<nchar>(utf, length);
-
-#ifdef _LIBCPP_TYPE_TRAITS
-      static_assert(std::is_trivially_destructible<BaseLString<nchar>>::value,
-                    "BaseLString<nchar> has been modified to have non-trivial "
-                    "destructor! Please rewrite this piece of code to avoid "
-                    "resource leak.");
-      // ^ BaseLString<nchar> has trivial destructor, so we shouldn't need to
-      //   explicitly destroy it.
-      //   Note: libstdc++ before 4.8 still calls it 'std::has_trivial_destructor'.
-#endif
-
-    } else {
-      needle = StringLike(needleNode).stringGet(vm);
-    }
-  }
+  auto needle = getSearchNeedle(vm, needleNode, utf);
 
   // Do the actual searching.
-  LString<nchar> haystack = sliceByCodePointsFrom(_string, fromIndex);
-
-  if (haystack.isError()) {
-    if (haystack.error == UnicodeErrorReason::indexOutOfBounds)
-      raiseIndexOutOfBounds(vm, self, from);
-    else
-      raiseUnicodeError(vm, haystack.error, self);
-  }
+  flatten(vm);
+  nativeint fromOffset = getCodePointOffset(self, vm, fromIndex);
+  if (fromOffset < 0)
+    raiseIndexOutOfBounds(vm, self, from);
 
-  const nchar* foundIter = std::search(haystack.begin(), haystack.end(),
-                                       needle->begin(), needle->end());
+  LString<nchar> haystack = _string.slice(fromOffset);
+  nativeint foundOffset = searchLString(haystack, needle);
 
   // Make result
-  if (foundIter == haystack.end()) {
+  if (foundOffset < 0) {
     begin = Boolean::build(vm, false);
     end = Boolean::build(vm, false);
+  } else if (_isASCII) {
+    // Offsets are indices, and the needle is ASCII as well
+    nativeint foundIndex = fromOffset + foundOffset;
+
+    begin = SmallInt::build(vm, foundIndex);
+    end = SmallInt::build(vm, foundIndex + needle.length);
   } else {
-    LString<nchar> haystackUntilNeedle =
-      haystack.slice(0, foundIter-haystack.begin());
-    nativeint foundIndex = fromIndex + codePointCount(haystackUntilNeedle);
+    // Only count the code points we have just scanned
+    nativeint foundIndex =
+      fromIndex + codePointCount(haystack.slice(0, foundOffset));
 
     begin = SmallInt::build(vm, foundIndex);
-    end = SmallInt::build(vm, foundIndex + codePointCount(*needle));
+    end = SmallInt::build(vm, foundIndex + codePointCount(needle));
+  }
+}
+
+UnstableNode String::stringSearchAll(RichNode self, VM vm, RichNode from,
+                                     RichNode needleNode) {
+  auto fromIndex = getArgument<nativeint>(vm, from);
+
+  nchar utf[4];
+  auto needle = getSearchNeedle(vm, needleNode, utf);
+  if (needle.length == 0)
+    raiseTypeError(vm, MOZART_STR("Non-empty String or character"),
+                   needleNode);
+
+  flatten(vm);
+  nativeint offset = getCodePointOffset(self, vm, fromIndex);
+  if (offset < 0)
+    raiseIndexOutOfBounds(vm, self, from);
+
+  // Occurrences do not overlap. Like in stringSearch, only the code points
+  // between two occurrences are counted.
+  nativeint needleCodePoints = codePointCount(needle);
+  nativeint index = fromIndex;
+  OzListBuilder result(vm);
+
+  while (true) {
+    LString<nchar> haystack = _string.slice(offset);
+    nativeint foundOffset = searchLString(haystack, needle);
+    if (foundOffset < 0)
+      break;
+
+    index += _isASCII ? foundOffset
+                      : codePointCount(haystack.slice(0, foundOffset));
+    result.push_back(vm, index);
+
+    index += needleCodePoints;
+    offset += foundOffset + needle.length;
   }
+
+  return result.get(vm);
 }
 
 bool String::stringHasPrefix(VM vm, RichNode prefixNode) {
+  flatten(vm);
   auto prefix = StringLike(prefixNode).stringGet(vm);
   if (_string.length < prefix->length)
     return false;
@@ -186,6 +257,7 @@ bool String::stringHasPrefix(VM vm, RichNode prefixNode) {
 }
 
 bool String::stringHasSuffix(VM vm, RichNode suffixNode) {
+  flatten(vm);
   auto suffix = StringLike(suffixNode).stringGet(vm);
   if (_string.length < suffix->length)
     return false;
@@ -213,18 +285,15 @@ bool String::lookupFeature(RichNode self, VM vm, RichNode feature,
 
 bool String::lookupFeature(RichNode self, VM vm, nativeint feature,
                            nullable<UnstableNode&> value) {
-  LString<nchar> slice = sliceByCodePointsFromTo(_string, feature, feature+1);
-  if (slice.isError()) {
-    if (slice.error == UnicodeErrorReason::indexOutOfBounds) {
-      return false;
-    } else {
-      raiseUnicodeError(vm, slice.error, self);
-    }
-  }
+  flatten(vm);
+  nativeint offset = getCodePointOffset(self, vm, feature);
+  if ((offset < 0) || (offset >= _string.length))
+    return false;
 
   char32_t codePoint;
   nativeint length;
-  std::tie(codePoint, length) = fromUTF(slice.string, slice.length);
+  std::tie(codePoint, length) = fromUTF(_string.string + offset,
+                                        _string.length - offset);
   if (length <= 0)
     raiseUnicodeError(vm, (UnicodeErrorReason) length, self, feature);
 
@@ -236,9 +305,76 @@ bool String::lookupFeature(RichNode self, VM vm, nativeint feature,
 // Miscellaneous ---------------------------------------------------------------
 
 void String::printReprToStream(VM vm, std::ostream& out, int depth, int width) {
+  flatten(vm);
   out << '"' << toUTF<char>(_string) << '"';
 }
 
+// Code point indexing ---------------------------------------------------------
+
+nativeint String::getCodePointCount(RichNode self, VM vm) {
+  if (_codePointCount < 0)
+    buildCodePointIndex(self, vm);
+  return _codePointCount;
+}
+
+nativeint String::getCodePointOffset(RichNode self, VM vm, nativeint index) {
+  if ((index < 0) || (index > getCodePointCount(self, vm)))
+    return -1;
+
+  if (_isASCII)
+    return index;
+
+  if (index == _codePointCount)
+    return _string.length;
+
+  // Start from the closest indexed code point, at most one step before
+  const nchar* iter =
+    _string.begin() + _codePointIndex[(size_t) (index / codePointIndexStep)];
+
+  for (nativeint count = index % codePointIndexStep; count > 0; ) {
+    if (isLeadingCodeUnit(*++iter))
+      --count;
+  }
+
+  return iter - _string.begin();
+}
+
+void String::buildCodePointIndex(RichNode self, VM vm) {
+  assert(!_isASCII && !isRope());
+
+  if (_string.isError())
+    raiseUnicodeError(vm, _string.error, self);
+
+  // Validate the contents while counting, so that invalid strings are
+  // reported here rather than as out of bounds indices
+  nativeint count = 0;
+  for (nativeint offset = 0; offset < _string.length; count++) {
+    nativeint length = fromUTF(_string.string + offset,
+                               _string.length - offset).second;
+    if (length <= 0)
+      raiseUnicodeError(vm, (UnicodeErrorReason) length, self);
+    offset += length;
+  }
+
+  nativeint entries = (count + codePointIndexStep - 1) / codePointIndexStep;
+
+  if (entries > 0) {
+    _codePointIndex = vm->newStaticArray<nativeint>(entries);
+
+    nativeint codePoint = 0;
+    for (nativeint i = 0; i < _string.length; i++) {
+      if (isLeadingCodeUnit(_string.string[i])) {
+        if (codePoint % codePointIndexStep == 0)
+          _codePointIndex[(size_t) (codePoint / codePointIndexStep)] = i;
+        codePoint++;
+      }
+    }
+  }
+
+  // Cached from now on, since only valid strings get here
+  _codePointCount = count;
+}
+
 }
 
 #endif // MOZART_GENERATOR
@@ -96,8 +96,29 @@ void unify(VM vm, RichNode left, RichNode right) {
     }
   } else if (rightBehavior == sbVariable) {
     DataflowVariable(right).bind(vm, left);
+  } else if (leftType != rightType) {
+    fail(vm);
   } else {
-    fullUnify(vm, left, right);
+    /* Both are non-var values of the same type. Only structural pairs
+     * actually need the full walk (and its setjmp-based handler).
+     */
+    switch (leftBehavior) {
+      case sbValue: {
+        if (!ValueEquatable(left).equals(vm, right))
+          fail(vm);
+        break;
+      }
+
+      case sbTokenEq: {
+        fail(vm); // left and right are not the same node
+        break;
+      }
+
+      default: {
+        fullUnify(vm, left, right);
+        break;
+      }
+    }
   }
 }
 
@@ -131,6 +152,36 @@ bool equals(VM vm, RichNode left, RichNode right) {
 
 bool patternMatch(VM vm, RichNode value, RichNode pattern,
                   StaticArray<UnstableNode> captures) {
+  if (value.isSameNode(pattern))
+    return true;
+
+  auto valueType = value.type();
+  auto patternType = pattern.type();
+
+  // Captures, conjunctions and open records need the full walk
+  if ((patternType == PatMatCapture::type()) ||
+      (patternType == PatMatConjunction::type()) ||
+      (patternType == PatMatOpenRecord::type()))
+    return fullPatternMatch(vm, value, pattern, captures);
+
+  StructuralBehavior valueBehavior = valueType.getStructuralBehavior();
+  StructuralBehavior patternBehavior = patternType.getStructuralBehavior();
+
+  if (valueBehavior != sbVariable && patternBehavior != sbVariable) {
+    if (valueType != patternType)
+      return false;
+
+    switch (valueBehavior) {
+      case sbValue:
+        return ValueEquatable(value).equals(vm, pattern);
+
+      case sbTokenEq:
+        return false;
+
+      default: ; // fall through
+    }
+  }
+
   return fullPatternMatch(vm, value, pattern, captures);
 }
 
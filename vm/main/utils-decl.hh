@@ -27,6 +27,8 @@
 
 #include "mozartcore-decl.hh"
 
+#include "chunkedbuffer.hh"
+
 namespace mozart {
 
 ///////////////////////////////////////////////////////
@@ -167,6 +169,12 @@ template <typename C>
 inline
 bool ozVBSGetNoRaise(VM vm, RichNode vbs, std::vector<C>& output);
 
+inline
+bool ozVSWriteNoRaise(VM vm, RichNode vs, ChunkedBuffer& output);
+
+inline
+bool ozVBSWriteNoRaise(VM vm, RichNode vbs, ChunkedBuffer& output);
+
 // Regular public API
 
 inline
@@ -228,6 +236,12 @@ void ozVBSGet(VM vm, RichNode vbs, size_t bufSize, std::vector<C>& output);
 inline
 size_t ozVBSLength(VM vm, RichNode vs);
 
+inline
+void ozVSWrite(VM vm, RichNode vs, ChunkedBuffer& output);
+
+inline
+void ozVBSWrite(VM vm, RichNode vbs, ChunkedBuffer& output);
+
 ////////////////////////////////
 // Port-like usage of streams //
 ////////////////////////////////
@@ -389,7 +389,7 @@ nativeint ozVSLengthForBufferNoRaise(VM vm, RichNode vs) {
     else
       return -1;
   } else if (vs.is<String>()) {
-    return vs.as<String>().value().length;
+    return vs.as<String>().length();
   } else if (matches(vm, vs, capture(intValue))) {
     return getIntToStrBufferSize();
   } else if (matches(vm, vs, capture(floatValue))) {
@@ -437,7 +437,7 @@ bool ozVSGetNoRaise(VM vm, RichNode vs, std::vector<nchar>& output) {
       }
     );
   } else if (vs.is<String>()) {
-    auto& value = vs.as<String>().value();
+    auto& value = vs.as<String>().value(vm);
     std::copy(value.begin(), value.end(), std::back_inserter(output));
     return true;
   } else if (matches(vm, vs, capture(intValue))) {
@@ -486,7 +486,7 @@ nativeint ozVBSLengthForBufferNoRaise(VM vm, RichNode vbs) {
   } else if (matches(vm, vbs, vm->coreatoms.nil)) {
     return 0;
   } else if (vbs.is<ByteString>()) {
-    return vbs.as<ByteString>().value().length;
+    return vbs.as<ByteString>().length();
   } else {
     return -1;
   }
@@ -521,8 +521,88 @@ bool ozVBSGetNoRaise(VM vm, RichNode vbs, std::vector<C>& output) {
   } else if (matches(vm, vbs, vm->coreatoms.nil)) {
     return true;
   } else if (vbs.is<ByteString>()) {
-    auto& value = vbs.as<ByteString>().value();
-    std::copy(value.begin(), value.end(), std::back_inserter(output));
+    auto& value = vbs.as<ByteString>().value(vm);
+    output.insert(output.end(), value.begin(), value.end());
+    return true;
+  } else {
+    return false;
+  }
+}
+
+inline
+bool ozVSWriteNoRaise(VM vm, RichNode vs, ChunkedBuffer& output) {
+  using namespace internal;
+  using namespace patternmatching;
+
+  size_t partCount;
+  StaticArray<StableNode> parts;
+
+  atom_t atomValue;
+  nativeint intValue;
+  double floatValue;
+
+  if (matchesVariadicSharp(vm, vs, partCount, parts)) {
+    for (size_t i = 0; i < partCount; ++i) {
+      if (!ozVSWriteNoRaise(vm, parts[i], output))
+        return false;
+    }
+    return true;
+  } else if (matches(vm, vs, capture(atomValue))) {
+    if (atomValue != vm->coreatoms.nil)
+      output.append(atomValue.contents(), atomValue.length());
+    return true;
+  } else if (matchesCons(vm, vs, wildcard(), wildcard())) {
+    return ozListForEachNoRaise(vm, vs,
+      [vm, &output] (char32_t c) {
+        nchar buffer[4];
+        nativeint length = toUTF(c, buffer);
+        output.append(buffer, length);
+      }
+    );
+  } else if (vs.is<String>()) {
+    auto& value = vs.as<String>().value(vm);
+    output.append(value.string, value.length);
+    return true;
+  } else if (matches(vm, vs, capture(intValue))) {
+    IntToStrBuffer buffer;
+    auto length = intToStrBuffer(buffer, intValue);
+    output.append(buffer, length);
+    return true;
+  } else if (matches(vm, vs, capture(floatValue))) {
+    FloatToStrBuffer buffer;
+    auto length = floatToStrBuffer(buffer, floatValue);
+    output.append(buffer, length);
+    return true;
+  } else {
+    return false;
+  }
+}
+
+inline
+bool ozVBSWriteNoRaise(VM vm, RichNode vbs, ChunkedBuffer& output) {
+  using namespace internal;
+  using namespace patternmatching;
+
+  size_t partCount;
+  StaticArray<StableNode> parts;
+
+  if (matchesVariadicSharp(vm, vbs, partCount, parts)) {
+    for (size_t i = 0; i < partCount; ++i) {
+      if (!ozVBSWriteNoRaise(vm, parts[i], output))
+        return false;
+    }
+    return true;
+  } else if (matchesCons(vm, vbs, wildcard(), wildcard())) {
+    return ozListForEachNoRaise(vm, vbs,
+      [&output] (unsigned char b) {
+        output.push_back((char) b);
+      }
+    );
+  } else if (matches(vm, vbs, vm->coreatoms.nil)) {
+    return true;
+  } else if (vbs.is<ByteString>()) {
+    auto& value = vbs.as<ByteString>().value(vm);
+    output.append(value.string, value.length);
     return true;
   } else {
     return false;
@@ -709,6 +789,26 @@ size_t ozVBSLength(VM vm, RichNode vs) {
   return ozVBSLengthForBuffer(vm, vs);
 }
 
+/**
+ * Write a VirtualString to a chunked buffer, in a single pass over it
+ * Unlike ozVSGet(), this may throw Mozart exceptions after having written
+ * part of vs. The output must hence outlive the current builtin call, so that
+ * nothing leaks, and the partial output be dropped before it is used again.
+ */
+void ozVSWrite(VM vm, RichNode vs, ChunkedBuffer& output) {
+  if (!ozVSWriteNoRaise(vm, vs, output))
+    raiseTypeError(vm, MOZART_STR("VirtualString"), vs);
+}
+
+/**
+ * Write a VirtualByteString to a chunked buffer, in a single pass over it
+ * The same caveats as for ozVSWrite() apply.
+ */
+void ozVBSWrite(VM vm, RichNode vbs, ChunkedBuffer& output) {
+  if (!ozVBSWriteNoRaise(vm, vbs, output))
+    raiseTypeError(vm, MOZART_STR("VirtualByteString"), vbs);
+}
+
 ////////////////////////////////
 // Port-like usage of streams //
 ////////////////////////////////
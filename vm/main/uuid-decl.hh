@@ -113,6 +113,15 @@ public:
   constexpr bool is_nil() const {
     return (data0 == 0) && (data1 == 0);
   }
+
+  /** Hash code, well mixed even for UUIDs that differ in a few bits only */
+  std::uint64_t hash() const {
+    std::uint64_t h = data0 ^ (data1 * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    return h;
+  }
 public:
   void toBytes(unsigned char* bytes) const {
     storeUInt64ToBytes(data0, bytes);
@@ -25,6 +25,7 @@
 #ifndef __VM_DECL_H
 #define __VM_DECL_H
 
+#include <atomic>
 #include <cstdlib>
 #include <forward_list>
 
@@ -41,8 +42,11 @@
 #include "vmallocatedlist-decl.hh"
 
 #include "atomtable.hh"
+#include "alarmqueue.hh"
+#include "chunkedbuffer.hh"
 #include "coreatoms-decl.hh"
 #include "properties-decl.hh"
+#include "profiler-decl.hh"
 
 namespace mozart {
 
@@ -113,14 +117,6 @@ public:
   };
 
   typedef std::pair<RunExitCode, std::int64_t> run_return_type;
-private:
-  struct AlarmRecord {
-    AlarmRecord(std::int64_t expiration, StableNode* wakeable):
-      expiration(expiration), wakeable(wakeable) {}
-
-    std::int64_t expiration;
-    StableNode* wakeable;
-  };
 public:
   inline
   VirtualMachine(VirtualMachineEnvironment& environment);
@@ -140,8 +136,16 @@ public:
 
   template <class T>
   StaticArray<T> newStaticArray(size_t size) {
-    void* memory = malloc(size * sizeof(T));
-    return StaticArray<T>(static_cast<T*>(memory), size);
+    if (!_allocationProfiler.isActive()) {
+      void* memory = malloc(size * sizeof(T));
+      return StaticArray<T>(static_cast<T*>(memory), size);
+    } else {
+      size_t scope = _allocationProfiler.enterScope();
+      void* memory = malloc(size * sizeof(T));
+      _allocationProfiler.recordStaticArray(
+        this, _allocationProfiler.leaveScope(scope));
+      return StaticArray<T>(static_cast<T*>(memory), size);
+    }
   }
 
   template <class T>
@@ -175,6 +179,10 @@ public:
     return secondMemoryManager;
   }
 
+  GarbageCollector& getGarbageCollector() {
+    return gc;
+  }
+
   GlobalExceptionMechanism& getGlobalExceptionMechanism() {
     return exceptionMechanism;
   }
@@ -231,6 +239,22 @@ public:
     return _propertyRegistry;
   }
 
+  Profiler& getProfiler() {
+    return _profiler;
+  }
+
+  AllocationProfiler& getAllocationProfiler() {
+    return _allocationProfiler;
+  }
+
+  /**
+   * Scratch buffer for builtins that write VirtualStrings to an output with
+   * ozVSWrite() or ozVBSWrite(). Clear it before using it.
+   */
+  ChunkedBuffer& getOutputBuffer() {
+    return _outputBuffer;
+  }
+
   inline
   UUID genUUID();
 
@@ -238,8 +262,15 @@ public:
     return _referenceTime;
   }
 
-  inline
-  void setAlarm(std::int64_t delay, StableNode* wakeable);
+  /** Wake up wakeable when delay milliseconds have elapsed */
+  AlarmHandle setAlarm(std::int64_t delay, StableNode* wakeable) {
+    return _alarms.insert(_referenceTime + delay, wakeable);
+  }
+
+  /** Cancel an alarm; returns false if it had already fired */
+  bool cancelAlarm(AlarmHandle alarm) {
+    return _alarms.cancel(alarm);
+  }
 public:
   CoreAtoms coreatoms;
 
@@ -265,10 +296,27 @@ public:
   template <typename T>
   inline
   ProtectedNode protect(T&& node);
+
+  /** Protect a node from the GC until releaseProtectedSlot() is called.
+   *  This is cheaper than protect(), as there is no reference counting, but
+   *  it must only be used from the thread that runs this VM.
+   */
+  template <typename T>
+  inline
+  ProtectedSlot protectInSlot(T&& node);
+
+  StableNode& getProtectedSlot(ProtectedSlot slot) {
+    return *_protectedSlots.get(slot);
+  }
+
+  void releaseProtectedSlot(ProtectedSlot slot) {
+    _protectedSlots.release(slot);
+  }
 public:
-  // Influence from the external world
+  // Influence from the external world, safe to call from any thread
   void requestPreempt() {
     _preemptRequested = true;
+    _profiler.requestSample();
   }
 
   void requestExitRun() {
@@ -327,7 +375,7 @@ private:
 
   ThreadPool threadPool;
   AtomTable atomTable;
-  GlobalNode* rootGlobalNode;
+  GlobalNodeTable globalNodes;
 
   VirtualMachineEnvironment& environment;
 
@@ -343,6 +391,10 @@ private:
 
   NodeDictionary* _builtinModules;
   PropertyRegistry _propertyRegistry;
+  Profiler _profiler;
+  AllocationProfiler _allocationProfiler;
+
+  ChunkedBuffer _outputBuffer;
 
   RunnableList aliveThreads;
   VMCleanupListNode* _cleanupList;
@@ -350,16 +402,16 @@ private:
   GarbageCollector gc;
   SpaceCloner sc;
 
-  VMAllocatedList<AlarmRecord> _alarms;
+  AlarmQueue _alarms;
   std::forward_list<std::weak_ptr<StableNode*>> _protectedNodes;
+  ProtectedSlotTable _protectedSlots;
 
-  // Flags set externally for preemption etc.
-  // TODO Use atomic data types
+  // Flags set externally for preemption etc., possibly from other threads
   bool _envUseDynamicPreemption;
-  volatile bool _preemptRequested;
-  volatile bool _exitRunRequested;
-  volatile bool _gcRequested;
-  volatile std::int64_t _referenceTime;
+  std::atomic<bool> _preemptRequested;
+  std::atomic<bool> _exitRunRequested;
+  std::atomic<bool> _gcRequested;
+  std::atomic<std::int64_t> _referenceTime;
 
   // During GC, we need a SpaceRef version of the top-level space
   SpaceRef _topLevelSpaceRef;
@@ -40,14 +40,14 @@ VirtualMachine::run_return_type VirtualMachine::run() {
       _gcRequested = false;
     }
 
-    // Trigger alarms
+    // Trigger alarms, all the expired ones at once
     std::int64_t now = _referenceTime;
-    while (!_alarms.empty() && (_alarms.front().expiration <= now)) {
+    if (!_alarms.empty() && (_alarms.nextExpiration() <= now)) {
       getTopLevelSpace()->install();
 
-      Wakeable(*_alarms.front().wakeable).wakeUp(this);
-
-      _alarms.remove_front(this);
+      do {
+        Wakeable(*_alarms.popFront()).wakeUp(this);
+      } while (!_alarms.empty() && (_alarms.nextExpiration() <= now));
     }
 
     // Select a thread
@@ -91,7 +91,7 @@ VirtualMachine::run_return_type VirtualMachine::run() {
   else if (_alarms.empty())
     return run_return_type(recNeverInvokeAgain, 0);
   else
-    return run_return_type(recInvokeAgainLater, _alarms.front().expiration);
+    return run_return_type(recInvokeAgainLater, _alarms.nextExpiration());
 }
 
 }
@@ -50,7 +50,8 @@ void BuiltinModule::initModule(VM vm, T&& module) {
 void registerCoreModules(VM vm);
 
 VirtualMachine::VirtualMachine(VirtualMachineEnvironment& environment):
-  rootGlobalNode(nullptr), environment(environment), gc(this), sc(this) {
+  environment(environment), _allocationProfiler(memoryManager),
+  gc(this), sc(this) {
 
   memoryManager.init();
 
@@ -129,16 +130,6 @@ UUID VirtualMachine::genUUID() {
   return environment.genUUID();
 }
 
-void VirtualMachine::setAlarm(std::int64_t delay, StableNode* wakeable) {
-  std::int64_t expiration = _referenceTime + delay;
-
-  auto iter = _alarms.removable_begin();
-  while ((iter != _alarms.removable_end()) && (iter->expiration < expiration))
-    ++iter;
-
-  _alarms.insert_before_new(this, iter, expiration, wakeable);
-}
-
 template <typename T>
 ProtectedNode VirtualMachine::protect(T&& node) {
   /* Yes, it must always be a *new* StableNode, otherwise protecting twice
@@ -150,6 +141,13 @@ ProtectedNode VirtualMachine::protect(T&& node) {
   return ProtectedNode(std::move(result));
 }
 
+template <typename T>
+ProtectedSlot VirtualMachine::protectInSlot(T&& node) {
+  // A new StableNode, for the same reason as in protect()
+  return _protectedSlots.acquire(
+    new (this) StableNode(this, std::forward<T>(node)));
+}
+
 void VirtualMachine::initialize() {
   coreatoms.initialize(this, atomTable);
 }
@@ -185,17 +183,14 @@ void VirtualMachine::afterGR(GR gr) {
 }
 
 void VirtualMachine::startGC(GC gc) {
-  VMAllocatedList<AlarmRecord> alarms = std::move(_alarms);
-
   // Swap spaces
   getMemoryManager().swapWith(getSecondMemoryManager());
   getMemoryManager().init();
 
-  // Forget lists of things
-  atomTable = AtomTable();
+  // Forget lists of things; atoms are marked instead, and swept after GC
+  atomTable.startMarking();
   aliveThreads = RunnableList();
-  _alarms = VMAllocatedList<AlarmRecord>();
-  rootGlobalNode = nullptr;
+  globalNodes.clear();
 
   // Reinitialize the VM
   initialize();
@@ -209,17 +204,20 @@ void VirtualMachine::startGC(GC gc) {
   _builtinModules = new (this) NodeDictionary(gc, *_builtinModules);
   _propertyRegistry.gCollect(gc);
 
+  // Profiler caches
+  _profiler.gCollect(gc);
+  _allocationProfiler.gCollect(gc);
+
   // Runnable threads
   getThreadPool().gCollect(gc);
 
   // Protected nodes
   gcProtectedNodes(gc);
 
-  // Pending alarms
-  for (auto iter = alarms.begin(); iter != alarms.end(); ++iter) {
-    _alarms.push_back_new(this, iter->expiration, iter->wakeable);
-    gc->copyStableRef(_alarms.back().wakeable, _alarms.back().wakeable);
-  }
+  // Pending alarms, which keep their order
+  _alarms.forEachWakeable([gc] (StableNode*& wakeable) {
+    gc->copyStableRef(wakeable, wakeable);
+  });
 
   // Environmental roots
   environment.gCollect(gc);
@@ -231,6 +229,8 @@ void VirtualMachine::gcProtectedNodes(GC gc) {
    *
    * Elements that are not referenced anymore are erased from the list of
    * protected nodes.
+   *
+   * The slot table only holds nodes that have not been released yet.
    */
 
   auto previous = _protectedNodes.before_begin();
@@ -247,6 +247,10 @@ void VirtualMachine::gcProtectedNodes(GC gc) {
       ++current;
     }
   }
+
+  _protectedSlots.forEach([gc] (StableNode*& node) {
+    gc->copyStableRef(node, node);
+  });
 }
 
 VMCleanupListNode* VirtualMachine::acquireCleanupList() {
@@ -262,6 +266,23 @@ void VirtualMachine::doCleanup(VMCleanupListNode* cleanupList) {
   }
 }
 
+// Hooks for the allocation profiler -------------------------------------------
+
+namespace internal {
+  bool isAllocationProfilerActive(VM vm) {
+    return vm->getAllocationProfiler().isActive();
+  }
+
+  size_t enterAllocationScope(VM vm) {
+    return vm->getAllocationProfiler().enterScope();
+  }
+
+  void recordNodeAllocation(VM vm, Type type, size_t scope) {
+    auto& profiler = vm->getAllocationProfiler();
+    profiler.recordNode(vm, type.info(), profiler.leaveScope(scope));
+  }
+}
+
 }
 
 // new operators must be declared outside of any namespace
@@ -39,6 +39,9 @@ namespace mozart {
 inline
 MemoryManager& virtualMMToActualMM(VM vm);
 
+inline
+void* mallocListNode(VM vm, size_t size);
+
 template <class T>
 class VMAllocatedList: public MemManagedList<T, VM> {
 };
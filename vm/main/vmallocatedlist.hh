@@ -38,6 +38,20 @@ MemoryManager& virtualMMToActualMM(VM vm) {
   return vm->getMemoryManager();
 }
 
+inline
+void* mallocListNode(VM vm, size_t size) {
+  auto& profiler = vm->getAllocationProfiler();
+
+  if (!profiler.isActive()) {
+    return vm->getMemoryManager().malloc(size);
+  } else {
+    size_t scope = profiler.enterScope();
+    void* result = vm->getMemoryManager().malloc(size);
+    profiler.recordListNode(vm, profiler.leaveScope(scope));
+    return result;
+  }
+}
+
 }
 
 #endif // __VMALLOCATEDLIST_H
@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include "testutils.hh"
 #include <string>
+#include <unordered_set>
 
 using namespace mozart;
 
@@ -51,3 +52,37 @@ TEST_F(AtomTest, SomeCoreAtoms) {
   UnstableNode sharpNodeB = Atom::build(vm, vm->coreatoms.sharp);
   EXPECT_TRUE(ValueEquatable(sharpNodeA).equals(vm, sharpNodeB));
 }
+
+TEST_F(AtomTest, TypeAtoms) {
+  EXPECT_TRUE(vm->getAtom(MOZART_STR("int")) ==
+              SmallInt::type()->getTypeAtom(vm));
+  EXPECT_TRUE(vm->getAtom(MOZART_STR("name")) ==
+              Boolean::type()->getTypeAtom(vm));
+  EXPECT_TRUE(vm->getAtom(MOZART_STR("unicodeString")) ==
+              String::type()->getTypeAtom(vm));
+}
+
+TEST_F(AtomTest, ManyAtoms) {
+  // Enough atoms to grow the hash index several times
+  const int count = 5000;
+  std::vector<atom_t> atoms;
+
+  for (int i = 0; i < count; i++) {
+    std::basic_string<nchar> name = MOZART_STR("atom");
+    for (int n = i; n > 0; n /= 10)
+      name += (nchar) ('0' + n % 10);
+    atoms.push_back(vm->getAtom(name.size(), name.data()));
+  }
+
+  for (int i = 0; i < count; i++) {
+    atom_t atom = atoms[i];
+    atom_t again = vm->getAtom(atom.length(), atom.contents());
+    EXPECT_TRUE(atom == again);
+    EXPECT_EQ(atom.hash(), again.hash());
+    if (i > 0)
+      EXPECT_FALSE(atom == atoms[i-1]);
+  }
+
+  std::unordered_set<atom_t> set(atoms.begin(), atoms.end());
+  EXPECT_EQ((size_t) count, set.size());
+}
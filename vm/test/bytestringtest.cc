@@ -35,25 +35,53 @@ TEST_F(ByteStringTest, Append) {
   UnstableNode b12i = StringLike(b1).stringAppend(vm, b2);
   RichNode b12 = b12i;
   if (EXPECT_IS<ByteString>(b12)) {
-    EXPECT_EQ(a12, b12.as<ByteString>().value());
+    EXPECT_EQ(a12, b12.as<ByteString>().value(vm));
   }
 
   UnstableNode b11i = StringLike(b1).stringAppend(vm, b1);
   RichNode b11 = b11i;
   if (EXPECT_IS<ByteString>(b11)) {
-    EXPECT_EQ(a11, b11.as<ByteString>().value());
+    EXPECT_EQ(a11, b11.as<ByteString>().value(vm));
   }
 
   UnstableNode b00i = StringLike(b0).stringAppend(vm, b0);
   RichNode b00 = b00i;
   if (EXPECT_IS<ByteString>(b00)) {
-    EXPECT_EQ(a0, b00.as<ByteString>().value());
+    EXPECT_EQ(a0, b00.as<ByteString>().value(vm));
   }
 
   UnstableNode b10i = StringLike(b1).stringAppend(vm, b0);
   RichNode b10 = b10i;
   if (EXPECT_IS<ByteString>(b10)) {
-    EXPECT_EQ(a1, b10.as<ByteString>().value());
+    EXPECT_EQ(a1, b10.as<ByteString>().value(vm));
+  }
+}
+
+TEST_F(ByteStringTest, AppendRope) {
+  // Appending many pieces builds a rope, flattened when first needed
+  std::vector<unsigned char> expected;
+  UnstableNode result = ByteString::build(vm, newLString(vm, expected));
+
+  for (int i = 0; i < 1000; i++) {
+    std::vector<unsigned char> piece(i % 7 + 1, (unsigned char) i);
+    expected.insert(expected.end(), piece.begin(), piece.end());
+
+    UnstableNode pieceNode = ByteString::build(vm, newLString(vm, piece));
+    result = StringLike(result).stringAppend(vm, pieceNode);
+  }
+
+  RichNode rope = result;
+  if (EXPECT_IS<ByteString>(rope)) {
+    EXPECT_TRUE(rope.as<ByteString>().isRope());
+    EXPECT_LT(rope.as<ByteString>().ropeHeight(), 32);
+    EXPECT_EQ((nativeint) expected.size(), rope.as<ByteString>().length());
+
+    UnstableNode index = SmallInt::build(vm, 1000);
+    EXPECT_EQ(expected[1000], StringLike(rope).stringCharAt(vm, index));
+    EXPECT_FALSE(rope.as<ByteString>().isRope());
+
+    EXPECT_EQ(makeLString(expected.data(), expected.size()),
+              rope.as<ByteString>().value(vm));
   }
 }
 
@@ -81,7 +109,7 @@ TEST_F(ByteStringTest, Slice) {
   result = StringLike(b).stringSlice(vm, two, four);
   if (EXPECT_IS<ByteString>(result)) {
     static const unsigned char res[] = "34";
-    EXPECT_EQ(makeLString(res), RichNode(result).as<ByteString>().value());
+    EXPECT_EQ(makeLString(res), RichNode(result).as<ByteString>().value(vm));
   }
 }
 
@@ -128,6 +156,45 @@ TEST_F(ByteStringTest, StrChr) {
                StringLike(b).stringSearch(vm, zero, char256, begin, end));
 }
 
+TEST_F(ByteStringTest, SearchAll) {
+  static const unsigned char a[] = "12321232";
+  static const unsigned char n[] = "232";
+  UnstableNode b = ByteString::build(vm, a);
+  UnstableNode needle = ByteString::build(vm, n);
+
+  UnstableNode zero = SmallInt::build(vm, 0);
+  UnstableNode two = SmallInt::build(vm, 2);
+  UnstableNode nine = SmallInt::build(vm, 9);
+  UnstableNode char2 = SmallInt::build(vm, '2');
+
+  auto indicesOf = [this] (UnstableNode list) {
+    std::vector<nativeint> result;
+    ozListForEach(vm, list, [&] (nativeint i) { result.push_back(i); },
+                  MOZART_STR("list"));
+    return result;
+  };
+
+  EXPECT_EQ((std::vector<nativeint> { 1, 3, 5, 7 }),
+            indicesOf(StringLike(b).stringSearchAll(vm, zero, char2)));
+  EXPECT_EQ((std::vector<nativeint> { 3, 5, 7 }),
+            indicesOf(StringLike(b).stringSearchAll(vm, two, char2)));
+
+  EXPECT_EQ((std::vector<nativeint> { 1, 5 }),
+            indicesOf(StringLike(b).stringSearchAll(vm, zero, needle)));
+  EXPECT_EQ((std::vector<nativeint> { 5 }),
+            indicesOf(StringLike(b).stringSearchAll(vm, two, needle)));
+
+  // Occurrences do not overlap
+  static const unsigned char c[] = "23232";
+  UnstableNode overlapping = ByteString::build(vm, c);
+  EXPECT_EQ((std::vector<nativeint> { 0 }),
+            indicesOf(StringLike(overlapping).stringSearchAll(vm, zero,
+                                                              needle)));
+
+  EXPECT_RAISE(MOZART_STR("indexOutOfBounds"),
+               StringLike(b).stringSearchAll(vm, nine, char2));
+}
+
 TEST_F(ByteStringTest, Compare) {
   static const unsigned char a[] = "\xff\xee\xdd";
   static const unsigned char b[] = "\xff\xee";
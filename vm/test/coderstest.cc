@@ -358,3 +358,77 @@ TEST_F(CodersTest, DecodeGeneric) {
   EXPECT_TRUE(
     decodeGeneric(b, ByteStringEncoding::utf32, EncodingVariant::none).isError());
 }
+
+TEST_F(CodersTest, LongMixedText) {
+  // Long enough to go through the vectorized paths, with non-ASCII
+  // characters at various offsets around the vector boundaries
+  std::vector<nchar> text;
+  for (size_t i = 0; i < 200; i++) {
+    text.push_back((nchar) ('a' + i % 26));
+    if (i % 37 == 15)
+      text.insert(text.end(), { '\xc3', '\xa9' });
+    if (i % 53 == 31)
+      text.insert(text.end(), { '\xf0', '\x9f', '\x98', '\x80' });
+  }
+  auto decoded = makeLString(text.data(), text.size());
+
+  ByteStringEncoding encodings[] = {
+    ByteStringEncoding::latin1, ByteStringEncoding::utf8,
+    ByteStringEncoding::utf16, ByteStringEncoding::utf32
+  };
+
+  for (auto encoding : encodings) {
+    for (int v = 0; v < 4; v++) {
+      auto variant = makeVariant((v & 1) != 0, (v & 2) != 0);
+      if (encoding == ByteStringEncoding::latin1)
+        variant = EncodingVariant::none;
+
+      auto encoded = encodeGeneric(decoded, encoding, variant);
+      ASSERT_FALSE(encoded.isError());
+
+      auto roundTrip = decodeGeneric(encoded, encoding, variant);
+      if (encoding == ByteStringEncoding::latin1) {
+        EXPECT_EQ(encodeLatin1(roundTrip, variant), encoded);
+      } else {
+        EXPECT_EQ(decoded, roundTrip);
+      }
+    }
+  }
+
+  // The ASCII parts of UTF-16 are narrowed as a whole
+  auto utf16 = encodeUTF16(decoded, EncodingVariant::littleEndian);
+  ASSERT_FALSE(utf16.isError());
+  EXPECT_EQ('a', utf16.string[0]);
+  EXPECT_EQ(0, utf16.string[1]);
+
+  // An invalid sequence after a long ASCII run is still detected
+  text.insert(text.end() - 3, '\x80');
+  auto invalid = makeLString(text.data(), text.size());
+  EXPECT_EQ(UnicodeErrorReason::invalidUTF8,
+            encodeUTF16(invalid, EncodingVariant::none).error);
+  EXPECT_EQ(UnicodeErrorReason::invalidUTF8,
+            encodeUTF8(invalid, EncodingVariant::none).error);
+}
+
+TEST_F(CodersTest, GenericInVM) {
+  auto test = makeLString(MOZART_STR("a\U000180c3b"));
+
+  auto encoded = encodeGeneric(vm, test, ByteStringEncoding::utf16,
+                               EncodingVariant::hasBOM);
+  EXPECT_EQ(makeLString(ustr("\xfe\xff\0a\xd8\x20\xdc\xc3\0b"), 10), encoded);
+
+  auto decoded = decodeGeneric(vm, encoded, ByteStringEncoding::utf16,
+                               EncodingVariant::hasBOM);
+  EXPECT_EQ(test, decoded);
+
+  auto empty = encodeGeneric(vm, makeLString(MOZART_STR("")),
+                             ByteStringEncoding::utf32,
+                             EncodingVariant::none);
+  EXPECT_TRUE(empty.isErrorOrEmpty());
+  EXPECT_FALSE(empty.isError());
+
+  auto error = decodeGeneric(vm, makeLString(ustr("\0\0\0"), 3),
+                             ByteStringEncoding::utf32,
+                             EncodingVariant::none);
+  EXPECT_EQ(UnicodeErrorReason::truncated, error.error);
+}
@@ -29,6 +29,209 @@ TEST_F(GCTest, GCSanity) {
     (void) something;   // shut up warning.
 }
 
+TEST_F(GCTest, Statistics) {
+    // This is to ensure the GC statistics are updated by each collection.
+
+    auto& gc = vm->getGarbageCollector();
+    gc.perTypeEnabled() = true;
+
+    int collections = 0;
+    gc.setListener([&collections] (VM vm, const GCStatistics& stats) {
+        collections++;
+    });
+
+    auto unit_node = build(vm, unit);
+    auto array_node = Array::build(vm, 100, 0, unit_node);
+    auto protected_array_node = vm->protect(array_node);
+
+    vm->requestGC();
+    vm->run();
+
+    auto& stats = gc.getStatistics();
+    EXPECT_EQ(1, collections);
+    EXPECT_EQ(1u, stats.collections);
+    EXPECT_LE(stats.lastBytesAfter, stats.lastBytesBefore);
+    EXPECT_EQ(vm->getMemoryManager().getAllocated(), stats.lastBytesAfter);
+    EXPECT_LT(0u, stats.lastObjectsCopied);
+    EXPECT_EQ(1u, stats.lastPerType.count(Array::type().info()));
+
+    vm->requestGC();
+    vm->run();
+
+    EXPECT_EQ(2, collections);
+    EXPECT_EQ(2u, stats.collections);
+    EXPECT_LE(stats.lastPause, stats.maxPause);
+    EXPECT_LE(stats.maxPause, stats.totalPause);
+
+    gc.setListener(nullptr);
+}
+
+TEST_F(GCTest, StableAtoms) {
+    // Atoms that are still referenced keep their address across collections,
+    // and the other ones are swept.
+
+    auto& stats = vm->getGarbageCollector().getStatistics();
+
+    auto kept = vm->protect(build(vm, MOZART_STR("keptAtom")));
+    atom_t keptAtom = RichNode(*kept).as<Atom>().value();
+
+    for (int i = 0; i < 100; i++) {
+      nchar name[] = { 't', (nchar) ('a' + i / 26), (nchar) ('a' + i % 26) };
+      vm->getAtom(3, name);
+    }
+
+    vm->requestGC();
+    vm->run();
+
+    EXPECT_LE(100u, stats.lastAtomsSwept);
+    EXPECT_TRUE(keptAtom == RichNode(*kept).as<Atom>().value());
+    EXPECT_TRUE(keptAtom == vm->getAtom(MOZART_STR("keptAtom")));
+    EXPECT_TRUE(vm->coreatoms.sharp == vm->getAtom(MOZART_STR("#")));
+
+    // Swept atoms can be created again
+    atom_t recreated = vm->getAtom(MOZART_STR("tab"));
+    EXPECT_EQ(3u, recreated.length());
+
+    // The recreated atom is not referenced either
+    vm->requestGC();
+    vm->run();
+
+    EXPECT_LE(1u, stats.lastAtomsSwept);
+    EXPECT_TRUE(keptAtom == RichNode(*kept).as<Atom>().value());
+}
+
+TEST_F(GCTest, GlobalNodes) {
+    // Global nodes are found again by UUID, and the unreachable ones are
+    // forgotten by the GC.
+
+    const std::uint64_t count = 1000;
+    std::vector<GlobalNode*> nodes;
+
+    for (std::uint64_t i = 0; i < count; i++) {
+      GlobalNode* node;
+      EXPECT_FALSE(GlobalNode::get(vm, UUID(0x1234, i), node));
+      nodes.push_back(node);
+    }
+
+    for (std::uint64_t i = 0; i < count; i++) {
+      GlobalNode* node;
+      EXPECT_TRUE(GlobalNode::get(vm, UUID(0x1234, i), node));
+      EXPECT_EQ(nodes[i], node);
+    }
+
+    GlobalNode* node;
+    EXPECT_FALSE(GlobalNode::get(vm, UUID(0x1234, count), node));
+
+    vm->requestGC();
+    vm->run();
+
+    EXPECT_FALSE(GlobalNode::get(vm, UUID(0x1234, 0), node));
+}
+
+TEST_F(GCTest, Alarms) {
+    // Alarms fire in order of expiration, can be cancelled, and survive GC.
+
+    vm->setReferenceTime(1000);
+
+    auto late = vm->protect(Variable::build(vm));
+    auto early = vm->protect(Variable::build(vm));
+    auto cancelled = vm->protect(Variable::build(vm));
+
+    vm->setAlarm(200, RichNode(*late).getStableRef(vm));
+    auto earlyHandle = vm->setAlarm(100, RichNode(*early).getStableRef(vm));
+    auto handle = vm->setAlarm(50, RichNode(*cancelled).getStableRef(vm));
+
+    EXPECT_TRUE(vm->cancelAlarm(handle));
+    EXPECT_FALSE(vm->cancelAlarm(handle));
+    EXPECT_FALSE(vm->cancelAlarm(AlarmHandle()));
+
+    vm->requestGC();
+    auto next = vm->run();
+    EXPECT_EQ(VirtualMachine::recInvokeAgainLater, next.first);
+    EXPECT_EQ(1100, next.second);
+
+    vm->setReferenceTime(1150);
+    next = vm->run();
+    EXPECT_TRUE(RichNode(*early).is<Unit>());
+    EXPECT_FALSE(RichNode(*late).is<Unit>());
+    EXPECT_EQ(1200, next.second);
+
+    // The handle of an alarm that fired is stale, even if its slot is reused
+    auto reused = vm->setAlarm(1000, RichNode(*cancelled).getStableRef(vm));
+    EXPECT_FALSE(vm->cancelAlarm(earlyHandle));
+    EXPECT_TRUE(vm->cancelAlarm(reused));
+
+    vm->setReferenceTime(1200);
+    next = vm->run();
+    EXPECT_TRUE(RichNode(*late).is<Unit>());
+    EXPECT_FALSE(RichNode(*cancelled).is<Unit>());
+    EXPECT_EQ(VirtualMachine::recNeverInvokeAgain, next.first);
+}
+
+TEST_F(GCTest, AllocationProfiler) {
+    // This is to ensure allocations are attributed to their type, and that
+    // the GC takes a census of the live nodes while the profiler is enabled.
+
+    auto& profiler = vm->getAllocationProfiler();
+    profiler.start();
+
+    auto unit_node = build(vm, unit);
+    auto array_node = Array::build(vm, 100, 0, unit_node);
+    auto protected_array_node = vm->protect(array_node);
+
+    auto& perType = profiler.getPerType();
+    ASSERT_EQ(1u, perType.count(Array::type().info()));
+    EXPECT_EQ(1u, perType.at(Array::type().info()).objects);
+    EXPECT_LT(100 * sizeof(UnstableNode),
+              perType.at(Array::type().info()).bytes);
+
+    vm->requestGC();
+    vm->run();
+
+    auto& census = vm->getGarbageCollector().getStatistics().lastPerType;
+    EXPECT_EQ(1u, census.count(Array::type().info()));
+
+    // Copies made by the GC are not allocations
+    EXPECT_EQ(1u, perType.at(Array::type().info()).objects);
+
+    profiler.stop();
+    profiler.reset();
+    EXPECT_TRUE(profiler.getPerType().empty());
+}
+
+TEST_F(GCTest, AllocationProfilerBytes) {
+    // This is to ensure blocks reused from free lists and big blocks are
+    // counted, and that nested allocations are counted only once.
+
+    auto& profiler = vm->getAllocationProfiler();
+    auto& staticArrays = profiler.getStaticArrays();
+    profiler.start();
+
+    // 1. A block reused from a free list is counted again.
+    auto small = vm->newStaticArray<UnstableNode>(4);
+    size_t smallBytes = staticArrays.bytes;
+    EXPECT_LE(4 * sizeof(UnstableNode), smallBytes);
+
+    vm->deleteStaticArray<UnstableNode>(small, 4);
+    small = vm->newStaticArray<UnstableNode>(4);
+    EXPECT_EQ(2 * smallBytes, staticArrays.bytes);
+    vm->deleteStaticArray<UnstableNode>(small, 4);
+
+    // 2. A big block, which does not come from the memory manager, is counted.
+    auto big = vm->newStaticArray<UnstableNode>(1000);
+    EXPECT_EQ(2 * smallBytes + 1000 * sizeof(UnstableNode), staticArrays.bytes);
+    vm->deleteStaticArray<UnstableNode>(big, 1000);
+
+    // 3. The bytes of a nested allocation are not counted by the outer scope.
+    size_t scope = profiler.enterScope();
+    vm->getMemoryManager().getMemory(64);
+    auto inner = vm->newStaticArray<UnstableNode>(4);
+    EXPECT_EQ(64u, profiler.leaveScope(scope));
+    vm->deleteStaticArray<UnstableNode>(inner, 4);
+
+    profiler.stop();
+}
+
 TEST_F(GCTest, Protect) {
     // This is to ensure protected nodes are noticed by GC, and thus won't be
     // freed.
@@ -71,6 +274,50 @@ TEST_F(GCTest, Protect) {
     EXPECT_EQ(original_size, vm->getMemoryManager().getAllocated());
 }
 
+TEST_F(GCTest, ProtectedSlots) {
+    // Same as Protect, with the slots that are released explicitly.
+
+    size_t original_size = vm->getMemoryManager().getAllocated();
+    auto unit_node = build(vm, unit);
+    auto array_node = Array::build(vm, 250, 0, unit_node);
+    {
+        auto key = build(vm, 18);
+        auto value = build(vm, 1902);
+        ArrayLike(array_node).arrayPut(vm, key, value);
+    }
+
+    auto slot = vm->protectInSlot(array_node);
+
+    // Some more slots, so that the free list is exercised
+    std::vector<ProtectedSlot> others;
+    for (nativeint i = 0; i < 100; i++)
+        others.push_back(vm->protectInSlot(build(vm, i)));
+    for (size_t i = 0; i < others.size(); i += 2)
+        vm->releaseProtectedSlot(others[i]);
+
+    vm->requestGC();
+    vm->run();
+
+    {
+        auto key = build(vm, 18);
+        auto value = ArrayLike(vm->getProtectedSlot(slot)).arrayGet(vm, key);
+        EXPECT_EQ_INT(1902, value);
+    }
+    for (size_t i = 1; i < others.size(); i += 2)
+        EXPECT_EQ_INT((nativeint) i, vm->getProtectedSlot(others[i]));
+
+    vm->releaseProtectedSlot(slot);
+    for (size_t i = 1; i < others.size(); i += 2)
+        vm->releaseProtectedSlot(others[i]);
+
+    vm->requestGC();
+    vm->run();
+    vm->requestGC();
+    vm->run();
+
+    EXPECT_EQ(original_size, vm->getMemoryManager().getAllocated());
+}
+
 TEST_F(GCTest, ProtectedNodeConversionWithSharedPtr) {
     // ProtectedNode must be convertible to and from
     // std::shared_ptr<StableNode*>
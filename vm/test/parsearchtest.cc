@@ -0,0 +1,184 @@
+#include "mozart.hh"
+#include "parsearch-decl.hh"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include "testutils.hh"
+
+using namespace mozart;
+
+class ParallelSearchTest : public ::testing::Test {
+protected:
+  /**
+   * Loader of a script that chooses between 2 alternatives depth times,
+   * i.e., whose search tree has 2^depth solutions
+   */
+  static ParallelSearch::ScriptLoader binaryTree(nativeint depth) {
+    return [depth] (VM vm, UnstableNode& script,
+                    UnstableNode& order) -> bool {
+      ByteCode code[] = {
+        OpMoveKX, 0, 1,                  // 0: X1 := depth
+        OpInlineEqualsInteger, 1, 0, 4,  // 3: if X1 == 0
+        OpUnifyXK, 0, 1,                 // 7:   Root = unit
+        OpReturn,                        // 10:  return
+        OpMoveKX, 2, 3,                  // 11: X3 := 2
+        OpCallBuiltin2, 3, 3, 2,         // 14: X2 := {Space.choose X3}
+        OpInlineEqualsInteger, 2, 0, 0,  // 18: wait for X2
+        OpInlineMinus1, 1, 1,            // 22: X1 := X1 - 1
+        OpBranchBackward, 24,            // 25: goto 3
+      };
+
+      UnstableNode debugData = build(vm, unit);
+      UnstableNode codeArea = CodeArea::build(
+        vm, 4, code, sizeof(code), 1, 4,
+        vm->getAtom(MOZART_STR("script")), debugData);
+
+      auto Ks = RichNode(codeArea).as<CodeArea>().getElementsArray();
+      Ks[0].init(vm, build(vm, depth));
+      Ks[1].init(vm, build(vm, unit));
+      Ks[2].init(vm, build(vm, 2));
+      Ks[3].init(vm, vm->findBuiltin(MOZART_STR("Space"),
+                                     MOZART_STR("choose")));
+
+      script = Abstraction::build(vm, 0, codeArea);
+      return true;
+    };
+  }
+
+  /** Collects what the engine reports, from the worker threads */
+  struct Results {
+    Results(): done(false), loadFailed(false) {}
+
+    ParallelSearch::SolutionHandler onSolution() {
+      return [this] (const ParallelSearch::Path& solution) {
+        std::unique_lock<std::mutex> lock(mutex);
+        solutions.insert(solution);
+      };
+    }
+
+    ParallelSearch::DoneHandler onDone() {
+      return [this] (const ParallelSearch::Statistics& stats,
+                     bool loadFailed) {
+        std::unique_lock<std::mutex> lock(mutex);
+        EXPECT_FALSE(done);
+        done = true;
+        this->stats = stats;
+        this->loadFailed = loadFailed;
+        doneCondition.notify_all();
+      };
+    }
+
+    void waitDone() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (!done)
+        doneCondition.wait(lock);
+    }
+
+    std::mutex mutex;
+    std::condition_variable doneCondition;
+    std::set<ParallelSearch::Path> solutions;
+    bool done;
+    ParallelSearch::Statistics stats;
+    bool loadFailed;
+  };
+};
+
+TEST_F(ParallelSearchTest, AllSolutions) {
+  Results results;
+  ParallelSearch engine(ParallelSearch::psAll, 2, binaryTree(3));
+
+  engine.start(results.onSolution(), results.onDone());
+  engine.wait();
+
+  EXPECT_TRUE(results.done);
+  EXPECT_FALSE(results.loadFailed);
+  EXPECT_EQ(8u, results.solutions.size());
+  EXPECT_EQ(8u, results.stats.solutions);
+  EXPECT_EQ(0u, results.stats.failures);
+
+  for (auto& solution: results.solutions) {
+    EXPECT_EQ(3u, solution.size());
+    for (nativeint alternative: solution) {
+      EXPECT_LE(1, alternative);
+      EXPECT_GE(2, alternative);
+    }
+  }
+}
+
+TEST_F(ParallelSearchTest, OneSolution) {
+  Results results;
+  ParallelSearch engine(ParallelSearch::psOne, 2, binaryTree(3));
+
+  engine.start(results.onSolution(), results.onDone());
+  engine.wait();
+
+  EXPECT_TRUE(results.done);
+  EXPECT_EQ(1u, results.solutions.size());
+}
+
+TEST_F(ParallelSearchTest, LoadFailure) {
+  Results results;
+  ParallelSearch engine(ParallelSearch::psAll, 2,
+    [] (VM vm, UnstableNode& script, UnstableNode& order) {
+      return false;
+    });
+
+  engine.start(results.onSolution(), results.onDone());
+  engine.wait();
+
+  EXPECT_TRUE(results.done);
+  EXPECT_TRUE(results.loadFailed);
+  EXPECT_TRUE(results.solutions.empty());
+}
+
+TEST_F(ParallelSearchTest, StopWhileRunning) {
+  Results results;
+  std::atomic<size_t> solutionCount(0);
+  std::mutex mutex;
+  std::condition_variable firstSolution;
+
+  ParallelSearch engine(ParallelSearch::psAll, 2, binaryTree(20));
+
+  engine.start(
+    [&] (const ParallelSearch::Path& solution) {
+      if (solutionCount++ == 0) {
+        std::unique_lock<std::mutex> lock(mutex);
+        firstSolution.notify_all();
+      }
+    },
+    results.onDone());
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (solutionCount == 0)
+      firstSolution.wait(lock);
+  }
+
+  engine.stop();
+  engine.wait();
+
+  EXPECT_TRUE(results.done);
+  EXPECT_FALSE(results.loadFailed);
+  EXPECT_LT(solutionCount.load(), (size_t) 1 << 20);
+  EXPECT_GE(results.stats.solutions, solutionCount.load());
+}
+
+TEST_F(ParallelSearchTest, DoneHandlerUsesEngine) {
+  // The done handler is called with the engine unlocked
+  Results results;
+  ParallelSearch engine(ParallelSearch::psAll, 2, binaryTree(2));
+  auto onDone = results.onDone();
+
+  engine.start(results.onSolution(),
+    [&] (const ParallelSearch::Statistics& stats, bool loadFailed) {
+      engine.stop();
+      onDone(stats, loadFailed);
+    });
+
+  results.waitDone();
+  engine.wait();
+
+  EXPECT_EQ(4u, results.solutions.size());
+}
@@ -0,0 +1,115 @@
+#include "mozart.hh"
+#include <gtest/gtest.h>
+#include <sstream>
+#include "testutils.hh"
+
+using namespace mozart;
+
+class ProfilerTest : public MozartTest {
+protected:
+  virtual void TearDown() {
+    stack.clear(vm);
+  }
+
+  /** Build a procedure whose debug info is test.oz:line */
+  StableNode* makeProcedure(const nchar* printName, nativeint line) {
+    ByteCode code[] = { OpReturn };
+
+    UnstableNode debugData = buildRecord(
+      vm, buildArity(vm, MOZART_STR("d"),
+                     MOZART_STR("file"), MOZART_STR("line")),
+      MOZART_STR("test.oz"), line);
+
+    UnstableNode codeArea = CodeArea::build(
+      vm, 0, code, sizeof(code), 0, 1, vm->getAtom(printName), debugData);
+
+    UnstableNode abstraction = Abstraction::build(vm, 0, codeArea);
+    return RichNode(abstraction).getStableRef(vm);
+  }
+
+  /** Push a frame of the given procedure, which becomes the innermost */
+  void pushFrame(StableNode* abstraction) {
+    stack.push_front_new(vm, abstraction, nullptr, 0,
+                         nullptr, nullptr, nullptr);
+  }
+
+  std::string collapsed() {
+    std::stringstream out;
+    vm->getProfiler().writeCollapsed(out);
+    return out.str();
+  }
+
+  ThreadStack stack;
+};
+
+TEST_F(ProfilerTest, RequestSample) {
+  auto& profiler = vm->getProfiler();
+
+  // Ticks are ignored while the profiler is stopped
+  profiler.requestSample();
+  EXPECT_FALSE(profiler.isSampleRequested());
+
+  profiler.start();
+  profiler.requestSample();
+  EXPECT_TRUE(profiler.isSampleRequested());
+
+  // Stopping drops a pending request
+  profiler.stop();
+  EXPECT_FALSE(profiler.isSampleRequested());
+}
+
+TEST_F(ProfilerTest, Aggregate) {
+  auto& profiler = vm->getProfiler();
+  profiler.start();
+
+  pushFrame(makeProcedure(MOZART_STR("Outer"), 1));
+  pushFrame(makeProcedure(MOZART_STR("Inner"), 2));
+
+  profiler.requestSample();
+  profiler.sample(vm, stack);
+  EXPECT_FALSE(profiler.isSampleRequested());
+  profiler.sample(vm, stack);
+
+  EXPECT_EQ(2u, profiler.getSampleCount());
+  EXPECT_EQ("Outer (test.oz:1);Inner (test.oz:2) 2\n", collapsed());
+
+  profiler.reset();
+  EXPECT_EQ(0u, profiler.getSampleCount());
+  EXPECT_EQ("", collapsed());
+
+  profiler.stop();
+}
+
+TEST_F(ProfilerTest, SkippedSamples) {
+  auto& profiler = vm->getProfiler();
+
+  // Samples are dropped while the profiler is stopped
+  pushFrame(makeProcedure(MOZART_STR("P"), 1));
+  profiler.sample(vm, stack);
+  EXPECT_EQ(0u, profiler.getSampleCount());
+
+  // Empty stacks are dropped, and exception handlers are not frames
+  stack.clear(vm);
+  stack.pushExceptionHandler(vm, nullptr);
+
+  profiler.start();
+  profiler.sample(vm, stack);
+  EXPECT_EQ(0u, profiler.getSampleCount());
+  EXPECT_EQ("", collapsed());
+
+  profiler.stop();
+}
+
+TEST_F(ProfilerTest, FrameNames) {
+  auto& profiler = vm->getProfiler();
+  profiler.start();
+
+  // ';' would be read as a frame separator
+  pushFrame(makeProcedure(MOZART_STR(""), 3));
+  pushFrame(makeProcedure(MOZART_STR("a;b"), 4));
+  profiler.sample(vm, stack);
+
+  EXPECT_EQ("<anonymous> (test.oz:3);a,b (test.oz:4) 1\n", collapsed());
+
+  profiler.stop();
+}
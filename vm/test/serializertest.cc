@@ -0,0 +1,264 @@
+#include "mozart.hh"
+#include <gtest/gtest.h>
+#include "testutils.hh"
+
+using namespace mozart;
+
+class SerializerTest : public MozartTest {
+protected:
+  std::string serialize(RichNode value) {
+    ChunkedBuffer buffer;
+    StreamSerializer(vm, buffer).serialize(value);
+
+    std::string result;
+    buffer.forEachChunk([&] (const char* data, size_t size) {
+      result.append(data, size);
+    });
+    return result;
+  }
+
+  std::string pickle(std::initializer_list<unsigned char> bytes) {
+    std::string result(pickleMagic, sizeof(pickleMagic));
+    for (unsigned char byte: bytes)
+      result.push_back((char) byte);
+    return result;
+  }
+
+  /** Feed bytes to an Unpickler, in chunks of chunkSize bytes */
+  UnpicklerStatus unpickle(RichNode unpickler, const std::string& bytes,
+                           size_t chunkSize, size_t maxNodes = 1000) {
+    auto u = unpickler.as<Unpickler>();
+    UnpicklerStatus status = usNeedInput;
+
+    for (size_t i = 0; i < bytes.size(); i += chunkSize) {
+      EXPECT_EQ(usNeedInput, status);
+
+      auto data = reinterpret_cast<const unsigned char*>(bytes.data()) + i;
+      size_t size = std::min(chunkSize, bytes.size() - i);
+      u.feed(vm, ByteString::build(vm, newLString(vm, data, size)));
+
+      status = u.resume(vm, maxNodes);
+    }
+
+    return status;
+  }
+};
+
+TEST_F(SerializerTest, Scalars) {
+  UnstableNode values[] = {
+    SmallInt::build(vm, 0), SmallInt::build(vm, -1), SmallInt::build(vm, 300),
+    Boolean::build(vm, true), Unit::build(vm), Float::build(vm, 1.0),
+    Atom::build(vm, MOZART_STR("foo")), String::build(vm, MOZART_STR("ab")),
+  };
+
+  std::string expected[] = {
+    pickle({pvInt, 0}), pickle({pvInt, 1}), pickle({pvInt, 0xd8, 0x04}),
+    pickle({pvTrue}), pickle({pvUnit}),
+    pickle({pvFloat, 0, 0, 0, 0, 0, 0, 0xf0, 0x3f}),
+    pickle({pvNewAtom, 3, 'f', 'o', 'o'}), pickle({pvString, 2, 'a', 'b'}),
+  };
+
+  for (size_t i = 0; i < sizeof(values)/sizeof(values[0]); i++)
+    EXPECT_EQ(expected[i], serialize(values[i]));
+}
+
+TEST_F(SerializerTest, List) {
+  UnstableNode list = buildList(vm, MOZART_STR("a"), MOZART_STR("a"));
+
+  EXPECT_EQ(pickle({pvNewNode,
+                    pnCons, pvNewAtom, 1, 'a', pvNewNode,
+                    pnCons, pvAtom, 0, pvNewAtom, 3, 'n', 'i', 'l'}),
+            serialize(list));
+}
+
+TEST_F(SerializerTest, Record) {
+  UnstableNode arity = Arity::build(vm, 1, Atom::build(vm, MOZART_STR("f")));
+  RichNode(arity).as<Arity>().getElementsArray()[0].init(
+    vm, Atom::build(vm, MOZART_STR("x")));
+
+  UnstableNode record = Record::build(vm, 1, arity);
+  RichNode(record).as<Record>().getElementsArray()[0].init(
+    vm, SmallInt::build(vm, 5));
+
+  EXPECT_EQ(pickle({pvNewNode,
+                    pnRecord, pvNewArity, 1, pvNewAtom, 1, 'f',
+                    pvNewAtom, 1, 'x', 1, pvInt, 10}),
+            serialize(record));
+}
+
+TEST_F(SerializerTest, Cycle) {
+  UnstableNode list = buildCons(vm, 1, OptVar::build(vm));
+  StableNode* tail = RichNode(list).as<Cons>().getTail();
+  RichNode(*tail).as<OptVar>().bind(vm, RichNode(list));
+
+  EXPECT_EQ(pickle({pvNewNode, pnCons, pvInt, 2, pvRef, 0}),
+            serialize(list));
+}
+
+TEST_F(SerializerTest, Hook) {
+  UnstableNode name = NamedName::build(vm, vm->getAtom(MOZART_STR("n")));
+
+  EXPECT_EQ(pickle({pvNewNode,
+                    pnOther, pvTuple, 1,
+                    pvNewAtom, 9, 'n', 'a', 'm', 'e', 'd', 'n', 'a', 'm', 'e',
+                    pvNewAtom, 1, 'n'}),
+            serialize(name));
+}
+
+TEST_F(SerializerTest, CheckSerializable) {
+  UnstableNode list = buildCons(vm, 1, OptVar::build(vm));
+  StableNode* tail = RichNode(list).as<Cons>().getTail();
+
+  MOZART_TRY(vm) {
+    StreamSerializer::checkSerializable(vm, list);
+    ADD_FAILURE();
+  } MOZART_CATCH(vm, kind, node) {
+    EXPECT_EQ(ExceptionKind::ekWaitBefore, kind);
+  } MOZART_ENDTRY(vm);
+
+  RichNode(*tail).as<OptVar>().bind(vm, RichNode(list));
+  StreamSerializer::checkSerializable(vm, list);
+
+  UnstableNode cell = Cell::build(vm, SmallInt::build(vm, 0));
+  UnstableNode withCell = buildCons(vm, 1, std::move(cell));
+  EXPECT_RAISE(MOZART_STR("serialize"),
+               StreamSerializer::checkSerializable(vm, withCell));
+}
+
+TEST_F(SerializerTest, UnpickleRecord) {
+  UnstableNode arity = Arity::build(vm, 2, Atom::build(vm, MOZART_STR("f")));
+  auto features = RichNode(arity).as<Arity>().getElementsArray();
+  features[0].init(vm, Atom::build(vm, MOZART_STR("x")));
+  features[1].init(vm, Atom::build(vm, MOZART_STR("y")));
+
+  UnstableNode record = Record::build(vm, 2, arity);
+  auto elements = RichNode(record).as<Record>().getElementsArray();
+  elements[0].init(vm, buildList(vm, 1, MOZART_STR("a")));
+  elements[1].init(vm, String::build(vm, MOZART_STR("str")));
+
+  std::string bytes = serialize(record);
+
+  for (size_t chunkSize: {1, 3, 1000}) {
+    UnstableNode result = OptVar::build(vm);
+    UnstableNode unpickler = Unpickler::build(vm, result);
+
+    EXPECT_EQ(usDone, unpickle(unpickler, bytes, chunkSize));
+
+    RichNode value = result;
+    if (EXPECT_IS<Record>(value)) {
+      auto unpickled = value.as<Record>();
+      EXPECT_EQ(2u, unpickled.getWidth());
+      EXPECT_EQ_ATOM(MOZART_STR("f"), *unpickled.getLabel());
+
+      RichNode list = *unpickled.getElement(0);
+      if (EXPECT_IS<Cons>(list)) {
+        EXPECT_EQ_INT(1, *list.as<Cons>().getHead());
+        EXPECT_TRUE(RichNode(*list.as<Cons>().getTail()).is<Cons>());
+      }
+
+      EXPECT_EQ_STRING(MOZART_STR("str"), *unpickled.getElement(1));
+    }
+  }
+}
+
+TEST_F(SerializerTest, UnpickleCycle) {
+  UnstableNode list = buildCons(vm, 1, OptVar::build(vm));
+  StableNode* tail = RichNode(list).as<Cons>().getTail();
+  RichNode(*tail).as<OptVar>().bind(vm, RichNode(list));
+
+  UnstableNode result = OptVar::build(vm);
+  UnstableNode unpickler = Unpickler::build(vm, result);
+
+  EXPECT_EQ(usDone, unpickle(unpickler, serialize(list), 2));
+
+  RichNode value = result;
+  if (EXPECT_IS<Cons>(value)) {
+    RichNode next = *value.as<Cons>().getTail();
+    EXPECT_TRUE(next.isSameNode(value));
+  }
+}
+
+TEST_F(SerializerTest, UnpickleYield) {
+  UnstableNode list = buildList(vm, 1, 2, 3);
+
+  UnstableNode result = OptVar::build(vm);
+  UnstableNode unpickler = Unpickler::build(vm, result);
+  auto u = RichNode(unpickler).as<Unpickler>();
+
+  // One node record per resume
+  EXPECT_EQ(usYield, unpickle(unpickler, serialize(list), 1000, 1));
+  EXPECT_TRUE(RichNode(result).isTransient());
+
+  EXPECT_EQ(usYield, u.resume(vm, 1));
+  EXPECT_EQ(usDone, u.resume(vm, 1));
+
+  EXPECT_FALSE(RichNode(result).isTransient());
+  EXPECT_TRUE(RichNode(result).is<Cons>());
+}
+
+TEST_F(SerializerTest, UnpickleRest) {
+  std::string bytes = serialize(SmallInt::build(vm, 5)) + "next";
+
+  UnstableNode result = OptVar::build(vm);
+  UnstableNode unpickler = Unpickler::build(vm, result);
+
+  EXPECT_EQ(usDone, unpickle(unpickler, bytes, 3));
+  EXPECT_EQ_INT(5, result);
+
+  UnstableNode rest = RichNode(unpickler).as<Unpickler>().getRest(vm);
+  if (EXPECT_IS<ByteString>(rest)) {
+    auto& value = RichNode(rest).as<ByteString>().value(vm);
+    EXPECT_EQ(std::string("next"),
+              std::string((const char*) value.string, value.length));
+  }
+}
+
+TEST_F(SerializerTest, UnpickleFailure) {
+  UnstableNode result = OptVar::build(vm);
+  UnstableNode unpickler = Unpickler::build(vm, result);
+
+  EXPECT_EQ(usFailed, unpickle(unpickler, "OzX\x01", 1));
+  EXPECT_TRUE(RichNode(result).is<FailedValue>());
+
+  UnstableNode malformed = OptVar::build(vm);
+  unpickler = Unpickler::build(vm, malformed);
+
+  EXPECT_EQ(usFailed, unpickle(unpickler, pickle({pvRef, 0}), 1));
+  UnstableNode error = RichNode(unpickler).as<Unpickler>().getError(vm);
+  EXPECT_EQ_ATOM(MOZART_STR("malformed"), error);
+
+  std::string malformedPickles[] = {
+    // A record wider than its arity
+    pickle({pvNewNode, pnRecord, pvNewArity, 1, pvNewAtom, 1, 'f',
+            pvNewAtom, 1, 'x', 2, pvUnit, pvUnit}),
+    // An arity whose features are not sorted
+    pickle({pvNewNode, pnRecord, pvNewArity, 2, pvNewAtom, 1, 'f',
+            pvNewAtom, 1, 'y', pvNewAtom, 1, 'x', 2, pvUnit, pvUnit}),
+    // An arity whose feature is not a feature
+    pickle({pvNewArity, 1, pvNewAtom, 1, 'f', pvFloat,
+            0, 0, 0, 0, 0, 0, 0xf0, 0x3f}),
+    // An atom that is not valid UTF-8
+    pickle({pvNewAtom, 2, 'a', 0xff}),
+    // A tuple labelled by a float
+    pickle({pvNewNode, pnTuple, 1, pvFloat, 0, 0, 0, 0, 0, 0, 0xf0, 0x3f,
+            pvUnit}),
+    // A tuple labelled by a node that is a list
+    pickle({pvNewNode, pnTuple, 1, pvNewNode, pvUnit,
+            pnCons, pvUnit, pvUnit}),
+    // A record whose features are those of a tuple
+    pickle({pvNewNode, pnRecord, pvNewArity, 1, pvNewAtom, 1, 'f', pvInt, 2,
+            1, pvUnit}),
+    // A '|'/2 tuple instead of a cons
+    pickle({pvNewNode, pnTuple, 2, pvNewAtom, 1, '|', pvUnit, pvUnit}),
+  };
+
+  for (auto& bytes: malformedPickles) {
+    result = OptVar::build(vm);
+    unpickler = Unpickler::build(vm, result);
+
+    EXPECT_EQ(usFailed, unpickle(unpickler, bytes, bytes.size()));
+    EXPECT_TRUE(RichNode(result).is<FailedValue>());
+    error = RichNode(unpickler).as<Unpickler>().getError(vm);
+    EXPECT_EQ_ATOM(MOZART_STR("malformed"), error);
+  }
+}
@@ -0,0 +1,225 @@
+#include "mozart.hh"
+#include <gtest/gtest.h>
+#include "testutils.hh"
+
+using namespace mozart;
+
+class SpaceTest : public MozartTest {
+protected:
+  virtual void SetUp() {
+    UnstableNode initial = build(vm, 2);
+    cell = vm->protect(Cell::build(vm, initial));
+  }
+
+  /**
+   * Create a space running a script that chooses depth times between @cell
+   * alternatives, and bind its root to unit. Run it until it is stable.
+   */
+  UnstableNode newSpace(nativeint depth) {
+    ByteCode code[] = {
+      OpMoveKX, 4, 1,                  // 0: X1 := depth
+      OpInlineEqualsInteger, 1, 0, 4,  // 3: if X1 == 0
+      OpUnifyXK, 0, 3,                 // 7:   Root = unit
+      OpReturn,                        // 10:  return
+      OpMoveKX, 0, 4,                  // 11: X4 := cell
+      OpCallBuiltin2, 1, 4, 3,         // 14: X3 := {Cell.access X4}
+      OpCallBuiltin2, 2, 3, 2,         // 18: X2 := {Space.choose X3}
+      OpInlineEqualsInteger, 2, 0, 0,  // 22: wait for X2
+      OpInlineMinus1, 1, 1,            // 26: X1 := X1 - 1
+      OpBranchBackward, 28,            // 29: goto 3
+    };
+
+    UnstableNode debugData = build(vm, unit);
+    UnstableNode codeArea = CodeArea::build(
+      vm, 5, code, sizeof(code), 1, 5,
+      vm->getAtom(MOZART_STR("script")), debugData);
+
+    auto Ks = RichNode(codeArea).as<CodeArea>().getElementsArray();
+    Ks[0].init(vm, *cell);
+    Ks[1].init(vm, vm->findBuiltin(MOZART_STR("Cell"), MOZART_STR("access")));
+    Ks[2].init(vm, vm->findBuiltin(MOZART_STR("Space"),
+                                   MOZART_STR("choose")));
+    Ks[3].init(vm, build(vm, unit));
+    Ks[4].init(vm, build(vm, depth));
+
+    UnstableNode script = Abstraction::build(vm, 0, codeArea);
+
+    Space* space = new (vm) Space(vm, vm->getCurrentSpace());
+    ozcalls::asyncOzCall(vm, space, script, *space->getRootVar());
+    UnstableNode result = ReifiedSpace::build(vm, space);
+
+    runUntilIdle();
+    return result;
+  }
+
+  void runUntilIdle() {
+    while (vm->run().first != VirtualMachine::recNeverInvokeAgain) {
+    }
+  }
+
+  void setRecomputationDistance(nativeint distance) {
+    vm->getPropertyRegistry().config.spacesRecomputation = distance;
+  }
+
+  void setAlternatives(nativeint alternatives) {
+    UnstableNode value = build(vm, alternatives);
+    CellLike(*cell).assign(vm, value);
+  }
+
+  static Space* getSpace(RichNode space) {
+    return space.as<ReifiedSpace>().getSpace();
+  }
+
+  UnstableNode clone(RichNode space) {
+    return SpaceLike(space).cloneSpace(vm);
+  }
+
+  void commit(RichNode space, nativeint alternative) {
+    UnstableNode value = build(vm, alternative);
+    SpaceLike(space).commitSpace(vm, value);
+    runUntilIdle();
+  }
+
+  /** Materialize a lazy space, and wait until its commits are replayed */
+  void recompute(RichNode space) {
+    SpaceLike(space).askVerboseSpace(vm);
+    runUntilIdle();
+  }
+
+  void EXPECT_ALTERNATIVES(nativeint expected, RichNode space) {
+    using namespace patternmatching;
+
+    UnstableNode status = SpaceLike(space).askSpace(vm);
+    nativeint alternatives = 0;
+    EXPECT_TRUE(matchesTuple(vm, status, vm->coreatoms.alternatives,
+                             capture(alternatives)));
+    EXPECT_EQ(expected, alternatives);
+  }
+
+  void EXPECT_SUCCEEDED(RichNode space) {
+    UnstableNode status = SpaceLike(space).askSpace(vm);
+    EXPECT_EQ_ATOM(MOZART_STR("succeeded"), status);
+  }
+
+  void EXPECT_FAILED(RichNode space) {
+    UnstableNode status = SpaceLike(space).askSpace(vm);
+    EXPECT_EQ_ATOM(MOZART_STR("failed"), status);
+  }
+
+  ProtectedNode cell;
+};
+
+TEST_F(SpaceTest, EagerClone) {
+  UnstableNode space = newSpace(2);
+  UnstableNode copy = clone(space);
+
+  EXPECT_FALSE(getSpace(copy)->isLazy());
+  EXPECT_ALTERNATIVES(2, copy);
+
+  commit(copy, 1);
+  commit(copy, 2);
+  EXPECT_SUCCEEDED(copy);
+
+  // The original is untouched
+  EXPECT_ALTERNATIVES(2, space);
+}
+
+TEST_F(SpaceTest, LazyClone) {
+  setRecomputationDistance(3);
+
+  UnstableNode space = newSpace(2);
+  UnstableNode copy = clone(space);
+
+  // Nothing to replay: the copy is the snapshot itself
+  EXPECT_TRUE(getSpace(copy)->isLazy());
+  EXPECT_ALTERNATIVES(2, copy);
+  EXPECT_FALSE(getSpace(copy)->isLazy());
+  EXPECT_FALSE(getSpace(copy)->isReplaying());
+
+  commit(copy, 1);
+  commit(copy, 2);
+  EXPECT_SUCCEEDED(copy);
+
+  EXPECT_ALTERNATIVES(2, space);
+}
+
+TEST_F(SpaceTest, Replay) {
+  setRecomputationDistance(3);
+
+  UnstableNode space = newSpace(3);
+  UnstableNode first = clone(space); // takes the snapshot
+  commit(space, 2);
+
+  UnstableNode second = clone(space);
+  EXPECT_TRUE(getSpace(second)->isLazy());
+
+  // The commit made since the snapshot is replayed
+  recompute(second);
+  EXPECT_FALSE(getSpace(second)->isReplaying());
+  EXPECT_ALTERNATIVES(2, second);
+
+  commit(second, 1);
+  commit(second, 1);
+  EXPECT_SUCCEEDED(second);
+
+  // The space it was cloned from, and the snapshot, are untouched
+  EXPECT_ALTERNATIVES(2, space);
+  commit(first, 1);
+  commit(first, 1);
+  EXPECT_ALTERNATIVES(2, first);
+}
+
+TEST_F(SpaceTest, NewSnapshot) {
+  setRecomputationDistance(2);
+
+  UnstableNode space = newSpace(3);
+  UnstableNode first = clone(space);
+  commit(space, 1);
+  commit(space, 2);
+
+  // Two commits since the snapshot: a new one is taken
+  UnstableNode second = clone(space);
+  EXPECT_TRUE(getSpace(second)->isLazy());
+
+  recompute(second);
+  EXPECT_FALSE(getSpace(second)->isReplaying());
+  EXPECT_ALTERNATIVES(2, second);
+
+  commit(second, 1);
+  EXPECT_SUCCEEDED(second);
+}
+
+TEST_F(SpaceTest, ReplayDivergence) {
+  setRecomputationDistance(3);
+
+  UnstableNode space = newSpace(3);
+  UnstableNode first = clone(space);
+  commit(space, 2);
+  commit(space, 2);
+  UnstableNode second = clone(space);
+
+  // Replaying the second commit needs 2 alternatives, there is only one
+  setAlternatives(1);
+
+  recompute(second);
+  EXPECT_FALSE(getSpace(second)->isReplaying());
+  EXPECT_FAILED(second);
+}
+
+TEST_F(SpaceTest, KillWhileReplaying) {
+  setRecomputationDistance(3);
+
+  UnstableNode space = newSpace(3);
+  UnstableNode first = clone(space);
+  commit(space, 1);
+  UnstableNode second = clone(space);
+
+  SpaceLike(second).askVerboseSpace(vm);
+  EXPECT_TRUE(getSpace(second)->isReplaying());
+
+  SpaceLike(second).killSpace(vm);
+  EXPECT_FALSE(getSpace(second)->isReplaying());
+
+  runUntilIdle();
+  EXPECT_FAILED(second);
+}
@@ -92,6 +92,36 @@ TEST_F(StringTest, Append) {
   EXPECT_EQ_STRING(MOZART_STR("abc"), b10i);
 }
 
+TEST_F(StringTest, AppendRope) {
+  // Appending many pieces builds a rope, flattened when first needed
+  std::basic_string<nchar> expected;
+  UnstableNode result = String::build(vm, MOZART_STR(""));
+
+  for (int i = 0; i < 1000; i++) {
+    const nchar* piece =
+      (i % 5 == 0) ? MOZART_STR("\u6789") : MOZART_STR("ab");
+    expected += piece;
+
+    UnstableNode pieceNode = String::build(vm, newLString(vm, piece));
+    result = StringLike(result).stringAppend(vm, pieceNode);
+  }
+
+  RichNode rope = result;
+  if (EXPECT_IS<String>(rope)) {
+    EXPECT_TRUE(rope.as<String>().isRope());
+    EXPECT_FALSE(rope.as<String>().isASCII());
+    EXPECT_LT(rope.as<String>().ropeHeight(), 32);
+    EXPECT_EQ((nativeint) expected.size(), rope.as<String>().length());
+
+    // 0x6789, then 'a', 'b' four times
+    UnstableNode index = SmallInt::build(vm, 900);
+    EXPECT_EQ(0x6789, StringLike(rope).stringCharAt(vm, index));
+    EXPECT_FALSE(rope.as<String>().isRope());
+
+    EXPECT_EQ_STRING(makeLString(expected.data(), expected.size()), rope);
+  }
+}
+
 TEST_F(StringTest, SliceByCharCode) {
   UnstableNode b = String::build(vm, MOZART_STR("a\U00012345b\u6789c"));
 
@@ -220,3 +250,99 @@ TEST_F(StringTest, Search) {
     EXPECT_FALSE(RichNode(end).as<Boolean>().value());
   }
 }
+
+TEST_F(StringTest, SearchAll) {
+  UnstableNode b = String::build(
+    vm, MOZART_STR("a,\U000a0000,,b,\U000a0000,\U000a0000"));
+  UnstableNode comma = SmallInt::build(vm, ',');
+  UnstableNode needle = String::build(vm, MOZART_STR("\U000a0000,"));
+  UnstableNode empty = String::build(vm, MOZART_STR(""));
+
+  UnstableNode zero = SmallInt::build(vm, 0);
+  UnstableNode three = SmallInt::build(vm, 3);
+
+  auto indicesOf = [this] (UnstableNode list) {
+    std::vector<nativeint> result;
+    ozListForEach(vm, list, [&] (nativeint i) { result.push_back(i); },
+                  MOZART_STR("list"));
+    return result;
+  };
+
+  EXPECT_EQ((std::vector<nativeint> { 1, 3, 4, 6, 8 }),
+            indicesOf(StringLike(b).stringSearchAll(vm, zero, comma)));
+  EXPECT_EQ((std::vector<nativeint> { 3, 4, 6, 8 }),
+            indicesOf(StringLike(b).stringSearchAll(vm, three, comma)));
+  EXPECT_EQ((std::vector<nativeint> { 2, 7 }),
+            indicesOf(StringLike(b).stringSearchAll(vm, zero, needle)));
+
+  EXPECT_RAISE(MOZART_STR("error"), // type error
+               StringLike(b).stringSearchAll(vm, zero, empty));
+
+  // Long ASCII string, to go through the vectorized search
+  std::basic_string<nchar> s;
+  for (nativeint i = 0; i < 100; i++)
+    s += MOZART_STR("key=value;");
+  UnstableNode ascii = String::build(vm, newLString(vm, s));
+  UnstableNode separator = String::build(vm, MOZART_STR("e;"));
+
+  auto found = indicesOf(StringLike(ascii).stringSearchAll(vm, zero,
+                                                           separator));
+  ASSERT_EQ(100u, found.size());
+  for (nativeint i = 0; i < 100; i++)
+    EXPECT_EQ(i*10 + 8, found[i]);
+}
+
+TEST_F(StringTest, LongStringIndexing) {
+  // Long enough to need several entries in the code point index
+  std::basic_string<nchar> s;
+  for (nativeint i = 0; i < 200; i++)
+    s += (i % 3 == 0) ? MOZART_STR("\u00e9") : MOZART_STR("a");
+
+  UnstableNode b = String::build(vm, newLString(vm, s));
+  UnstableNode ascii = String::build(
+    vm, newLString(vm, std::basic_string<nchar>(200, 'a')));
+
+  for (nativeint i : { 0, 1, 63, 64, 65, 128, 150, 199 }) {
+    UnstableNode index = SmallInt::build(vm, i);
+    EXPECT_EQ((i % 3 == 0) ? 0xe9 : 'a',
+              StringLike(b).stringCharAt(vm, index));
+    EXPECT_EQ('a', StringLike(ascii).stringCharAt(vm, index));
+  }
+
+  UnstableNode twoHundred = SmallInt::build(vm, 200);
+  EXPECT_RAISE(MOZART_STR("indexOutOfBounds"),
+               StringLike(b).stringCharAt(vm, twoHundred));
+  EXPECT_RAISE(MOZART_STR("indexOutOfBounds"),
+               StringLike(ascii).stringCharAt(vm, twoHundred));
+
+  UnstableNode from = SmallInt::build(vm, 129);
+  UnstableNode to = SmallInt::build(vm, 133);
+  EXPECT_EQ_STRING(MOZART_STR("\u00e9aa\u00e9"),
+                   StringLike(b).stringSlice(vm, from, to));
+  EXPECT_EQ_STRING(MOZART_STR(""),
+                   StringLike(b).stringSlice(vm, twoHundred, twoHundred));
+
+  UnstableNode needle = String::build(vm, MOZART_STR("a\u00e9"));
+  UnstableNode begin, end;
+  StringLike(b).stringSearch(vm, from, needle, begin, end);
+  EXPECT_EQ_INT(131, begin);
+  EXPECT_EQ_INT(133, end);
+}
+
+TEST_F(StringTest, InvalidStringIndexing) {
+  // Ends with a truncated code point
+  std::basic_string<nchar> s = MOZART_STR("a\u00e9");
+  s += (nchar) ((sizeof(nchar) == 1) ? 0xc3 : 0xd800);
+
+  UnstableNode b = String::build(vm, newLString(vm, s));
+  UnstableNode zero = SmallInt::build(vm, 0);
+  UnstableNode one = SmallInt::build(vm, 1);
+
+  // Reported as such, and not as out of bounds indices, every time
+  EXPECT_RAISE(MOZART_STR("unicodeError"),
+               StringLike(b).stringCharAt(vm, zero));
+  EXPECT_RAISE(MOZART_STR("unicodeError"),
+               StringLike(b).stringSlice(vm, zero, one));
+  EXPECT_RAISE(MOZART_STR("unicodeError"),
+               StringLike(b).stringCharAt(vm, zero));
+}
@@ -84,12 +84,12 @@ protected:
    * Expect that a node is a string and the content is the given
    * null-terminated string.
    */
-  static bool EXPECT_EQ_STRING(const BaseLString<nchar>& expected,
-                               RichNode actual) {
+  bool EXPECT_EQ_STRING(const BaseLString<nchar>& expected,
+                        RichNode actual) {
     if (!EXPECT_IS<String>(actual))
       return false;
 
-    auto actualString = actual.as<String>().value();
+    auto actualString = actual.as<String>().value(vm);
     EXPECT_EQ(expected, actualString);
     return expected == actualString;
   }
@@ -98,7 +98,7 @@ protected:
    * Expect that a node is a string and the content is the given
    * null-terminated string.
    */
-  static bool EXPECT_EQ_STRING(const BaseLString<nchar>& expected,
+  bool EXPECT_EQ_STRING(const BaseLString<nchar>& expected,
                                UnstableNode&& actual) {
     return EXPECT_EQ_STRING(expected, RichNode(actual));
   }
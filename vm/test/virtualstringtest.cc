@@ -100,6 +100,63 @@ TEST_F(VirtualStringTest, ToString) {
   }
 }
 
+TEST_F(VirtualStringTest, Write) {
+  ChunkedBuffer buffer;
+
+  for (auto&& node : testNodes) {
+    size_t bufSize = ozVSLengthForBuffer(vm, node);
+    {
+      std::basic_string<nchar> expected;
+      ozVSGet(vm, node, bufSize, expected);
+
+      buffer.clear();
+      ozVSWrite(vm, node, buffer);
+
+      std::basic_string<nchar> str;
+      buffer.forEachChunk([&str] (const char* data, size_t size) {
+        str.append(data, size);
+      });
+      EXPECT_EQ(expected, str);
+    }
+  }
+}
+
+TEST_F(VirtualStringTest, WriteAcrossChunks) {
+  // 3 full chunks and a half, written in parts that straddle their limits
+  const size_t partSize = 1000;
+  const size_t partCount = (7 * ChunkedBuffer::chunkSize / 2) / partSize;
+
+  std::basic_string<nchar> part(partSize, MOZART_STR('a'));
+  std::basic_string<nchar> expected;
+
+  UnstableNode vs = build(vm, MOZART_STR(""));
+  for (size_t i = 0; i < partCount; i++) {
+    part[0] = (nchar) (MOZART_STR('a') + (i % 26));
+    vs = buildSharp(vm, vs, String::build(vm, newLString(vm, part.c_str(),
+                                                         part.size())));
+    expected += part;
+  }
+
+  ChunkedBuffer buffer;
+  ozVSWrite(vm, vs, buffer);
+  EXPECT_EQ(expected.size(), buffer.size());
+
+  std::basic_string<nchar> str;
+  size_t chunkCount = 0;
+  buffer.forEachChunk([&] (const char* data, size_t size) {
+    EXPECT_LE(size, ChunkedBuffer::chunkSize);
+    str.append(data, size);
+    chunkCount++;
+  });
+  EXPECT_EQ(4u, chunkCount);
+  EXPECT_EQ(expected, str);
+
+  // Truncating keeps the beginning, and writing again overwrites the rest
+  buffer.truncate(partSize);
+  ozVSWrite(vm, build(vm, 42), buffer);
+  EXPECT_EQ(partSize + 2, buffer.size());
+}
+
 TEST_F(VirtualStringTest, Length) {
   size_t results[] = {
     1, 1, 2, 8, 9,